@@ -118,6 +118,8 @@ my %defaults = (
         IRC_SERVER_HOST             => '127.0.0.1',
         IRC_SERVER_PORT             => '6667',
         IRC_USE_SASL                => 'false',
+        IRC_DAEMON                  => 'false',
+        IRC_DETACH                  => 'false',
     },
     redis => {
         REDIS_HOST                  => '/var/run/redis/redis.sock',
@@ -269,6 +271,8 @@ sub request_user_input {
         ['nginx', 'IRC_SERVER_HOST', 'IRC Server Host'],
         ['nginx', 'IRC_SERVER_PORT', 'IRC Server Port'],
         ['nginx', 'IRC_USE_SASL',   'Enable SASL Authentication'],
+        ['nginx', 'IRC_DAEMON',     'Host IRC sessions in one daemon process'],
+        ['nginx', 'IRC_DETACH',     'Keep IRC sessions alive across page reloads'],
 
         # Redis settings
         ['redis', 'REDIS_HOST', 'Redis Host'],
@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     supervisor authbind expect openssl-dev build-base intltool autoconf
-    automake gcc curl pkgconf perl-app-cpanminus ncurses-dev pcre-dev
+    automake gcc curl pkgconf perl-app-cpanminus ncurses-dev zstd-dev pcre-dev
     libcurl libcurl-dev imagemagick-dev libxslt-dev mysql-dev libxml2-dev
     icu-dev imagemagick imagemagick-c++ libzip-dev oniguruma-dev
     libsodium-dev glib-dev libwebp-dev mysql-client bash musl-dev make
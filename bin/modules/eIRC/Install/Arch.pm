@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     base-devel intltool autoconf automake gcc curl pkgconf cpanminus
-    ncurses pcre libcurl imagemagick openssl libxslt mariadb-libs
+    ncurses zstd pcre libcurl imagemagick openssl libxslt mariadb-libs
     libxml2 icu imagemagick imagemagick libzip oniguruma
     libsodium glib2 libwebp mariadb imagemagick git go expect
     systemd supervisord
@@ -20,7 +20,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 # CentOS system dependencies
 my @systemDependencies = qw(
     epel-release supervisor authbind expect openssl-devel gcc curl
-    pkgconfig mysql-devel imagemagick pcre-devel libcurl-devel
+    pkgconfig mysql-devel imagemagick libzstd-devel pcre-devel libcurl-devel
     libxml2-devel libicu-devel libxslt-devel libzip-devel oniguruma-devel
     libsodium-devel glib2-devel libwebp-devel
 );
@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     supervisor authbind expect openssl build-essential intltool autoconf
-    automake gcc curl pkg-config cpanminus libncurses-dev libpcre3-dev
+    automake gcc curl pkg-config cpanminus libncurses-dev libzstd-dev libpcre3-dev
     libcurl4-openssl-dev libmagickwand-dev libssl-dev libxslt1-dev
     libmysqlclient-dev libxml2 libxml2-dev libicu-dev libmagick++-dev
     libzip-dev libonig-dev libsodium-dev libglib2.0-dev libwebp-dev
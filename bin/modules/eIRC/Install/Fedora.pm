@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     supervisor authbind expect openssl-devel gcc curl pkgconf perl-App-cpanminus
-    ncurses-devel pcre-devel libcurl-devel ImageMagick-devel libxslt-devel
+    ncurses-devel libzstd-devel pcre-devel libcurl-devel ImageMagick-devel libxslt-devel
     mariadb-connector-c-devel libxml2-devel libicu-devel ImageMagick-c++-devel
     libzip-devel oniguruma-devel libsodium-devel glib2-devel libwebp-devel
     mariadb ImageMagick bash make golang
@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     supervisor authbind expect openssl gcc curl pkgconfig app-cpanminus
-    ncurses pcre libcurl media-gfx/imagemagick libxslt dev-db/mariadb-connector-c
+    ncurses app-arch/zstd pcre libcurl media-gfx/imagemagick libxslt dev-db/mariadb-connector-c
     libxml2 dev-libs/icu media-libs/libzip dev-libs/oniguruma dev-libs/libsodium
     dev-libs/glib media-libs/libwebp mariadb media-gfx/imagemagick dev-lang/go
 );
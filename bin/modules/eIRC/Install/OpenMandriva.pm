@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     python3-supervisor authbind expect openssl-devel gcc curl pkgconfig
-    perl-App-cpanminus ncurses-devel pcre-devel libcurl-devel
+    perl-App-cpanminus ncurses-devel zstd-devel pcre-devel libcurl-devel
     ImageMagick-devel libxslt-devel mariadb-devel libxml2-devel
     libicu-devel libzip-devel oniguruma-devel libsodium-devel
     glib2-devel libwebp-devel mariadb imagemagick bash make golang
@@ -13,7 +13,7 @@ our @EXPORT_OK = qw(install_system_dependencies install_php install_bazelisk);
 
 my @systemDependencies = qw(
     python3-supervisor authbind expect libopenssl-devel gcc curl
-    pkg-config perl-App-cpanminus ncurses-devel pcre-devel libcurl-devel
+    pkg-config perl-App-cpanminus ncurses-devel libzstd-devel pcre-devel libcurl-devel
     ImageMagick-devel libxslt-devel libmysqlclient-devel libxml2-devel
     libicu-devel libzip-devel oniguruma-devel libsodium-devel
     glib2-devel libwebp-devel mariadb imagemagick go bash make
@@ -139,7 +139,7 @@ sub start_daemon {
     @ENV{qw(
         APP_URL USER BIN DIR ETC OPT TMP VAR SRC WEB
         CACHE_DIR LOG_DIR PORT SSL REDIS_HOST APP_NAME
-        IRC_SERVER_HOST IRC_SERVER_PORT IRC_USE_SASL
+        IRC_SERVER_HOST IRC_SERVER_PORT IRC_USE_SASL IRC_DAEMON IRC_DETACH
     )} = (
         $cfg{nginx}{APP_URL},       $user,         $binDir,
         $applicationRoot,            $etcDir,       $optDir,
@@ -148,7 +148,8 @@ sub start_daemon {
         $cfg{nginx}{PORT},           $cfg{nginx}{IS_SSL},
         $cfg{redis}{REDIS_HOST},     $cfg{laravel}{APP_NAME},
         $cfg{nginx}{IRC_SERVER_HOST},$cfg{nginx}{IRC_SERVER_PORT},
-        $cfg{nginx}{IRC_USE_SASL}
+        $cfg{nginx}{IRC_USE_SASL},   $cfg{nginx}{IRC_DAEMON},
+        $cfg{nginx}{IRC_DETACH}
     );
 
     print "Starting Web Daemon...\n";
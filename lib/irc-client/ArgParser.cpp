@@ -16,11 +16,145 @@ ArgParser::ArgParser(int argc, char *argv[])
 	// Grab argv into vector<string>
 	tokenize(argc, argv);
 
+	parse();
+}
+
+ArgParser::ArgParser(const std::vector<std::string> &args)
+	: tokens(args)
+{
+	parse();
+}
+
+void ArgParser::parse()
+{
 	// Split into keyValues and flags
 	splitKeyValuesAndFlags();
 
 	// Use keyValues and flags to fill parsed:
 	parsed.useSasl = flags.count("--sasl") > 0;
+	parsed.daemon = flags.count("--daemon") > 0;
+	parsed.listenDir = keyValues["listen"];
+	parsed.logDir = keyValues["log"];
+
+	if (!keyValues["threads"].empty())
+	{
+		parsed.threads = std::stoi(keyValues["threads"]);
+	}
+
+	if (!keyValues["log-flush-ms"].empty())
+	{
+		parsed.logOptions.flushInterval = std::chrono::milliseconds(std::stoi(keyValues["log-flush-ms"]));
+	}
+	if (!keyValues["log-queue-kb"].empty())
+	{
+		parsed.logOptions.queueBytes = static_cast<std::size_t>(std::stoul(keyValues["log-queue-kb"])) * 1024;
+	}
+	if (!keyValues["log-overflow"].empty())
+	{
+		parsed.logOptions.overflow = Logger::parseOverflow(keyValues["log-overflow"]);
+	}
+	if (!keyValues["log-rotate-mb"].empty())
+	{
+		parsed.logOptions.segments.maxBytes = std::stoull(keyValues["log-rotate-mb"]) * 1024 * 1024;
+	}
+	if (!keyValues["log-rotate-min"].empty())
+	{
+		parsed.logOptions.segments.maxAge = std::chrono::minutes(std::stoi(keyValues["log-rotate-min"]));
+	}
+	if (!keyValues["log-keep"].empty())
+	{
+		parsed.logOptions.segments.keep = static_cast<std::size_t>(std::stoul(keyValues["log-keep"]));
+	}
+	if (!keyValues["log-level"].empty())
+	{
+		LogFilter{}.applyLevels(keyValues["log-level"]); // throws on a bad spec
+		parsed.logOptions.levels = keyValues["log-level"];
+	}
+	if (!keyValues["log-sample"].empty())
+	{
+		LogFilter{}.applySampling(keyValues["log-sample"]);
+		parsed.logOptions.sampling = keyValues["log-sample"];
+	}
+	if (!keyValues["log-compress"].empty())
+	{
+		const std::string &codec = keyValues["log-compress"];
+		if (codec != "none" && codec != "zstd")
+			throw std::invalid_argument("Invalid log compression: " + codec);
+		parsed.logOptions.segments.compression = codec == "zstd" ? LogCompression::Zstd : LogCompression::None;
+	}
+
+	if (!keyValues["ui-queue-kb"].empty())
+	{
+		parsed.uiOptions.queueBytes = static_cast<std::size_t>(std::stoul(keyValues["ui-queue-kb"])) * 1024;
+	}
+	if (!keyValues["ui-overflow"].empty())
+	{
+		parsed.uiOptions.overflow = UnixSocketUI::parseOverflow(keyValues["ui-overflow"]);
+	}
+	if (!keyValues["ui-spill-mb"].empty())
+	{
+		parsed.uiOptions.spillBytes = static_cast<std::size_t>(std::stoul(keyValues["ui-spill-mb"])) * 1024 * 1024;
+	}
+	if (!keyValues["detach-lines"].empty())
+	{
+		parsed.uiOptions.detachLines = static_cast<std::size_t>(std::stoul(keyValues["detach-lines"]));
+	}
+	if (!keyValues["scrollback"].empty())
+	{
+		parsed.uiOptions.scrollback.lines = static_cast<std::size_t>(std::stoul(keyValues["scrollback"]));
+	}
+	if (!keyValues["scrollback-kb"].empty())
+	{
+		parsed.uiOptions.scrollback.bytes = static_cast<std::size_t>(std::stoul(keyValues["scrollback-kb"])) * 1024;
+	}
+	if (!keyValues["scrollback-age-min"].empty())
+	{
+		parsed.uiOptions.scrollback.maxAge = std::chrono::minutes(std::stoi(keyValues["scrollback-age-min"]));
+	}
+	if (!keyValues["scrollback-buffers"].empty())
+	{
+		parsed.uiOptions.scrollback.buffers = static_cast<std::size_t>(std::stoul(keyValues["scrollback-buffers"]));
+	}
+	if (!keyValues["resume-lines"].empty())
+	{
+		parsed.uiOptions.resumeLines = static_cast<std::size_t>(std::stoul(keyValues["resume-lines"]));
+	}
+	if (!keyValues["resume-kb"].empty())
+	{
+		parsed.uiOptions.resumeBytes = static_cast<std::size_t>(std::stoul(keyValues["resume-kb"])) * 1024;
+	}
+
+	if (!keyValues["flood-burst"].empty())
+	{
+		parsed.outboundOptions.burst = static_cast<std::size_t>(std::stoul(keyValues["flood-burst"]));
+	}
+	if (!keyValues["flood-interval-ms"].empty())
+	{
+		parsed.outboundOptions.interval = std::chrono::milliseconds(std::stoi(keyValues["flood-interval-ms"]));
+	}
+
+	if (!keyValues["whois-ttl-s"].empty())
+	{
+		parsed.whoisOptions.ttl = std::chrono::seconds(std::stoi(keyValues["whois-ttl-s"]));
+	}
+	if (!keyValues["whois-cache"].empty())
+	{
+		parsed.whoisOptions.capacity = static_cast<std::size_t>(std::stoul(keyValues["whois-cache"]));
+	}
+	if (!keyValues["history"].empty())
+	{
+		parsed.historyOptions.limit = static_cast<std::size_t>(std::stoul(keyValues["history"]));
+	}
+
+	// The daemon names its control socket and log after a fixed instance id
+	if (parsed.daemon)
+	{
+		parsed.instance = "daemon";
+		parsed.listenSocket = makeSocketPath(parsed.instance, parsed.listenDir);
+		parsed.logPath = makeLogPath(parsed.instance, parsed.logDir);
+		return;
+	}
+
 	parsed.server = keyValues["server"];
 	parsed.port = std::stoi(keyValues["port"]);
 
@@ -37,6 +171,8 @@ ArgParser::ArgParser(int argc, char *argv[])
 	parsed.logPath = makeLogPath(
 		parsed.instance,
 		keyValues.count("log") ? keyValues["log"] : "");
+	// irc-client-<instance>.history beside irc-client-<instance>.log
+	parsed.historyOptions.cursorPath = std::filesystem::path(parsed.logPath).replace_extension(".history").string();
 
 	// channels
 	{
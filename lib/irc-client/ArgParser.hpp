@@ -12,6 +12,12 @@
 #include <vector>
 #include <filesystem> // Required for computing logPath
 
+#include "ChatHistory.hpp"
+#include "Logger.hpp"
+#include "OutboundQueue.hpp"
+#include "UnixSocketUI.hpp"
+#include "WhoisCache.hpp"
+
 struct ParsedArgs
 {
     std::string nick;
@@ -24,12 +30,39 @@ struct ParsedArgs
     std::string listenSocket;
     std::string instance;
     bool useSasl = false; // set by --sasl
+
+    // Daemon mode: one process hosting many sessions behind a control socket
+    bool daemon = false;  // set by --daemon
+    int threads = 0;      // --threads=N, 0 = one per hardware thread
+    std::string listenDir; // --listen, inherited by daemon-created sessions
+    std::string logDir;    // --log, inherited by daemon-created sessions
+
+    // --log-flush-ms=N, --log-queue-kb=N, --log-overflow=block|drop|count,
+    // --log-rotate-mb=N, --log-rotate-min=N, --log-keep=N, --log-compress=none|zstd,
+    // --log-level=info,raw-in=warn,...  --log-sample=raw-in=20,...
+    LoggerOptions logOptions;
+
+    // --ui-queue-kb=N, --ui-overflow=drop-oldest|disconnect|spill, --ui-spill-mb=N,
+    // --detach-lines=N per channel kept while no peer is attached (0 = sign off instead),
+    // --scrollback=N lines (0 = off), --scrollback-kb=N, --scrollback-age-min=N, --scrollback-buffers=N,
+    // --resume-lines=N (0 = no sequence numbers or /resume), --resume-kb=N
+    UiOptions uiOptions;
+
+    // --flood-burst=N, --flood-interval-ms=N (0 turns pacing off)
+    OutboundOptions outboundOptions;
+
+    // --whois-ttl-s=N (0 = never answer from cache), --whois-cache=N results
+    WhoisOptions whoisOptions;
+
+    // --history=N messages per channel on reconnect (0 = off); cursors live next to the log
+    HistoryOptions historyOptions;
 };
 
 class ArgParser
 {
 public:
 	ArgParser(int argc, char *argv[]);
+	explicit ArgParser(const std::vector<std::string> &args);
 	ParsedArgs getArgs() const;
 
 private:
@@ -43,6 +76,7 @@ private:
     // helper init methods
     void tokenize(int argc, char *argv[]);
     void splitKeyValuesAndFlags();
+    void parse();
     void applyUserAndRealnameDefaults();
 
     std::string makeInstanceId() const;
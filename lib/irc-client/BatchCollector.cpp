@@ -0,0 +1,110 @@
+// File: BatchCollector.cpp
+// Requires: C++23
+// Purpose: Implements BATCH collection. Every line of an open batch, nested batches included, is
+//          appended to its outermost batch; only the outermost BATCH -ref makes it ready.
+
+#include "BatchCollector.hpp"
+
+BatchCollector::BatchCollector(std::size_t maxLines)
+	: maxLines(maxLines ? maxLines : 1)
+{
+}
+
+BatchCollector::Result BatchCollector::add(const IrcMessage &message)
+{
+	// The outermost batch this line belongs to, if any
+	std::string outer;
+
+	if (message.is("BATCH") && message.param(0).size() > 1)
+	{
+		std::string_view reference = message.param(0).substr(1);
+		if (message.param(0).front() == '+')
+		{
+			std::optional<std::string_view> parent = message.tag("batch");
+			auto parentIt = parent ? outerOf.find(*parent) : outerOf.end();
+			if (parentIt == outerOf.end())
+			{
+				// A new outermost batch
+				Batch batch;
+				batch.reference = reference;
+				batch.type = message.param(1);
+				for (std::size_t i = 2; i < message.paramCount; ++i)
+					batch.params.emplace_back(message.param(i));
+				outer = reference;
+				batches.insert_or_assign(outer, std::move(batch));
+			}
+			else
+				outer = parentIt->second;
+			outerOf.insert_or_assign(std::string(reference), outer);
+		}
+		else if (message.param(0).front() == '-')
+		{
+			auto it = outerOf.find(reference);
+			if (it == outerOf.end())
+				return Result::Unbatched;
+			outer = std::move(it->second);
+			outerOf.erase(it);
+
+			if (reference == outer)
+			{
+				Batch &batch = batches[outer];
+				batch.lines.emplace_back(message.raw);
+				batch.closed = true;
+				readyReference = outer;
+				return Result::Ready;
+			}
+		}
+	}
+	else if (std::optional<std::string_view> reference = message.tag("batch"))
+	{
+		auto it = outerOf.find(*reference);
+		if (it == outerOf.end())
+			return Result::Unbatched;
+		outer = it->second;
+	}
+
+	if (outer.empty())
+		return Result::Unbatched;
+
+	Batch &batch = batches[outer];
+	batch.lines.emplace_back(message.raw);
+	if (batch.lines.size() < maxLines)
+		return Result::Held;
+	readyReference = outer;
+	return Result::Ready;
+}
+
+const Batch &BatchCollector::ready() const
+{
+	return batches.find(readyReference)->second;
+}
+
+void BatchCollector::release()
+{
+	auto it = batches.find(readyReference);
+	if (it != batches.end())
+	{
+		if (it->second.closed)
+		{
+			// Nested batches the server never closed go with their outermost one
+			std::erase_if(outerOf, [&](const auto &entry)
+						  { return entry.second == readyReference; });
+			batches.erase(it);
+		}
+		else
+			it->second.lines.clear();
+	}
+	readyReference.clear();
+}
+
+void BatchCollector::clear()
+{
+	batches.clear();
+	outerOf.clear();
+	readyReference.clear();
+}
+
+std::size_t BatchCollector::openCount() const noexcept
+{
+	return batches.size();
+}
@@ -0,0 +1,68 @@
+// File: BatchCollector.hpp
+// Requires: C++23
+// Purpose: Declares BatchCollector, which holds back IRCv3 BATCH traffic (netsplits, netjoins,
+//          chathistory playback) until the batch closes, so the session can hand the whole batch
+//          to its handlers and UI peers in one pass instead of one dispatch and one socket write
+//          per read. Nested batches are delivered as part of the outermost one.
+//          Not thread-safe: owned by the session and only touched on its strand.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "IrcMessage.hpp"
+
+struct Batch
+{
+	std::string reference; // of the outermost batch
+	std::string type;	   // "netsplit", "netjoin", "chathistory", ...
+	std::vector<std::string> params;
+	// Raw lines in arrival order, the opening and closing BATCH lines (nested ones too) included
+	std::vector<std::string> lines;
+	bool closed = false;
+};
+
+class BatchCollector
+{
+public:
+	static constexpr std::size_t defaultMaxLines = 4096;
+
+	enum class Result
+	{
+		Unbatched, // not part of any open batch: deliver it now
+		Held,	   // kept with its batch
+		Ready	   // deliver ready() now: its outermost batch closed or reached the line limit
+	};
+
+	// A batch that reaches `maxLines` is delivered in pieces of that size, in order
+	explicit BatchCollector(std::size_t maxLines = defaultMaxLines);
+
+	Result add(const IrcMessage &message);
+
+	// After Result::Ready, until release()
+	[[nodiscard]] const Batch &ready() const;
+	// Drops the delivered lines; a closed batch is forgotten
+	void release();
+
+	// Forgets every open batch (the connection is gone)
+	void clear();
+	[[nodiscard]] std::size_t openCount() const noexcept; // outermost batches still open
+
+private:
+	struct StringHash
+	{
+		using is_transparent = void;
+		std::size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+	};
+	template <typename Value>
+	using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+	std::size_t maxLines;
+	StringMap<Batch> batches;		// by outermost reference
+	StringMap<std::string> outerOf; // every open reference, nested ones included
+	std::string readyReference;
+};
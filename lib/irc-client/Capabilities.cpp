@@ -0,0 +1,116 @@
+// File: Capabilities.cpp
+// Requires: C++23
+// Purpose: Implements IRCv3 capability negotiation bookkeeping.
+
+#include "Capabilities.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Calls `apply` with each capability name in a CAP list, without any "=value" suffix
+	template <typename Apply>
+	void forEachCapability(std::string_view list, Apply apply)
+	{
+		while (!list.empty())
+		{
+			std::size_t end = list.find(' ');
+			std::string_view token = list.substr(0, end);
+			list.remove_prefix(end == std::string_view::npos ? list.size() : end + 1);
+			token = token.substr(0, token.find('='));
+			if (!token.empty())
+				apply(token);
+		}
+	}
+}
+
+Capabilities::Capabilities()
+	: wanted(std::begin(defaults), std::end(defaults))
+{
+}
+
+void Capabilities::want(std::string_view name)
+{
+	if (std::ranges::find(wanted, name) == wanted.end())
+		wanted.emplace_back(name);
+}
+
+bool Capabilities::offered(std::string_view list, bool more)
+{
+	forEachCapability(list, [this](std::string_view name)
+					  { available.emplace(name); });
+	return !more;
+}
+
+std::string Capabilities::requestList() const
+{
+	std::string out;
+	for (const std::string &name : wanted)
+	{
+		if (!available.contains(name) || enabled.contains(name))
+			continue;
+		if (!out.empty())
+			out += ' ';
+		out += name;
+	}
+	return out;
+}
+
+void Capabilities::requested()
+{
+	++unanswered;
+}
+
+void Capabilities::acknowledged(std::string_view list)
+{
+	forEachCapability(list, [this](std::string_view name)
+					  {
+		if (name.starts_with('-'))
+		{
+			if (auto it = enabled.find(name.substr(1)); it != enabled.end())
+				enabled.erase(it);
+		}
+		else
+			enabled.emplace(name); });
+	if (unanswered)
+		--unanswered;
+}
+
+void Capabilities::rejected(std::string_view)
+{
+	// A NAK rejects the whole request; nothing it named was enabled
+	if (unanswered)
+		--unanswered;
+}
+
+void Capabilities::withdrawn(std::string_view list)
+{
+	forEachCapability(list, [this](std::string_view name)
+					  {
+		if (auto it = enabled.find(name); it != enabled.end())
+			enabled.erase(it);
+		if (auto it = available.find(name); it != available.end())
+			available.erase(it); });
+}
+
+bool Capabilities::settled() const noexcept
+{
+	return unanswered == 0;
+}
+
+bool Capabilities::isEnabled(std::string_view name) const
+{
+	return enabled.contains(name);
+}
+
+std::string Capabilities::enabledList() const
+{
+	std::string out;
+	for (const std::string &name : enabled)
+	{
+		if (!out.empty())
+			out += ' ';
+		out += name;
+	}
+	return out;
+}
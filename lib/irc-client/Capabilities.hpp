@@ -0,0 +1,56 @@
+// File: Capabilities.hpp
+// Requires: C++23
+// Purpose: Declares Capabilities, the IRCv3 capability negotiation state of a session. It
+//          collects the server's CAP LS listing (which may span several lines), requests every
+//          wanted capability the server offers in one CAP REQ, and tracks what was acknowledged,
+//          so the session knows when registration can continue with CAP END.
+//          Not thread-safe: owned by the session and only touched on its strand.
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Capabilities
+{
+public:
+	// Requested from every server that offers them
+	static constexpr std::string_view defaults[] = {
+		"message-tags", "server-time", "batch", "multi-prefix", "userhost-in-names", "echo-message",
+		"draft/chathistory"};
+
+	Capabilities();
+
+	// Adds `name` to what is requested (SASL, when an auth strategy needs it)
+	void want(std::string_view name);
+
+	/**
+	 * Applies one CAP LS line. `more` is true for the "CAP * LS * :..." continuation lines of a
+	 * multi-line listing. Returns true once the listing is complete.
+	 */
+	bool offered(std::string_view list, bool more);
+	// Wanted and offered, space separated, for CAP REQ; empty when there is nothing to ask for
+	[[nodiscard]] std::string requestList() const;
+	// Call after sending CAP REQ with requestList()
+	void requested();
+
+	// CAP ACK / CAP NAK; a "-name" in an ACK disables `name`
+	void acknowledged(std::string_view list);
+	void rejected(std::string_view list);
+	// CAP DEL (cap-notify): the server withdrew these
+	void withdrawn(std::string_view list);
+
+	// Every CAP REQ has been answered
+	[[nodiscard]] bool settled() const noexcept;
+	[[nodiscard]] bool isEnabled(std::string_view name) const;
+	// Enabled capabilities, space separated
+	[[nodiscard]] std::string enabledList() const;
+
+private:
+	std::vector<std::string> wanted;
+	std::set<std::string, std::less<>> available;
+	std::set<std::string, std::less<>> enabled;
+	std::size_t unanswered = 0; // CAP REQs without an ACK or NAK yet
+};
@@ -1,16 +1,35 @@
 // File: Channel.hpp
 // Requires: C++23
-// Purpose: Defines the Channel struct, representing an IRC channel with a name and a list of
-//          associated users. Used to manage channel membership and state within the IRC client.
+// Purpose: Defines the Channel struct, representing an IRC channel with a name, topic and members.
+//          Members are hashed by their NickTable id with their channel prefix modes (op, voice,
+//          ...) as a small bitset, so every membership change is O(1) however large the channel
+//          is, and a nick change never touches the member maps at all.
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
-#include <vector>
-#include "User.hpp"
+#include <unordered_map>
+
+#include "NickTable.hpp"
+
+// One bit per prefix mode, in the order the server's PREFIX lists them (bit 0 = highest rank)
+using MemberModes = std::uint8_t;
+
+// Every entry holds one reference on its NickTable entry
+using MemberMap = std::unordered_map<NickId, MemberModes>;
 
 struct Channel
 {
 	std::string name;
-	std::vector<User *> users;
+	std::string topic; // RPL_TOPIC on join, then TOPIC changes; empty when none is set
+	MemberMap members;
+
+	// NAMES pages (353) collect here until 366 replaces `members` in one step
+	MemberMap pendingNames;
+	bool receivingNames = false;
 };
+
+using ChannelMap = std::map<std::string, Channel, std::less<>>;
@@ -0,0 +1,121 @@
+// File: ChatHistory.cpp
+// Requires: C++23
+// Purpose: Implements chathistory resume cursors. The cursor file holds one "<channel> <time>"
+//          line per channel and is replaced atomically, so a crash mid-save keeps the old one.
+
+#include "ChatHistory.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <utility>
+
+ChatHistory::ChatHistory(HistoryOptions options)
+	: options(std::move(options))
+{
+}
+
+void ChatHistory::load()
+{
+	if (options.cursorPath.empty())
+		return;
+
+	std::ifstream in(options.cursorPath);
+	std::string line;
+	while (std::getline(in, line))
+	{
+		std::size_t space = line.find(' ');
+		if (space == std::string::npos || space == 0 || space + 1 == line.size())
+			continue;
+		observe(std::string_view(line).substr(0, space), std::string_view(line).substr(space + 1));
+	}
+	dirty = false;
+}
+
+bool ChatHistory::save()
+{
+	if (!dirty || options.cursorPath.empty())
+		return true;
+
+	std::string temp = options.cursorPath + ".tmp";
+	{
+		std::ofstream out(temp, std::ios::trunc);
+		for (const auto &[key, cursor] : cursors)
+			out << cursor.channel << ' ' << cursor.time << '\n';
+		if (!out.flush())
+			return false;
+	}
+	if (std::rename(temp.c_str(), options.cursorPath.c_str()) != 0)
+		return false;
+
+	dirty = false;
+	return true;
+}
+
+void ChatHistory::setServerLimit(std::size_t limit)
+{
+	serverLimit = limit;
+}
+
+bool ChatHistory::enabled() const noexcept
+{
+	return options.limit > 0;
+}
+
+void ChatHistory::setCaseMapping(CaseMapping newMapping)
+{
+	if (newMapping == mapping)
+		return;
+	mapping = newMapping;
+
+	std::map<std::string, Cursor, std::less<>> rekeyed;
+	for (auto &[key, cursor] : cursors)
+	{
+		auto [it, inserted] = rekeyed.try_emplace(foldNick(cursor.channel, mapping), cursor);
+		if (!inserted)
+		{
+			advance(it->second, cursor.time);
+			dirty = true;
+		}
+	}
+	cursors.swap(rekeyed);
+}
+
+void ChatHistory::observe(std::string_view channel, std::string_view time)
+{
+	if (time.empty())
+		return;
+
+	std::string key = foldNick(channel, mapping);
+	auto it = cursors.find(key);
+	if (it == cursors.end())
+		cursors.emplace(std::move(key), Cursor{std::string(channel), std::string(time)});
+	else if (!advance(it->second, time))
+		return;
+	dirty = true;
+}
+
+std::string_view ChatHistory::cursor(std::string_view channel) const
+{
+	auto it = cursors.find(foldNick(channel, mapping));
+	return it == cursors.end() ? std::string_view() : std::string_view(it->second.time);
+}
+
+std::string ChatHistory::request(std::string_view channel) const
+{
+	std::size_t limit = serverLimit ? std::min(options.limit, serverLimit) : options.limit;
+	std::string_view since = cursor(channel);
+	if (since.empty())
+		return std::format("CHATHISTORY LATEST {} * {}\n", channel, limit);
+	return std::format("CHATHISTORY AFTER {} timestamp={} {}\n", channel, since, limit);
+}
+
+bool ChatHistory::advance(Cursor &cursor, std::string_view time)
+{
+	// server-time is fixed-width UTC, so later times also compare greater as strings
+	if (cursor.time >= time)
+		return false;
+	cursor.time = time;
+	return true;
+}
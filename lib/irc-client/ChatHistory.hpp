@@ -0,0 +1,66 @@
+// File: ChatHistory.hpp
+// Requires: C++23
+// Purpose: Declares ChatHistory, the per-channel resume cursors behind IRCv3 draft/chathistory
+//          catch-up. A cursor is the server-time of the newest message seen in a channel; after
+//          a restart the session asks for everything after it (CHATHISTORY AFTER) instead of
+//          scraping its logs, or for the latest messages when it has no cursor yet. Channels match
+//          under the server's CASEMAPPING, as Membership keys them, so "#Foo" and "#foo" share
+//          one cursor. Cursors are kept in a small text file next to the session's log.
+//          Not thread-safe: owned by the session and only touched on its strand.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "NickTable.hpp"
+
+struct HistoryOptions
+{
+	std::size_t limit = 100; // messages per channel on catch-up; 0 turns catch-up off
+	std::string cursorPath;	 // empty keeps cursors in memory only
+};
+
+class ChatHistory
+{
+public:
+	explicit ChatHistory(HistoryOptions options = {});
+
+	// Reads the cursor file, if any; a missing or unreadable file just means no cursors
+	void load();
+	// Writes the cursor file if a cursor moved since the last save; false if it could not be written
+	bool save();
+
+	// ISUPPORT CHATHISTORY=<max>: the most the server returns for one request (0 = no limit)
+	void setServerLimit(std::size_t limit);
+	[[nodiscard]] bool enabled() const noexcept;
+	// ISUPPORT CASEMAPPING; cursors that become equal under it keep the later time
+	void setCaseMapping(CaseMapping mapping);
+
+	// Moves the cursor of `channel` forward to `time` (server-time, ISO 8601 UTC)
+	void observe(std::string_view channel, std::string_view time);
+	// Empty if nothing has been seen in `channel`
+	[[nodiscard]] std::string_view cursor(std::string_view channel) const;
+
+	// CHATHISTORY AFTER <channel> timestamp=<cursor> <n>, or LATEST <channel> * <n> without one
+	[[nodiscard]] std::string request(std::string_view channel) const;
+
+private:
+	struct Cursor
+	{
+		std::string channel; // as first seen, for the file
+		std::string time;
+	};
+
+	// Moves `cursor` forward to `time`; false if it was already there or later
+	static bool advance(Cursor &cursor, std::string_view time);
+
+	HistoryOptions options;
+	std::size_t serverLimit = 0;
+	CaseMapping mapping = CaseMapping::Rfc1459;
+	std::map<std::string, Cursor, std::less<>> cursors; // keyed by foldNick(channel, mapping)
+	bool dirty = false;
+};
@@ -7,7 +7,9 @@
 
 #include "Command.hpp"
 #include "../IRCClient.hpp"
+#include <algorithm>
 #include <asio.hpp>
+#include <cctype>
 
 inline Command InputCommand{
 	// Matches if the input starts with "/input "
@@ -19,7 +21,17 @@ inline Command InputCommand{
 	[](IRCClient &client, const std::string &input)
 	{
 		std::string raw = input.substr(7); // strip "/input "
+
+		// A single-nick WHOIS goes through the cache, so repeated lookups do not reach the server
+		if (raw.size() > 6 && std::equal(raw.begin(), raw.begin() + 6, "WHOIS ", [](char a, char b)
+										 { return std::toupper(static_cast<unsigned char>(a)) == b; }))
+		{
+			std::string nick = raw.substr(6);
+			if (!nick.empty() && nick.find_first_of(" ,") == std::string::npos)
+				return client.requestWhois(nick);
+		}
+
 		std::string message = raw + "\n";
 		client.writeToServer(message);
-		client.getLogger().log("→ " + raw);
+		client.getLogger().log(LogCategory::RawOut, LogLevel::Info, "→ " + raw);
 	}};
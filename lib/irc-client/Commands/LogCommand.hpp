@@ -0,0 +1,40 @@
+// File: LogCommand.hpp
+// Requires: C++23
+// Purpose: Defines the `/log` command, which shows or changes the session's log levels and
+//          sampling at runtime: `/log`, `/log level <spec>`, `/log sample <spec>`. Specs use the
+//          same syntax as the --log-level and --log-sample flags.
+
+#pragma once
+
+#include "Command.hpp"
+#include "../IRCClient.hpp"
+#include <stdexcept>
+#include <string>
+
+inline Command LogCommand{
+	[](const std::string &input)
+	{
+		return input == "/log" || input.rfind("/log ", 0) == 0;
+	},
+	[](IRCClient &client, const std::string &input)
+	{
+		LogFilter &filter = client.getLogger().getFilter();
+		std::string args = input.size() > 5 ? input.substr(5) : "";
+
+		try
+		{
+			if (args.rfind("level ", 0) == 0)
+				filter.applyLevels(args.substr(6));
+			else if (args.rfind("sample ", 0) == 0)
+				filter.applySampling(args.substr(7));
+			else if (!args.empty())
+				throw std::invalid_argument("usage: /log [level <spec> | sample <spec>]");
+		}
+		catch (const std::invalid_argument &ex)
+		{
+			client.getUi().drawOutput(":client error :" + std::string(ex.what()));
+			return;
+		}
+
+		client.getUi().drawOutput(":client log :" + filter.describe());
+	}};
@@ -0,0 +1,19 @@
+// File: QueueCommand.hpp
+// Requires: C++23
+// Purpose: Defines the `/queue` command, which reports how long each class of outbound message
+//          waited in the session's send queue and how many lines are still waiting on flood control.
+
+#pragma once
+
+#include "Command.hpp"
+#include "../IRCClient.hpp"
+
+inline Command QueueCommand{
+	[](const std::string &input)
+	{
+		return input == "/queue";
+	},
+	[](IRCClient &client, const std::string &)
+	{
+		client.getUi().drawOutput(":client queue :" + client.getOutboundQueue().describe());
+	}};
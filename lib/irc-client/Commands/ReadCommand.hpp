@@ -0,0 +1,28 @@
+// File: ReadCommand.hpp
+// Requires: C++23
+// Purpose: Defines the `/read [#channel]` command, which resets the unread count `/snapshot`
+//          reports for a channel, or for every channel without an argument.
+
+#pragma once
+
+#include "Command.hpp"
+#include "../IRCClient.hpp"
+#include <string>
+
+inline Command ReadCommand{
+	[](const std::string &input)
+	{
+		return input == "/read" || input.rfind("/read ", 0) == 0;
+	},
+	[](IRCClient &client, const std::string &input)
+	{
+		std::string channel = input.size() > 6 ? input.substr(6) : std::string();
+		if (channel.find_first_of(" ,") != std::string::npos)
+		{
+			client.getUi().drawOutput(":client error :usage: /read [#channel]");
+			return;
+		}
+		if (!channel.empty() && !channel.starts_with('#'))
+			channel.insert(channel.begin(), '#');
+		client.markRead(channel);
+	}};
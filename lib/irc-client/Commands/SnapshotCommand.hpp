@@ -0,0 +1,20 @@
+// File: SnapshotCommand.hpp
+// Requires: C++23
+// Purpose: Defines the `/snapshot` command, which outputs the whole session state (channels,
+//          topics, members with their modes, known users, unread counts and the last sequence
+//          number) as one JSON line, so a UI that attaches boots in a single round trip.
+
+#pragma once
+
+#include "Command.hpp"
+#include "../IRCClient.hpp"
+
+inline Command SnapshotCommand{
+	[](const std::string &input)
+	{
+		return input == "/snapshot";
+	},
+	[](IRCClient &client, const std::string &)
+	{
+		client.getUi().drawOutput(client.formatSnapshot());
+	}};
@@ -0,0 +1,28 @@
+// File: WhoCommand.hpp
+// Requires: C++23
+// Purpose: Defines the `/who #channel` command, which refreshes user, host, account, realname and
+//          away state for every member of a channel with a single WHO/WHOX request.
+
+#pragma once
+
+#include "Command.hpp"
+#include "../IRCClient.hpp"
+#include <string>
+
+inline Command WhoCommand{
+	[](const std::string &input)
+	{
+		return input == "/who" || input.rfind("/who ", 0) == 0;
+	},
+	[](IRCClient &client, const std::string &input)
+	{
+		std::string channel = input.size() > 5 ? input.substr(5) : std::string();
+		if (channel.empty() || channel.find_first_of(" ,") != std::string::npos)
+		{
+			client.getUi().drawOutput(":client error :usage: /who #channel");
+			return;
+		}
+		if (!channel.starts_with('#'))
+			channel.insert(channel.begin(), '#');
+		client.requestWho(channel);
+	}};
@@ -0,0 +1,27 @@
+// File: WhoisCommand.hpp
+// Requires: C++23
+// Purpose: Defines the `/whois <nick>` command, which looks a user up through the session's WHOIS
+//          cache: a fresh result is answered locally, a lookup already in flight is joined, and
+//          only otherwise is a WHOIS sent to the server.
+
+#pragma once
+
+#include "Command.hpp"
+#include "../IRCClient.hpp"
+#include <string>
+
+inline Command WhoisCommand{
+	[](const std::string &input)
+	{
+		return input == "/whois" || input.rfind("/whois ", 0) == 0;
+	},
+	[](IRCClient &client, const std::string &input)
+	{
+		std::string nick = input.size() > 7 ? input.substr(7) : std::string();
+		if (nick.empty() || nick.find_first_of(" ,") != std::string::npos)
+		{
+			client.getUi().drawOutput(":client error :usage: /whois <nick>");
+			return;
+		}
+		client.requestWhois(nick);
+	}};
@@ -0,0 +1,154 @@
+// File: ControlServer.cpp
+// Requires: C++23
+// Purpose: Implements the daemon control socket. Connections are served asynchronously on the
+//          shared io_context; every request is one newline-terminated line and every reply is a
+//          single "ok ..." or "error ..." line.
+
+#include "ControlServer.hpp"
+
+#include <future>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+struct ControlServer::Connection
+{
+	explicit Connection(asio::io_context &context) : socket(context) {}
+
+	asio::local::stream_protocol::socket socket;
+	asio::streambuf buffer;
+	std::string reply;
+};
+
+namespace
+{
+	// Splits "create" arguments on whitespace. A word that does not start a new --option is
+	// folded into the previous one, so values such as --realname=Jane Doe survive intact.
+	std::vector<std::string> splitArgs(std::istringstream &iss)
+	{
+		std::vector<std::string> args;
+		std::string word;
+		while (iss >> word)
+		{
+			if (!args.empty() && !word.starts_with("--"))
+				args.back() += " " + word;
+			else
+				args.push_back(word);
+		}
+		return args;
+	}
+}
+
+ControlServer::ControlServer(asio::io_context &context, const std::string &path, SessionManager &sessions, Logger &logger)
+	: ioContext(context), socketPath(path), sessions(sessions), logger(logger), strand(asio::make_strand(context)),
+	  acceptor(strand)
+{
+}
+
+ControlServer::~ControlServer()
+{
+	// The pool has been joined by now, so no accept handler can be running
+	close();
+}
+
+void ControlServer::start()
+{
+	unlink(socketPath.c_str());
+
+	asio::local::stream_protocol::endpoint endpoint(socketPath);
+	acceptor.open(endpoint.protocol());
+	acceptor.bind(endpoint);
+	acceptor.listen();
+
+	logger.log("Daemon control socket listening: " + socketPath);
+	acceptNext();
+}
+
+void ControlServer::stop()
+{
+	// Closed on the strand, so it cannot race a pending accept or its completion handler
+	std::promise<void> closed;
+	asio::post(strand, [this, &closed]
+			   {
+		close();
+		closed.set_value(); });
+	closed.get_future().wait();
+}
+
+void ControlServer::close()
+{
+	if (!acceptor.is_open())
+		return;
+
+	asio::error_code ec;
+	acceptor.close(ec);
+	unlink(socketPath.c_str());
+}
+
+void ControlServer::acceptNext()
+{
+	auto connection = std::make_shared<Connection>(ioContext);
+	acceptor.async_accept(connection->socket, [this, connection](const asio::error_code &ec)
+						  {
+		if (ec)
+			return;
+		readNext(connection);
+		acceptNext(); });
+}
+
+void ControlServer::readNext(std::shared_ptr<Connection> connection)
+{
+	asio::async_read_until(connection->socket, connection->buffer, '\n',
+						   [this, connection](const asio::error_code &ec, std::size_t)
+						   {
+		if (ec)
+			return;
+
+		std::istream stream(&connection->buffer);
+		std::string line;
+		std::getline(stream, line);
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		connection->reply = execute(line) + "\n";
+		asio::async_write(connection->socket, asio::buffer(connection->reply),
+						  [this, connection](const asio::error_code &ec, std::size_t)
+						  {
+			if (!ec)
+				readNext(connection); }); });
+}
+
+std::string ControlServer::execute(const std::string &line)
+{
+	std::istringstream iss(line);
+	std::string command;
+	iss >> command;
+
+	try
+	{
+		if (command == "create")
+			return sessions.create(splitArgs(iss));
+
+		if (command == "destroy")
+		{
+			std::string instance;
+			iss >> instance;
+			if (instance.empty())
+				return "error destroy requires an instance id";
+			return sessions.destroy(instance);
+		}
+
+		if (command == "list")
+			return sessions.list();
+
+		if (command == "stats")
+			return sessions.stats();
+	}
+	catch (const std::exception &ex)
+	{
+		logger.log("Control command \"" + command + "\" failed: " + ex.what());
+		return std::string("error ") + ex.what();
+	}
+
+	return "error unknown command \"" + command + "\"";
+}
@@ -0,0 +1,51 @@
+// File: ControlServer.hpp
+// Requires: C++23
+// Purpose: Declares the ControlServer class, a line-oriented UNIX domain socket server used in
+//          daemon mode to create, destroy, list and inspect hosted IRC sessions by instance id.
+
+#pragma once
+
+#include <asio.hpp>
+
+#include <memory>
+#include <string>
+
+#include "Logger.hpp"
+#include "SessionManager.hpp"
+
+class ControlServer
+{
+public:
+	ControlServer(asio::io_context &context, const std::string &path, SessionManager &sessions, Logger &logger);
+	~ControlServer();
+
+	// Before the io_context runs
+	void start();
+	// From any thread while the io_context runs; returns once the socket is closed
+	void stop();
+
+	/**
+	 * Executes one control line and returns the single-line reply:
+	 *   create --nick=... --server=... --port=... [--instance=...] [--channels=...] [--sasl]
+	 *   destroy <instance>
+	 *   list
+	 *   stats
+	 */
+	std::string execute(const std::string &line);
+
+private:
+	struct Connection;
+
+	void acceptNext();
+	void readNext(std::shared_ptr<Connection> connection);
+	// Strand only, or once nothing runs the io_context any more
+	void close();
+
+	asio::io_context &ioContext;
+	std::string socketPath;
+	SessionManager &sessions;
+	Logger &logger;
+	// The acceptor is not thread-safe: everything that touches it runs on this strand
+	asio::strand<asio::io_context::executor_type> strand;
+	asio::local::stream_protocol::acceptor acceptor;
+};
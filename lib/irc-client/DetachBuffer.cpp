@@ -0,0 +1,82 @@
+// File: DetachBuffer.cpp
+// Requires: C++23
+// Purpose: Implements the per-channel output buffer of a detached session. Every line carries a
+//          sequence number so the buckets can be merged back into arrival order on replay.
+
+#include "DetachBuffer.hpp"
+#include "IrcMessage.hpp"
+#include "NickTable.hpp"
+
+#include <algorithm>
+#include <vector>
+
+DetachBuffer::DetachBuffer(std::size_t linesPerTarget)
+	: linesPerTarget(linesPerTarget ? linesPerTarget : 1)
+{
+}
+
+void DetachBuffer::add(std::string_view line)
+{
+	std::deque<Entry> &entries = targets[target(line)];
+	entries.push_back({nextSequence++, std::string(line)});
+	++held;
+	if (entries.size() > linesPerTarget)
+	{
+		entries.pop_front();
+		--held;
+		++droppedLines;
+	}
+}
+
+std::size_t DetachBuffer::drain(std::string &out)
+{
+	std::vector<const Entry *> ordered;
+	ordered.reserve(held);
+	std::size_t bytes = 0;
+	for (const auto &[name, entries] : targets)
+	{
+		for (const Entry &entry : entries)
+		{
+			ordered.push_back(&entry);
+			bytes += entry.line.size() + 1;
+		}
+	}
+	std::sort(ordered.begin(), ordered.end(), [](const Entry *a, const Entry *b)
+			  { return a->sequence < b->sequence; });
+
+	out.reserve(out.size() + bytes);
+	for (const Entry *entry : ordered)
+	{
+		out += entry->line;
+		out += '\n';
+	}
+
+	std::size_t count = ordered.size();
+	targets.clear();
+	held = 0;
+	droppedLines = 0;
+	return count;
+}
+
+std::size_t DetachBuffer::size() const noexcept
+{
+	return held;
+}
+
+std::uint64_t DetachBuffer::dropped() const noexcept
+{
+	return droppedLines;
+}
+
+std::size_t DetachBuffer::targetCount() const noexcept
+{
+	return targets.size();
+}
+
+std::string DetachBuffer::target(std::string_view line)
+{
+	IrcMessage message;
+	if (!parseIrcMessage(line, message))
+		return {};
+	return foldNick(channelParam(message), CaseMapping::Rfc1459);
+}
@@ -0,0 +1,48 @@
+// File: DetachBuffer.hpp
+// Requires: C++23
+// Purpose: Declares DetachBuffer, the output a detached session keeps while no UI peer is
+//          attached. Lines are held per channel, each channel capped on its own, so a busy
+//          channel cannot push a quiet one's messages out; server lines and private messages
+//          share one more bucket. The next peer to attach gets it all back in arrival order.
+//          Not thread-safe: guarded by the owning UnixSocketUI's mutex.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class DetachBuffer
+{
+public:
+	// Keeps the newest `linesPerTarget` lines of each channel (and of the shared bucket)
+	explicit DetachBuffer(std::size_t linesPerTarget);
+
+	void add(std::string_view line);
+	// Appends every held line, newline-terminated and oldest first, to `out`, then starts over.
+	// Returns how many lines were appended.
+	std::size_t drain(std::string &out);
+
+	[[nodiscard]] std::size_t size() const noexcept;		// lines held
+	[[nodiscard]] std::uint64_t dropped() const noexcept;	// pushed out by the cap since the last drain
+	[[nodiscard]] std::size_t targetCount() const noexcept; // channels (and the shared bucket) held
+
+	// The casefolded channel a line belongs to, or "" for server lines and private messages
+	static std::string target(std::string_view line);
+
+private:
+	struct Entry
+	{
+		std::uint64_t sequence;
+		std::string line;
+	};
+
+	std::size_t linesPerTarget;
+	std::unordered_map<std::string, std::deque<Entry>> targets;
+	std::uint64_t nextSequence = 0;
+	std::size_t held = 0;
+	std::uint64_t droppedLines = 0;
+};
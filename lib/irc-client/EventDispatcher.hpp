@@ -0,0 +1,159 @@
+// File: EventDispatcher.hpp
+// Requires: C++23
+// Purpose: Defines BasicEventDispatcher, which routes each parsed IrcMessage straight to the
+//          events bound to its command verb or numeric. Numerics index a flat table over
+//          000-999 and verbs a hash map, so dispatch cost does not grow with the number of
+//          registered events. Events can have many subscribers; wildcard subscribers see
+//          every message.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "IrcMessage.hpp"
+
+template <typename Context>
+class BasicEventDispatcher
+{
+public:
+	using Callback = std::function<void(Context &, const IrcMessage &)>;
+	using Guard = std::function<bool(const IrcMessage &)>;
+
+	// Subscribing to this key receives every message
+	static constexpr std::string_view wildcard = "*";
+
+	/**
+	 * Declares the named event `key`, fired by any of `triggers` (verbs such as "PRIVMSG" or
+	 * three-digit numerics such as "353"). `guard`, when set, is checked after routing and can
+	 * veto a message. Redefining a key replaces its triggers and guard but keeps subscribers.
+	 */
+	void define(const std::string &key, std::initializer_list<std::string_view> triggers, Guard guard = {})
+	{
+		auto [it, inserted] = eventIndex.try_emplace(key, events.size());
+		if (inserted)
+			events.push_back(Event{key, {}, {}});
+		else
+			unroute(it->second);
+
+		events[it->second].guard = std::move(guard);
+		for (std::string_view trigger : triggers)
+			route(trigger, it->second);
+	}
+
+	// Adds a subscriber to the event `key`, or to every message for `wildcard`
+	void subscribe(const std::string &key, Callback callback)
+	{
+		if (key == wildcard)
+		{
+			wildcardCallbacks.push_back(std::move(callback));
+			return;
+		}
+
+		auto it = eventIndex.find(key);
+		if (it == eventIndex.end())
+			throw std::runtime_error(":client error :add handler event key '" + key + "' is not registered.");
+		events[it->second].callbacks.push_back(std::move(callback));
+	}
+
+	// Adds a subscriber to a raw verb or numeric, defining an event named after it on first use
+	void subscribeCommand(std::string_view command, Callback callback)
+	{
+		std::string key(command);
+		if (!eventIndex.contains(key))
+			define(key, {command});
+		subscribe(key, std::move(callback));
+	}
+
+	[[nodiscard]] bool isDefined(const std::string &key) const { return eventIndex.contains(key); }
+
+	// Runs every subscriber of every event routed from the message's command, then wildcards
+	void dispatch(Context &context, const IrcMessage &message) const
+	{
+		if (const Route *route = find(message))
+		{
+			for (std::uint16_t index : *route)
+			{
+				const Event &event = events[index];
+				if (event.callbacks.empty() || (event.guard && !event.guard(message)))
+					continue;
+				for (const auto &callback : event.callbacks)
+					callback(context, message);
+			}
+		}
+
+		for (const auto &callback : wildcardCallbacks)
+			callback(context, message);
+	}
+
+private:
+	using Route = std::vector<std::uint16_t>; // indices into `events`
+
+	struct Event
+	{
+		std::string key;
+		Guard guard;
+		std::vector<Callback> callbacks;
+	};
+
+	struct StringHash
+	{
+		using is_transparent = void;
+		std::size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+	};
+
+	[[nodiscard]] const Route *find(const IrcMessage &message) const
+	{
+		if (message.numeric != 0)
+		{
+			std::uint16_t slot = numericRoutes[message.numeric];
+			return slot ? &routes[slot - 1] : nullptr;
+		}
+
+		auto it = verbRoutes.find(message.command);
+		return it != verbRoutes.end() ? &routes[it->second - 1] : nullptr;
+	}
+
+	void route(std::string_view trigger, std::size_t index)
+	{
+		std::uint16_t *slot = nullptr;
+		if (std::uint16_t numeric = parseIrcNumeric(trigger))
+			slot = &numericRoutes[numeric];
+		else
+			slot = &verbRoutes.try_emplace(std::string(trigger), 0).first->second;
+
+		if (*slot == 0)
+		{
+			routes.emplace_back();
+			*slot = static_cast<std::uint16_t>(routes.size());
+		}
+		routes[*slot - 1].push_back(static_cast<std::uint16_t>(index));
+	}
+
+	void unroute(std::size_t index)
+	{
+		for (auto &route : routes)
+			std::erase(route, static_cast<std::uint16_t>(index));
+	}
+
+	// Slot 0 means "no route"; otherwise slot - 1 indexes `routes`. Keeping the numeric table
+	// as 16-bit slots holds it to 2 KiB per session.
+	std::array<std::uint16_t, 1000> numericRoutes{};
+	std::unordered_map<std::string, std::uint16_t, StringHash, std::equal_to<>> verbRoutes;
+	std::vector<Route> routes;
+
+	std::vector<Event> events;
+	std::unordered_map<std::string, std::size_t> eventIndex;
+	std::vector<Callback> wildcardCallbacks;
+};
+
+class IRCClient;
+using EventDispatcher = BasicEventDispatcher<IRCClient>;
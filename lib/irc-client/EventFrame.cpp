@@ -0,0 +1,94 @@
+// File: EventFrame.cpp
+// Requires: C++23
+// Purpose: Implements event framing. The JSON is written straight into the caller's buffer and
+//          the header put in front of it afterwards, once its length is known.
+
+#include "EventFrame.hpp"
+#include "IrcMessage.hpp"
+#include "Json.hpp"
+
+#include <charconv>
+#include <format>
+#include <iterator>
+#include <optional>
+
+namespace
+{
+	void appendTags(std::string &out, std::string_view tags)
+	{
+		out += '{';
+		bool first = true;
+		while (!tags.empty())
+		{
+			std::size_t end = tags.find(';');
+			std::string_view item = tags.substr(0, end);
+			tags.remove_prefix(end == std::string_view::npos ? tags.size() : end + 1);
+			if (item.empty())
+				continue;
+
+			std::size_t eq = item.find('=');
+			if (!first)
+				out += ',';
+			first = false;
+			appendJsonKey(out, item.substr(0, eq));
+			if (eq == std::string_view::npos)
+				appendJsonString(out, {});
+			else if (item.find('\\', eq) == std::string_view::npos)
+				appendJsonString(out, item.substr(eq + 1));
+			else
+				appendJsonString(out, unescapeTagValue(item.substr(eq + 1)));
+		}
+		out += '}';
+	}
+}
+
+void appendEventFrame(std::string &out, std::string_view line, std::uint64_t sequence)
+{
+	IrcMessage message;
+	bool parsed = parseIrcMessage(line, message);
+	std::string_view type = parsed ? message.command : std::string_view("raw");
+
+	std::size_t start = out.size();
+	std::format_to(std::back_inserter(out), "{{\"seq\":{},\"type\":", sequence);
+	appendJsonString(out, type);
+	out += ",\"nick\":";
+	appendJsonString(out, message.nick);
+	out += ",\"channel\":";
+	appendJsonString(out, parsed ? channelParam(message) : std::string_view());
+	out += ",\"text\":";
+	appendJsonString(out, parsed ? message.trailing() : line);
+	out += ",\"prefix\":";
+	appendJsonString(out, message.prefix);
+	out += ",\"params\":[";
+	for (std::size_t i = 0; i < message.paramCount; ++i)
+	{
+		if (i != 0)
+			out += ',';
+		appendJsonString(out, message.params[i]);
+	}
+	out += "],\"tags\":";
+	appendTags(out, message.tags);
+	out += "}\n";
+
+	std::string header = std::format("{} {} ", out.size() - start - 1, type);
+	out.insert(start, header);
+}
+
+std::size_t appendEventFrames(std::string &out, std::string_view lines)
+{
+	std::size_t count = 0;
+	for (std::size_t end; (end = lines.find('\n')) != std::string_view::npos; lines.remove_prefix(end + 1))
+	{
+		std::string_view line = lines.substr(0, end);
+		std::uint64_t sequence = 0;
+		IrcMessage message;
+		if (parseIrcMessage(line, message))
+		{
+			if (std::optional<std::string_view> seq = message.tag("eirc/seq"))
+				std::from_chars(seq->data(), seq->data() + seq->size(), sequence);
+		}
+		appendEventFrame(out, line, sequence);
+		++count;
+	}
+	return count;
+}
@@ -0,0 +1,28 @@
+// File: EventFrame.hpp
+// Requires: C++23
+// Purpose: Declares the framed event form of UI output, for peers that negotiate it with
+//          `/protocol events`. Each line is parsed once here and sent as
+//          "<length> <type> <json>\n": <length> counts the JSON bytes and <type> repeats the
+//          event type, so a reader can route a frame without decoding it. Frames stay
+//          newline-terminated and the JSON never holds a raw newline, so the UI's queueing and
+//          whole-line dropping work unchanged.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Appends `line` (without its terminator) as one frame holding
+ * {"seq","type","nick","channel","text","prefix","params","tags"}. `type` is the command or
+ * numeric (the kind, for the session's own `:client <kind> ...` lines, whose prefix is
+ * "client"), or "raw" for a line that does not parse, which becomes the text. `text` is the
+ * last param and `channel` the channel the line is about, if any; tag values are unescaped.
+ */
+void appendEventFrame(std::string &out, std::string_view line, std::uint64_t sequence);
+
+// Frames every newline-terminated line of `lines`. A line tagged eirc/seq is numbered from it,
+// anything else (replayed scrollback, `:client` replies) gets sequence 0. Returns the frame count.
+std::size_t appendEventFrames(std::string &out, std::string_view lines);
@@ -0,0 +1,19 @@
+// File: CapHandler.hpp
+// Requires: C++23
+// Purpose: Defines a handler for CAP replies (LS, ACK, NAK, DEL). Invokes IRCClient::handleCap,
+//          which requests the capabilities the session wants and ends negotiation when they are
+//          settled.
+
+#pragma once
+
+#include "../IRCClient.hpp"
+#include <functional>
+#include <string>
+
+inline std::function<void(IRCClient &, const IrcMessage &)> capHandler()
+{
+	return [](IRCClient &client, const IrcMessage &message)
+	{
+		client.handleCap(message);
+	};
+}
@@ -0,0 +1,60 @@
+// File: DefaultHandlers.hpp
+// Requires: C++23
+// Purpose: Builds the default event handler table every IRC session registers. Shared by the
+//          single-session process and by sessions hosted in daemon mode.
+
+#pragma once
+
+#include "../IRCClient.hpp"
+#include "../IRCEventKeys.hpp"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CapHandler.hpp"
+#include "MembershipHandler.hpp"
+#include "MotdEndHandler.hpp"
+#include "NameReplyHandler.hpp"
+#include "PingHandler.hpp"
+#include "WhoHandler.hpp"
+#include "WhoisHandler.hpp"
+
+// Add new handlers here:
+// return {
+//     {IRCEventKey::PrivMsg, {
+//          channelMsgHandler(),
+//          userToUserMsgHandler(),
+//      }},
+//     {IRCEventKey::Notice, {
+//          noticeHandler(),
+//      }},
+//     {IRCEventKey::MotdEnd, {motdEndHandler()}},
+//     {IRCEventKey::RplNameReply, {nameReplyHandler()}},
+//     {IRCEventKey::Ping, {pingHandler()}},
+//     {IRCEventKey::Whois, {whoisHandler()}},
+// };
+
+inline std::map<std::string, std::vector<std::function<void(IRCClient &, const IrcMessage &)>>> buildHandlers()
+{
+    return {
+        {IRCEventKey::Cap, {capHandler()}},
+        {IRCEventKey::MotdEnd, {motdEndHandler()}},
+        {IRCEventKey::RplNameReply, {nameReplyHandler()}},
+        {IRCEventKey::Membership, {membershipHandler()}},
+        {IRCEventKey::Ping, {pingHandler()}},
+        {IRCEventKey::Whois, {whoisHandler()}},
+        {IRCEventKey::Who, {whoHandler()}},
+    };
+}
+
+inline void registerDefaultHandlers(IRCClient &client)
+{
+    for (const auto &[event, handlers] : buildHandlers())
+    {
+        for (const auto &handler : handlers)
+        {
+            client.addEventHandler(event, handler);
+        }
+    }
+}
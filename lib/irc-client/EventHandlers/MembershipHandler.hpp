@@ -0,0 +1,19 @@
+// File: MembershipHandler.hpp
+// Requires: C++23
+// Purpose: Defines a handler for membership events (JOIN, PART, KICK, QUIT, NICK, channel MODE,
+//          RPL_ENDOFNAMES and the ISUPPORT tokens they depend on). Invokes
+//          IRCClient::handleMembership to apply each change to the session's channel members.
+
+#pragma once
+
+#include "../IRCClient.hpp"
+#include <functional>
+#include <string>
+
+inline std::function<void(IRCClient &, const IrcMessage &)> membershipHandler()
+{
+	return [](IRCClient &client, const IrcMessage &message)
+	{
+		client.handleMembership(message);
+	};
+}
@@ -9,9 +9,9 @@
 #include <functional>
 #include <string>
 
-inline std::function<void(IRCClient &, const std::string &)> motdEndHandler()
+inline std::function<void(IRCClient &, const IrcMessage &)> motdEndHandler()
 {
-	return [](IRCClient &client, const std::string &)
+	return [](IRCClient &client, const IrcMessage &)
 	{
 		// Handles the "joinedChannels" list.
 		// User can select a list of channel names (joinedChannels) when connecting.
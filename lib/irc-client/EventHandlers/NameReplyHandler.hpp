@@ -9,10 +9,10 @@
 #include <functional>
 #include <string>
 
-inline std::function<void(IRCClient &, const std::string &)> nameReplyHandler()
+inline std::function<void(IRCClient &, const IrcMessage &)> nameReplyHandler()
 {
-	return [](IRCClient &client, const std::string &line)
+	return [](IRCClient &client, const IrcMessage &message)
 	{
-		client.handleNameReply(line);
+		client.handleNameReply(message);
 	};
 }
@@ -9,10 +9,10 @@
 #include <functional>
 #include <string>
 
-inline std::function<void(IRCClient &, const std::string &)> pingHandler()
+inline std::function<void(IRCClient &, const IrcMessage &)> pingHandler()
 {
-	return [](IRCClient &client, const std::string &line)
+	return [](IRCClient &client, const IrcMessage &message)
 	{
-		client.handlePing(line);
+		client.handlePing(message);
 	};
 }
@@ -9,10 +9,10 @@
 #include <functional>
 #include <string>
 
-inline std::function<void(IRCClient &, const std::string &)> privmsgHandler()
+inline std::function<void(IRCClient &, const IrcMessage &)> privmsgHandler()
 {
-	return [](IRCClient &client, const std::string &line)
+	return [](IRCClient &client, const IrcMessage &message)
 	{
-		client.getLogger().log("[PRIVMSG] " + line + "\n");
+		client.getLogger().log(LogCategory::Protocol, LogLevel::Debug, "[PRIVMSG] {}", message.raw);
 	};
 }
@@ -0,0 +1,72 @@
+// File: WhoHandler.hpp
+// Requires: C++23
+// Purpose: Provides inline handlers for WHO replies (352) and WHOX replies (354). One WHO per
+//          channel fills in user, host, account, realname and away state for every member in the
+//          session's user table; each reply marks its user, so the burst publishes them all.
+
+#pragma once
+
+#include "../IRCClient.hpp"
+#include <functional>
+#include <string>
+#include <string_view>
+
+inline void handle352(IRCClient &, const IrcMessage &);
+inline void handle354(IRCClient &, const IrcMessage &);
+
+// Main WHO dispatcher
+inline std::function<void(IRCClient &, const IrcMessage &)> whoHandler()
+{
+	return [](IRCClient &client, const IrcMessage &message) -> void
+	{
+		switch (message.numeric)
+		{
+		case 352:
+			return handle352(client, message);
+		case 354:
+			return handle354(client, message);
+		}
+	};
+}
+
+// Flags start with H (here) or G (gone), followed by * for opers and the member's prefixes
+inline bool whoFlagsAway(std::string_view flags)
+{
+	return flags.starts_with('G');
+}
+
+// WHO 352: <target> <channel> <user> <host> <server> <nick> <flags> :<hopcount> <realname>
+inline void handle352(IRCClient &client, const IrcMessage &message)
+{
+	User *user = client.findUser(message.param(5));
+	if (!user)
+		return;
+
+	std::string_view realname = message.param(7);
+	std::size_t space = realname.find(' ');
+	realname.remove_prefix(space == std::string_view::npos ? realname.size() : space + 1);
+
+	user->username = message.param(2);
+	user->host = message.param(3);
+	user->realname = realname;
+	user->away = whoFlagsAway(message.param(6));
+}
+
+// WHOX 354 for %tcuhnfar: <target> <type> <channel> <user> <host> <nick> <flags> <account> :<realname>
+inline void handle354(IRCClient &client, const IrcMessage &message)
+{
+	// Someone else's WHOX asked for different fields
+	if (message.param(1) != IRCClient::whoxQueryType)
+		return;
+
+	User *user = client.findUser(message.param(5));
+	if (!user)
+		return;
+
+	std::string_view account = message.param(7);
+	user->username = message.param(3);
+	user->host = message.param(4);
+	user->account = account == "0" ? std::string_view() : account;
+	user->realname = message.param(8);
+	user->away = whoFlagsAway(message.param(6));
+}
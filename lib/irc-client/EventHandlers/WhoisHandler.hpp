@@ -1,174 +1,123 @@
 // File: WhoisHandler.hpp
 // Requires: C++23
-// Purpose: Provides inline WHOIS response handlers for various IRC numeric codes (311–319).
-//          Dispatches parsed user metadata into the IRCClient's internal user map and logs
-//          a formatted WHOIS summary once complete.
+// Purpose: Provides inline WHOIS response handlers for the WHOIS numerics (301, 311–319, 330, 401).
+//          Each reply is collected into the session's WhoisCache; RPL_ENDOFWHOIS completes the
+//          result, which is cached and published to the UI as one structured event.
 
 #pragma once
 
 #include "../IRCClient.hpp"
+#include <charconv>
 #include <functional>
 #include <string>
 
-inline void handle301(IRCClient &, const std::string &);
-inline void handle311(IRCClient &, const std::string &);
-inline void handle312(IRCClient &, const std::string &);
-inline void handle313(IRCClient &, const std::string &);
-inline void handle317(IRCClient &, const std::string &);
-inline void handle318(IRCClient &, const std::string &);
-inline void handle319(IRCClient &, const std::string &);
+inline void handle301(IRCClient &, const IrcMessage &);
+inline void handle311(IRCClient &, const IrcMessage &);
+inline void handle312(IRCClient &, const IrcMessage &);
+inline void handle313(IRCClient &, const IrcMessage &);
+inline void handle317(IRCClient &, const IrcMessage &);
+inline void handle318(IRCClient &, const IrcMessage &);
+inline void handle319(IRCClient &, const IrcMessage &);
+inline void handle330(IRCClient &, const IrcMessage &);
+inline void handle401(IRCClient &, const IrcMessage &);
 
 // Main WHOIS dispatcher
-inline std::function<void(IRCClient &, const std::string &)> whoisHandler()
+inline std::function<void(IRCClient &, const IrcMessage &)> whoisHandler()
 {
-	return [](IRCClient &client, const std::string &line) -> void
+	return [](IRCClient &client, const IrcMessage &message) -> void
 	{
-		if (line.find(" 311 ") != std::string::npos)
-			return handle311(client, line);
-		if (line.find(" 312 ") != std::string::npos)
-			return handle312(client, line);
-		if (line.find(" 317 ") != std::string::npos)
-			return handle317(client, line);
-		if (line.find(" 318 ") != std::string::npos)
-			return handle318(client, line);
-		if (line.find(" 319 ") != std::string::npos)
-			return handle319(client, line);
-		if (line.find(" 301 ") != std::string::npos)
-			return handle301(client, line);
-		if (line.find(" 313 ") != std::string::npos)
-			return handle313(client, line);
+		switch (message.numeric)
+		{
+		case 311:
+			return handle311(client, message);
+		case 312:
+			return handle312(client, message);
+		case 317:
+			return handle317(client, message);
+		case 318:
+			return handle318(client, message);
+		case 319:
+			return handle319(client, message);
+		case 301:
+			return handle301(client, message);
+		case 313:
+			return handle313(client, message);
+		case 330:
+			return handle330(client, message);
+		case 401:
+			return handle401(client, message);
+		}
 	};
 }
 
-// Helper: find or create user
-User *findOrCreateUser(IRCClient &client, const std::string &nick)
+// WHOIS 311: <target> <nick> <user> <host> * :<realname>
+inline void handle311(IRCClient &client, const IrcMessage &message)
 {
-	auto &users = client.getUsers();
-	auto it = users.find(nick);
-	if (it != users.end())
-		return const_cast<User *>(&it->second);
-
-	// Add to user map if not found
-	auto &userMap = const_cast<std::map<std::string, User> &>(users);
-	auto [newIt, _] = userMap.emplace(nick, User{nick, "", std::nullopt});
-	return &newIt->second;
+	WhoisState &whois = client.getWhoisCache().collect(message.param(1));
+	whois.nick = message.param(1);
+	whois.exists = true;
+	whois.username = message.param(2); // Save ident/username
+	whois.host = message.param(3);	   // Save host separately
+	whois.realname = message.param(5);
 }
 
-// WHOIS 311
-inline void handle311(IRCClient &client, const std::string &line)
+// WHOIS 312: <target> <nick> <server> :<server info>
+inline void handle312(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick, user, host, star;
-	std::string realname;
-	iss >> prefix >> code >> target >> nick >> user >> host >> star;
-	std::getline(iss, realname);
-	realname = realname.substr(2); // strip " :"
-
-	User *u = findOrCreateUser(client, nick);
-	if (!u->whoisState)
-		u->whoisState.emplace();
-	u->whoisState->username = user; // Save ident/username
-	u->whoisState->host = host;		// Save host separately
-	u->whoisState->realname = realname;
+	WhoisState &whois = client.getWhoisCache().collect(message.param(1));
+	whois.server = message.param(2);
+	whois.serverInfo = message.param(3);
 }
 
-// WHOIS 312
-inline void handle312(IRCClient &client, const std::string &line)
+// WHOIS 317: <target> <nick> <idle> <signon> :seconds idle, signon time
+inline void handle317(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick, server, serverInfo;
-	iss >> prefix >> code >> target >> nick >> server;
-	std::getline(iss, serverInfo);
-	serverInfo = serverInfo.substr(2);
-
-	User *u = findOrCreateUser(client, nick);
-	if (!u->whoisState)
-		u->whoisState.emplace();
-	u->whoisState->server = server;
-	u->whoisState->serverInfo = serverInfo;
+	WhoisState &whois = client.getWhoisCache().collect(message.param(1));
+	std::string_view idle = message.param(2);
+	std::string_view signon = message.param(3);
+	std::from_chars(idle.data(), idle.data() + idle.size(), whois.idleSeconds);
+	std::from_chars(signon.data(), signon.data() + signon.size(), whois.signonTime);
 }
 
-// WHOIS 317
-inline void handle317(IRCClient &client, const std::string &line)
+// WHOIS 319: <target> <nick> :<channels> (long lists arrive over several lines)
+inline void handle319(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick, idle, signon;
-	iss >> prefix >> code >> target >> nick >> idle >> signon;
-
-	User *u = findOrCreateUser(client, nick);
-	if (!u->whoisState)
-		u->whoisState.emplace();
-	u->whoisState->idleSeconds = idle;
-	u->whoisState->signonTime = signon;
+	WhoisState &whois = client.getWhoisCache().collect(message.param(1));
+	if (!whois.channels.empty())
+		whois.channels += ' ';
+	whois.channels += message.param(2);
 }
 
-// WHOIS 319
-inline void handle319(IRCClient &client, const std::string &line)
+// WHOIS 318 (final step): cache the result and publish it
+inline void handle318(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick;
-	iss >> prefix >> code >> target >> nick;
-
-	std::string remainder;
-	std::getline(iss, remainder);
-	remainder = remainder.substr(2); // strip " :"
-
-	User *u = findOrCreateUser(client, nick);
-	if (!u->whoisState)
-		u->whoisState.emplace();
-	u->whoisState->channels = remainder;
+	client.completeWhois(message.param(1));
 }
 
-// WHOIS 318 (final step)
-inline void handle318(IRCClient &client, const std::string &line)
+// WHOIS 301: <target> <nick> :<away message>
+inline void handle301(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick;
-	iss >> prefix >> code >> target >> nick;
-
-	User *u = findOrCreateUser(client, nick);
-	if (!u || !u->whoisState)
-		return;
-
-	// const WhoisState &ws = *u->whoisState;
-	// std::stringstream out;
-	// out << "WHOIS: " << u->nick << "\n"
-	// 	<< "  Real Name: " << ws.realname << "\n"
-	// 	<< "  Server: " << ws.server << " (" << ws.serverInfo << ")\n"
-	// 	<< "  Channels: " << ws.channels << "\n"
-	// 	<< "  Idle: " << ws.idleSeconds << "s, Signon: " << ws.signonTime;
-
-	// client.getLogger().log(out.str());
-	// client.getUi().drawOutput(out.str());
-
-	// Optionally clear WHOIS info
-	// u->whoisState.reset();
+	// 301 also answers a PRIVMSG to someone away; only a WHOIS in progress keeps it
+	if (WhoisState *whois = client.getWhoisCache().collecting(message.param(1)))
+		whois->awayMessage = message.param(2);
 }
 
-inline void handle301(IRCClient &client, const std::string &line)
+// WHOIS 313: <target> <nick> :is an IRC operator
+inline void handle313(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick;
-	iss >> prefix >> code >> target >> nick;
-
-	std::string awayMsg;
-	std::getline(iss, awayMsg);
-	awayMsg = awayMsg.substr(2);
-
-	User *u = findOrCreateUser(client, nick);
-	if (!u->whoisState)
-		u->whoisState.emplace();
-	u->whoisState->awayMessage = awayMsg;
+	client.getWhoisCache().collect(message.param(1)).isOperator = true;
 }
 
-inline void handle313(IRCClient &client, const std::string &line)
+// WHOIS 330: <target> <nick> <account> :is logged in as
+inline void handle330(IRCClient &client, const IrcMessage &message)
 {
-	std::istringstream iss(line);
-	std::string prefix, code, target, nick;
-	iss >> prefix >> code >> target >> nick;
+	client.getWhoisCache().collect(message.param(1)).account = message.param(2);
+}
 
-	User *u = findOrCreateUser(client, nick);
-	if (!u->whoisState)
-		u->whoisState.emplace();
-	u->whoisState->isOperator = true;
+// ERR_NOSUCHNICK 401: <target> <nick> :No such nick/channel
+inline void handle401(IRCClient &client, const IrcMessage &message)
+{
+	// Also the answer to a PRIVMSG to nobody; only a WHOIS in progress records it
+	if (WhoisState *whois = client.getWhoisCache().collecting(message.param(1)))
+		whois->exists = false;
 }
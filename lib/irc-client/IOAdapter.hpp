@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Abstract base class for user input/output handling
 class IOAdapter
@@ -17,5 +21,28 @@ public:
 	virtual void init() = 0;
 	virtual void shutdown() = 0;
 	virtual void drawOutput(const std::string &line) = 0;
-	virtual std::string getInput() = 0;
+	// Pushes out whatever drawOutput() has batched; the session calls it after every burst
+	virtual void flushOutput() {}
+	// Number of the last line drawOutput() took; 0 when the adapter does not number its output
+	virtual std::uint64_t lastSequence() const { return 0; }
+
+	// Descriptor that becomes readable when getInput() has something to return; -1 if none.
+	virtual int inputFd() const = 0;
+
+	// Never blocks. std::nullopt when no input is ready yet; an empty string once the
+	// peer has gone away.
+	virtual std::optional<std::string> getInput() = 0;
+
+	// Never blocks. Appends every command that is ready to `commands` and returns false once
+	// the peer has gone away, so a burst of pipelined commands is handled in one pass.
+	virtual bool getInputBatch(std::vector<std::string> &commands)
+	{
+		while (std::optional<std::string> input = getInput())
+		{
+			if (input->empty())
+				return false;
+			commands.push_back(std::move(*input));
+		}
+		return true;
+	}
 };
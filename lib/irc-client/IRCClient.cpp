@@ -1,13 +1,17 @@
 // File: IRCClient.cpp
 // Requires: C++23
 // Purpose: Implements the core IRC client logic including command registration, event dispatching,
-//          async input/output loops, and channel/user state management using C++23 features like
-//          lambda expressions with captures, structured bindings, and improved standard containers.
+//          coroutine-based input/output loops on a single strand, and channel/user state management
+//          using C++23 features like lambda expressions with captures, structured bindings, and
+//          improved standard containers.
 
 #include "IRCClient.hpp"
 #include "IRCEventKeys.hpp"
-#include <thread>
+#include <charconv>
+#include <chrono>
 #include <sstream>
+#include <algorithm>
+#include <tuple>
 #include <array>
 #include <system_error>
 #include <asio/error_code.hpp>
@@ -16,10 +20,30 @@
 #include "Commands/UsersCommand.hpp"
 #include "Commands/ChannelsCommand.hpp"
 #include "Commands/InputCommand.hpp"
+#include "Commands/LogCommand.hpp"
+#include "Commands/QueueCommand.hpp"
+#include "Commands/WhoisCommand.hpp"
+#include "Commands/WhoCommand.hpp"
+#include "Commands/SnapshotCommand.hpp"
+#include "Commands/ReadCommand.hpp"
+
+IRCClient::IRCClient(asio::io_context &context, Logger &logger, IOAdapter &ui, const std::vector<std::string> &channels,
+                     OutboundOptions outboundOptions, WhoisOptions whoisOptions, HistoryOptions historyOptions)
+    : ioContext(context),
+      strand(asio::make_strand(context)),
+      logger(logger),
+      ui(ui),
+      outbound(outboundOptions),
+      writeSignal(strand),
+      taskSignal(strand),
+      closeDeadline(strand),
+      channelsJoined(false),
+      whois(whoisOptions),
+      history(std::move(historyOptions)),
+      joinedChannels(channels)
+{
+    history.load();
 
-IRCClient::IRCClient(asio::io_context &context, Logger &logger, IOAdapter &ui, const std::vector<std::string> &channels)
-    : ioContext(context), logger(logger), ui(ui), channelsJoined(false), joinedChannels(channels)
-{
     std::string joinedList;
     for (const auto &ch : channels)
     {
@@ -33,9 +57,47 @@ IRCClient::IRCClient(asio::io_context &context, Logger &logger, IOAdapter &ui, c
     registerEventHandlers();
 }
 
+namespace
+{
+    // Keepalives and MOTD text: most of the raw traffic, almost never worth keeping at info
+    bool isChatter(const IrcMessage &message)
+    {
+        switch (message.numeric)
+        {
+        case 372: // RPL_MOTD
+        case 375: // RPL_MOTDSTART
+        case 376: // RPL_ENDOFMOTD
+            return true;
+        default:
+            return message.is("PING") || message.is("PONG");
+        }
+    }
+
+    // Keepalive, capability/SASL negotiation and registration: dispatched before any UI work
+    // for the line, so nothing the UI peers do can delay the reply
+    bool isProtocolCritical(const IrcMessage &message)
+    {
+        switch (message.numeric)
+        {
+        case 376: // RPL_ENDOFMOTD / ERR_NOMOTD: registration done, auto-join
+        case 422:
+        case 903: // RPL_SASLSUCCESS and failures, which end CAP negotiation
+        case 904:
+        case 905:
+        case 906:
+        case 907:
+            return true;
+        default:
+            return message.is("PING") || message.is("CAP") || message.is("AUTHENTICATE");
+        }
+    }
+}
+
 IRCClient::~IRCClient()
 {
-    joinInputLoop();
+    // The UI owns its descriptor; never let asio close it
+    if (uiInput)
+        uiInput->release();
 }
 
 void IRCClient::registerCommands()
@@ -44,284 +106,656 @@ void IRCClient::registerCommands()
         QuitCommand,
         UsersCommand,
         ChannelsCommand,
-        InputCommand};
+        InputCommand,
+        LogCommand,
+        QueueCommand,
+        WhoisCommand,
+        WhoCommand,
+        SnapshotCommand,
+        ReadCommand};
 }
 
 void IRCClient::registerEventHandlers()
 {
-    eventHandlers[IRCEventKey::Ping] = EventHandler{
-        [](const std::string &line)
-        { return line.starts_with("PING "); },
-        {}};
-
-    eventHandlers[IRCEventKey::RplNameReply] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" 353 ") != std::string::npos; },
-        {}};
-
-    eventHandlers[IRCEventKey::MotdEnd] = EventHandler{
-        [this](const std::string &line)
-        {
-            return !isChannelsJoined()
-                && (line.find("376") != std::string::npos || line.find("422") != std::string::npos);
-        },
-        {}};
-
-    eventHandlers[IRCEventKey::Privmsg] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" PRIVMSG ") != std::string::npos; },
-        {}};
-
-    eventHandlers[IRCEventKey::Cap] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" CAP ") != std::string::npos; },
-        {}};
-
-    eventHandlers[IRCEventKey::Whois] = EventHandler{
-        [](const std::string &line)
-        {
-            return line.find(" 311 ") != std::string::npos ||
-                   line.find(" 312 ") != std::string::npos ||
-                   line.find(" 317 ") != std::string::npos ||
-                   line.find(" 318 ") != std::string::npos ||
-                   line.find(" 319 ") != std::string::npos;
-        },
-        {}};
+    dispatcher.define(IRCEventKey::Ping, {"PING"});
+    dispatcher.define(IRCEventKey::RplNameReply, {"353"});
+    // 001 = welcome (our nick), 005 = ISUPPORT (PREFIX, CHANMODES), 366 = end of NAMES,
+    // 331/332 = no topic/topic on join
+    dispatcher.define(IRCEventKey::Membership, {"001", "005", "331", "332", "366", "JOIN", "PART", "KICK", "QUIT",
+                                                "NICK", "MODE", "TOPIC"});
+    // 376 = end of MOTD, 422 = no MOTD
+    dispatcher.define(IRCEventKey::MotdEnd, {"376", "422"}, [this](const IrcMessage &)
+                      { return !isChannelsJoined(); });
+    dispatcher.define(IRCEventKey::Privmsg, {"PRIVMSG"});
+    dispatcher.define(IRCEventKey::Cap, {"CAP"});
+    // 330 = logged in as (account), 401 = no such nick
+    dispatcher.define(IRCEventKey::Whois, {"301", "311", "312", "313", "317", "318", "319", "330", "401"});
+    // 352 = WHO reply, 354 = WHOX reply
+    dispatcher.define(IRCEventKey::Who, {"352", "354"});
 
     // 903 = SASL authentication successful
-    eventHandlers["903"] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" 903 ") != std::string::npos; },
-        {}};
+    dispatcher.define("903", {"903"});
     // 904 = SASL authentication failed
-    eventHandlers["904"] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" 904 ") != std::string::npos; },
-        {}};
+    dispatcher.define("904", {"904"});
     // 905 = SASL mechanism too long
-    eventHandlers["905"] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" 905 ") != std::string::npos; },
-        {}};
+    dispatcher.define("905", {"905"});
     // 906 = SASL aborted
-    eventHandlers["906"] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" 906 ") != std::string::npos; },
-        {}};
+    dispatcher.define("906", {"906"});
     // 907 = SASL already in progress
-    eventHandlers["907"] = EventHandler{
-        [](const std::string &line)
-        { return line.find(" 907 ") != std::string::npos; },
-        {}};
+    dispatcher.define("907", {"907"});
 }
 
-template <typename SocketType>
-void IRCClient::writeToSocket(SocketType &socket, const std::string &message)
-{
-    // explicit data pointer + length
-    asio::write(socket,
-                asio::buffer(message.data(), message.size()));
-}
-
-void IRCClient::connect(const std::string &server, int port)
+asio::awaitable<void> IRCClient::connect(const std::string &server, int port)
 {
     useTls = (port == 6697);
-    asio::ip::tcp::resolver resolver(ioContext);
-    auto endpoints = resolver.resolve(server, std::to_string(port));
+    asio::ip::tcp::resolver resolver(strand);
+    auto endpoints = co_await resolver.async_resolve(server, std::to_string(port), asio::use_awaitable);
 
     if (useTls)
     {
-        sslContext.emplace(asio::ssl::context::tlsv12_client);
-        sslContext->set_verify_mode(asio::ssl::verify_none);
+        if (!sharedSslContext)
+        {
+            sslContext.emplace(asio::ssl::context::tlsv12_client);
+            sslContext->set_verify_mode(asio::ssl::verify_none);
+        }
 
-        sslSocket = std::make_unique<ssl_stream>(ioContext, *sslContext);
-        asio::connect(sslSocket->next_layer(), endpoints);
+        sslSocket = std::make_unique<ssl_stream>(strand, sharedSslContext ? *sharedSslContext : *sslContext);
+        co_await asio::async_connect(sslSocket->next_layer(), endpoints, asio::use_awaitable);
 
         // → Perform TLS handshake with explicit error handling
         asio::error_code ec;
-        sslSocket->handshake(asio::ssl::stream_base::client, ec);
+        co_await sslSocket->async_handshake(asio::ssl::stream_base::client, asio::redirect_error(asio::use_awaitable, ec));
         if (ec)
         {
             throw std::runtime_error("TLS handshake failed: " + ec.message());
         }
-
-        socketWriter = [this](const std::string &msg)
-        {
-            writeToSocket(*sslSocket, msg);
-        };
     }
     else
     {
-        plainSocket = std::make_unique<tcp_socket>(ioContext);
-        asio::connect(*plainSocket, endpoints);
-        socketWriter = [this](const std::string &msg)
-        {
-            writeToSocket(*plainSocket, msg);
-        };
+        plainSocket = std::make_unique<tcp_socket>(strand);
+        co_await asio::async_connect(*plainSocket, endpoints, asio::use_awaitable);
     }
 }
 
 void IRCClient::authenticate(const std::string &nick, const std::string &user, const std::string &realname)
 {
-    writeToServer(std::format("NICK {}\nUSER {} 0 * :{}\n", nick, user, realname));
+    membership.setSelf(nick);
+    // Servers without IRCv3 ignore CAP and register on NICK/USER alone
+    writeToServer(std::format("CAP LS 302\nNICK {}\nUSER {} 0 * :{}\n", nick, user, realname));
 }
 
-std::size_t IRCClient::readFromServer(char *buf, std::size_t size)
+void IRCClient::endCapabilityNegotiation()
 {
-    if (useTls && sslSocket)
-        return sslSocket->read_some(asio::buffer(buf, size));
-    if (plainSocket)
-        return plainSocket->read_some(asio::buffer(buf, size));
-    throw std::runtime_error("No socket available to read data.");
+    if (capabilitiesEnded)
+        return;
+    capabilitiesEnded = true;
+    writeToServer("CAP END\n");
+}
+
+Capabilities &IRCClient::getCapabilities()
+{
+    return capabilities;
 }
 
-void IRCClient::startInputLoop()
+void IRCClient::handleCap(const IrcMessage &message)
 {
-    inputThread = std::thread([this]
+    // CAP <target> <subcommand> [*] :<capabilities>; a '*' before the list means more follows
+    std::string_view subcommand = message.param(1);
+    std::string_view list = message.trailing();
+
+    if (subcommand == "LS")
+    {
+        if (!capabilities.offered(list, message.paramCount > 3 && message.param(2) == "*"))
+            return;
+        std::string request = capabilities.requestList();
+        if (request.empty())
         {
-        try {
-            while (running.load()) {
-                std::string input = ui.getInput();
-                sanitizeInput(input);
-                if (input.empty()) {
-                    logger.log("Socket client disconnected");
-                    signoff(getChannels(), "eIRC ( https://github.com/jesse-greathouse/eIRC )");
-                    break;
-                }
-
-                bool handled = false;
-                for (const auto &command : commands) {
-                    if (command.predicate(input)) {
-                        command.handler(*this, input);
-                        handled = true;
-                        break;
-                    }
-                }
-
-                if (!handled) {
-                    throw std::runtime_error(":client error :Unrecognized command: \"" + input + "\"");
-                }
+            endCapabilityNegotiation();
+            return;
+        }
+        writeToServer("CAP REQ :" + request + "\n");
+        capabilities.requested();
+        return;
+    }
 
-            }
-        } catch (const std::exception &ex) {
-            const std::string message = "Fatal error in input thread: " + std::string(ex.what());
-            logger.log(message);
-            logger.flush();
-            std::exit(1);
-        } });
+    if (subcommand == "ACK")
+        capabilities.acknowledged(list);
+    else if (subcommand == "NAK")
+        capabilities.rejected(list);
+    else if (subcommand == "DEL")
+        capabilities.withdrawn(list);
+    else
+        return;
+
+    ui.drawOutput(":client caps :" + capabilities.enabledList());
+    // With SASL acknowledged, CAP END waits for the authentication result (903-907)
+    if (capabilities.settled() && !capabilities.isEnabled("sasl"))
+        endCapabilityNegotiation();
 }
 
-void IRCClient::readLoop(const std::vector<std::string> &channels)
+void IRCClient::start(const std::string &server, int port, std::function<void(std::exception_ptr)> onFinished)
 {
-    std::array<char, 1024> buf;
-    std::string buffer;
+    asio::co_spawn(strand, run(server, port), asio::bind_executor(strand, std::move(onFinished)));
+}
+
+asio::awaitable<void> IRCClient::run(std::string server, int port)
+{
+    try
+    {
+        co_await connect(server, port);
+    }
+    catch (...)
+    {
+        running = false;
+        throw;
+    }
+
+    spawnTask(writeQueued());
+    spawnTask(readInput());
+    spawnTask(readServer());
+
+    while (activeTasks > 0)
+    {
+        asio::error_code ec;
+        taskSignal.expires_at(asio::steady_timer::time_point::max());
+        co_await taskSignal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+    }
+
+    running = false;
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+void IRCClient::spawnTask(asio::awaitable<void> task)
+{
+    ++activeTasks;
+    asio::co_spawn(strand, std::move(task), asio::bind_executor(strand, [this](std::exception_ptr ex)
+                                                                {
+        if (ex)
+        {
+            if (!failure)
+                failure = ex;
+            stop();
+        }
+
+        --activeTasks;
+        taskSignal.cancel(); }));
+}
 
+asio::awaitable<void> IRCClient::readServer()
+{
+    while (true)
+    {
+        std::span<char> space = inbound.prepare();
+        asio::mutable_buffer buffer(space.data(), space.size());
+
+        asio::error_code ec;
+        std::size_t len = useTls
+                              ? co_await sslSocket->async_read_some(buffer, asio::redirect_error(asio::use_awaitable, ec))
+                              : co_await plainSocket->async_read_some(buffer, asio::redirect_error(asio::use_awaitable, ec));
+        if (ec || len == 0)
+            break;
+
+        inbound.commit(len);
+        processInbound();
+    }
+
+    logger.log(LogCategory::Protocol, LogLevel::Info, "Disconnected.");
+    ui.drawOutput("Disconnected.");
+    ui.flushOutput();
+    stop();
+}
+
+asio::awaitable<void> IRCClient::readInput()
+{
+    int fd = ui.inputFd();
+    if (fd < 0)
+    {
+        // Same as a peer that went away: nobody can ever drive this session
+        logger.log(LogCategory::Ui, LogLevel::Info, "Socket client disconnected");
+        signoff(getChannels(), "eIRC ( https://github.com/jesse-greathouse/eIRC )");
+        co_return;
+    }
+
+    // The descriptor stays owned by the UI; release it however this task ends
+    struct ReleaseOnExit
+    {
+        std::optional<asio::posix::stream_descriptor> &descriptor;
+        ~ReleaseOnExit()
+        {
+            if (descriptor)
+                descriptor->release();
+            descriptor.reset();
+        }
+    } guard{uiInput};
+    uiInput.emplace(strand, fd);
+
+    std::vector<std::string> commands;
     while (running.load())
     {
-        std::size_t len = readFromServer(buf.data(), buf.size());
-        if (len == 0)
+        asio::error_code ec;
+        co_await uiInput->async_wait(asio::posix::stream_descriptor::wait_read, asio::redirect_error(asio::use_awaitable, ec));
+        if (ec)
             break;
 
-        buffer.append(buf.data(), len);
+        // Every complete command that is ready, handled as one batch without blocking the strand
+        commands.clear();
+        bool attached = ui.getInputBatch(commands);
+        for (std::string &command : commands)
+        {
+            if (!running.load())
+                break;
+
+            sanitizeInput(command);
+            if (!command.empty())
+                handleCommand(command);
+        }
+        publishState();
+        ui.flushOutput();
 
-        std::size_t pos;
-        while ((pos = buffer.find('\n')) != std::string::npos)
+        if (!attached)
         {
-            std::string line = buffer.substr(0, pos);
-            if (!line.empty() && line.back() == '\r')
-                line.pop_back();
+            logger.log(LogCategory::Ui, LogLevel::Info, "Socket client disconnected");
+            signoff(getChannels(), "eIRC ( https://github.com/jesse-greathouse/eIRC )");
+            co_return;
+        }
+    }
+}
 
-            buffer.erase(0, pos + 1);
+asio::awaitable<void> IRCClient::writeQueued()
+{
+    std::string batch;
+    while (true)
+    {
+        // Priority lines plus whatever the flood bucket allows, in one write; no pacing once closing
+        auto now = OutboundQueue::Clock::now();
+        batch.clear();
+        outbound.take(batch, now, closing);
 
-            logger.log(line);
-            ui.drawOutput(line);
+        if (batch.empty())
+        {
+            if (closing && outbound.empty())
+                break;
+
+            // Sleeps until the next token, or until writeToServer() queues something
+            asio::error_code ec;
+            writeSignal.expires_at(outbound.nextReady(now));
+            co_await writeSignal.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+            continue;
+        }
 
-            for (const auto &[key, handler] : eventHandlers)
-            {
-                if (handler.predicate(line))
-                {
-                    for (const auto &fn : handler.handlers)
-                        fn(*this, line);
-                    break;
-                }
-            }
+        asio::error_code ec;
+        if (useTls)
+            co_await asio::async_write(*sslSocket, asio::buffer(batch), asio::redirect_error(asio::use_awaitable, ec));
+        else
+            co_await asio::async_write(*plainSocket, asio::buffer(batch), asio::redirect_error(asio::use_awaitable, ec));
+
+        if (ec)
+        {
+            logger.log(LogCategory::Protocol, LogLevel::Error, "! write failed: {}", ec.message());
+            outbound.clear();
+            break;
         }
     }
+    logger.log(LogCategory::Protocol, LogLevel::Info, "Outbound queue latency: {}", outbound.describe());
+    const WhoisStats &whoisStats = whois.stats();
+    logger.log(LogCategory::Protocol, LogLevel::Info, "WHOIS cache: hits={} misses={} coalesced={} evicted={}",
+               whoisStats.hits, whoisStats.misses, whoisStats.coalesced, whoisStats.evicted);
+    if (!history.save())
+        logger.log(LogCategory::Protocol, LogLevel::Error, "! Could not save chathistory cursors");
 
-    logger.log("Disconnected.");
-    ui.drawOutput("Disconnected.");
+    // Everything queued before stop() has been flushed; closing ends the read task too
+    closeSockets();
 }
 
-template <typename SocketType>
-void writeToServer(SocketType &socket, const std::string &message)
+void IRCClient::handleCommand(const std::string &input)
 {
-    asio::write(socket,
-                asio::buffer(message.data(), message.size()));
+    for (const auto &command : commands)
+    {
+        if (command.predicate(input))
+        {
+            command.handler(*this, input);
+            return;
+        }
+    }
+
+    throw std::runtime_error(":client error :Unrecognized command: \"" + input + "\"");
 }
 
-void IRCClient::writeToServer(const std::string &message)
+void IRCClient::processInbound()
+{
+    std::string_view view;
+    while (inbound.next(view))
+    {
+        // Logger and UI still take std::string; reusing one buffer keeps this allocation-free
+        currentLine.assign(view);
+        linesReceived.fetch_add(1, std::memory_order_relaxed);
+
+        // Parsed once here; every predicate and handler works off the same views
+        if (!parseIrcMessage(currentLine, currentMessage))
+        {
+            ui.drawOutput(currentLine);
+            logger.log(LogCategory::RawIn, LogLevel::Info, currentLine);
+            continue;
+        }
+
+        // Keepalives never wait for a batch to close
+        if (isProtocolCritical(currentMessage))
+        {
+            deliver(currentLine, currentMessage);
+            continue;
+        }
+
+        switch (batches.add(currentMessage))
+        {
+        case BatchCollector::Result::Unbatched:
+            deliver(currentLine, currentMessage);
+            break;
+        case BatchCollector::Result::Held:
+            break;
+        case BatchCollector::Result::Ready:
+            deliverBatch();
+            break;
+        }
+    }
+
+    // One snapshot and one write per peer for the whole burst
+    publishState();
+    ui.flushOutput();
+}
+
+void IRCClient::deliver(const std::string &line, const IrcMessage &message)
+{
+    bool critical = isProtocolCritical(message);
+    if (critical)
+        dispatcher.dispatch(*this, message);
+
+    // Live channel traffic moves the channel's chathistory cursor, and counts as unread unless ours
+    if ((message.is("PRIVMSG") || message.is("NOTICE")) && membership.find(message.param(0)))
+    {
+        if (std::optional<std::string_view> time = message.tag("time"))
+            history.observe(message.param(0), *time);
+        if (!membership.nicks().equal(message.nick, membership.self()))
+            state.countUnread(membership.channelKey(message.param(0)));
+    }
+
+    ui.drawOutput(line);
+    logger.log(LogCategory::RawIn, isChatter(message) ? LogLevel::Debug : LogLevel::Info, line);
+
+    if (!critical)
+        dispatcher.dispatch(*this, message);
+}
+
+void IRCClient::deliverBatch()
+{
+    // The whole batch goes out in this burst: one publish and one write per peer for all of it
+    const Batch &batch = batches.ready();
+    if (batch.type == "chathistory")
+    {
+        deliverHistory(batch);
+        batches.release();
+        return;
+    }
+
+    activeBatch = &batch;
+    for (const std::string &line : batch.lines)
+    {
+        if (parseIrcMessage(line, batchMessage))
+            deliver(line, batchMessage);
+    }
+    activeBatch = nullptr;
+    batches.release();
+}
+
+void IRCClient::deliverHistory(const Batch &batch)
+{
+    // BATCH +ref chathistory <target>; the messages happened before this session saw them, so
+    // they only move the cursor and reach the peers (the batch lines included, for grouping)
+    const std::string &target = batch.params.empty() ? batch.reference : batch.params.front();
+    for (const std::string &line : batch.lines)
+    {
+        ui.drawOutput(line);
+        logger.log(LogCategory::RawIn, LogLevel::Debug, line);
+        if (parseIrcMessage(line, batchMessage))
+        {
+            if (std::optional<std::string_view> time = batchMessage.tag("time"))
+                history.observe(target, *time);
+        }
+    }
+
+    if (batch.closed)
+    {
+        ui.drawOutput(std::format(":client history {} :{}", target, history.cursor(target)));
+        history.save();
+    }
+}
+
+const Batch *IRCClient::getBatch() const noexcept
 {
-    if (!socketWriter)
-        throw std::runtime_error("Socket writer not initialized");
-    socketWriter(message);
+    return activeBatch;
 }
 
-void IRCClient::handlePing(const std::string &message)
+void IRCClient::publishState()
 {
-    // 1) Extract the ping payload
-    std::string payload = message.substr(message.find(':') + 1);
-    payload.erase(std::remove(payload.begin(), payload.end(), '\r'), payload.end());
-    payload.erase(std::remove(payload.begin(), payload.end(), '\n'), payload.end());
+    state.publish(membership);
+}
 
-    // 2) Build the PONG response
-    std::string response = "PONG :" + payload + "\n";
+void IRCClient::writeToServer(const std::string &message)
+{
+    asio::dispatch(strand, [this, message]
+                   {
+        if (closing)
+            return;
+        outbound.push(message, OutboundQueue::Clock::now());
+        writeSignal.cancel(); });
+}
+
+void IRCClient::handlePing(const IrcMessage &message)
+{
+    // 1) Build the PONG response from the ping payload
+    std::string response = "PONG :" + std::string(message.trailing()) + "\n";
 
-    // 3) Attempt send, log success; on error, catch and log exception
+    // 2) Attempt send, log success; on error, catch and log exception
     try
     {
         writeToServer(response);
-        logger.log("→ " + response.substr(0, response.size() - 1));
+        logger.log(LogCategory::RawOut, LogLevel::Debug, "→ PONG :{}", message.trailing());
     }
     catch (const std::exception &ex)
     {
-        logger.log("! PONG failed: " + std::string(ex.what()));
+        logger.log(LogCategory::Protocol, LogLevel::Error, "! PONG failed: {}", ex.what());
     }
 }
 
-void IRCClient::handleNameReply(const std::string &rawLine)
+void IRCClient::handleNameReply(const IrcMessage &message)
 {
-    std::istringstream iss(rawLine);
-    std::string prefix, code, target, visibility, channelName, remainder;
-    iss >> prefix >> code >> target >> visibility >> channelName;
-    std::getline(iss, remainder);
-
-    auto pos = remainder.find(':');
-    auto nickList = (pos != std::string::npos) ? remainder.substr(pos + 1) : remainder;
-    std::istringstream nickStream(nickList);
+    // :server 353 <target> <visibility> <channel> :<nick list>
+    // Pages accumulate; the member list only changes (and is published) at 366
+    membership.namesReply(message.param(2), message.param(3));
+}
 
-    Channel &channel = channels[channelName];
-    channel.name = channelName;
-    channel.users.clear();
+void IRCClient::handleMembership(const IrcMessage &message)
+{
+    switch (message.numeric)
+    {
+    case 1:
+        // :server 001 <nick> :Welcome ... (the server may have changed the nick we asked for)
+        membership.setSelf(message.param(0));
+        serverName = message.nick;
+        return;
+    case 5:
+        // :server 005 <nick> <token>... :are supported by this server
+        for (std::size_t i = 1; i + 1 < message.paramCount; ++i)
+        {
+            std::string_view token = message.param(i);
+            if (token.starts_with("PREFIX="))
+                membership.setPrefixes(token.substr(7));
+            else if (token.starts_with("CHANMODES="))
+                membership.setChannelModes(token.substr(10));
+            else if (token == "WHOX")
+                whox = true;
+            else if (token.starts_with("CHATHISTORY="))
+            {
+                std::size_t limit = 0;
+                std::from_chars(token.data() + 12, token.data() + token.size(), limit);
+                history.setServerLimit(limit);
+            }
+            else if (token.starts_with("CASEMAPPING="))
+            {
+                membership.setCaseMapping(token.substr(12));
+                whois.setCaseMapping(membership.nicks().caseMapping());
+                history.setCaseMapping(membership.nicks().caseMapping());
+            }
+        }
+        return;
+    case 331:
+    case 332:
+        // :server 332 <nick> <channel> :topic (331 carries "No topic is set")
+        if (membership.setTopic(message.param(1), message.numeric == 332 ? message.param(2) : std::string_view()))
+            state.markTopic(std::string(message.param(1)));
+        return;
+    case 366:
+        // :server 366 <nick> <channel> :End of /NAMES list. The member list was replaced whole
+        membership.namesEnd(message.param(1));
+        state.markChannel(std::string(message.param(1)));
+        return;
+    default:
+        break;
+    }
 
-    std::string nick;
-    while (nickStream >> nick)
+    // Each change marks just the members it moved; ids are taken first, as PART and QUIT may
+    // reclaim them. Our own JOIN or PART starts the channel over.
+    NickTable &nicks = membership.nicks();
+    touchedChannels.clear();
+    if (message.is("JOIN"))
     {
-        std::string status;
-        if (!nick.empty() && (nick[0] == '@' || nick[0] == '+'))
+        std::string channel(message.param(0));
+        membership.join(channel, message.nick);
+        // NAMES comes with the join; WHO fills in everything else for the whole channel at once
+        if (nicks.equal(message.nick, membership.self()))
         {
-            status = nick[0];
-            nick.erase(0, 1);
+            state.markChannel(channel);
+            requestWho(channel);
+            requestHistory(channel);
+        }
+        else if (NickId id = nicks.find(message.nick); id != noNick)
+            state.markMember(channel, id);
+    }
+    else if (message.is("PART") || message.is("KICK"))
+    {
+        // :nick PART <channel> [:reason] and :op KICK <channel> <nick> :reason
+        std::string channel(message.param(0));
+        std::string_view nick = message.is("KICK") ? message.param(1) : message.nick;
+        NickId id = nicks.find(nick);
+        bool self = nicks.equal(nick, membership.self());
+        membership.part(channel, nick);
+        if (self)
+            state.markChannel(channel);
+        else if (id != noNick)
+            state.markMember(channel, id);
+    }
+    else if (message.is("QUIT"))
+    {
+        NickId id = nicks.find(message.nick);
+        membership.quit(message.nick, touchedChannels);
+        for (const std::string &channel : touchedChannels)
+            state.markMember(channel, id);
+        whois.invalidate(message.nick);
+    }
+    else if (message.is("NICK"))
+    {
+        // A stale entry still holding the new nick loses its memberships to the rename
+        NickId id = nicks.find(message.nick);
+        NickId stale = nicks.find(message.param(0));
+        membership.rename(message.nick, message.param(0), touchedChannels);
+        for (const std::string &channel : touchedChannels)
+        {
+            state.markMember(channel, id);
+            if (stale != noNick && stale != id)
+                state.markMember(channel, stale);
+        }
+        whois.invalidate(message.nick);
+        whois.invalidate(message.param(0));
+    }
+    else if (message.is("TOPIC"))
+    {
+        // :nick TOPIC <channel> :new topic (empty clears it)
+        if (membership.setTopic(message.param(0), message.param(1)))
+            state.markTopic(std::string(message.param(0)));
+    }
+    else if (message.is("MODE") && message.paramCount >= 2 && membership.find(message.param(0)))
+    {
+        // :op MODE <channel> <modes> [args...]; user modes (MODE <nick> ...) are not tracked
+        std::string channel(message.param(0));
+        std::span<const std::string_view> args(message.params.data() + 2, message.paramCount - 2);
+        membership.mode(channel, message.param(1), args);
+        // Only prefix modes change a member, and their parameter is its nick
+        for (std::string_view arg : args)
+        {
+            if (NickId id = nicks.find(arg); id != noNick)
+                state.markMember(channel, id);
         }
-        auto *user = findOrCreateUser(nick);
-        user->status = status;
-        channel.users.push_back(user);
     }
 }
 
-User *IRCClient::findOrCreateUser(const std::string &nick)
+void IRCClient::requestWhois(const std::string &nick)
 {
-    auto [it, inserted] = users.try_emplace(nick, User{nick, {}});
-    return &it->second;
+    const WhoisState *result = nullptr;
+    switch (whois.request(nick, WhoisCache::Clock::now(), result))
+    {
+    case WhoisCache::Request::Send:
+        writeToServer("WHOIS " + nick + "\n");
+        logger.log(LogCategory::RawOut, LogLevel::Info, "→ WHOIS {}", nick);
+        break;
+    case WhoisCache::Request::Pending:
+        logger.log(LogCategory::Protocol, LogLevel::Debug, "WHOIS {} already in flight", nick);
+        break;
+    case WhoisCache::Request::Cached:
+        // The same numerics the server would send, then the event, without a round trip
+        for (const std::string &line : WhoisCache::toNumerics(*result, serverName, membership.self()))
+            ui.drawOutput(line);
+        ui.drawOutput(std::format(":client whois {} :{}", result->nick, WhoisCache::toJson(*result, true)));
+        break;
+    }
+}
+
+void IRCClient::completeWhois(std::string_view nick)
+{
+    if (const WhoisState *result = whois.complete(nick, WhoisCache::Clock::now()))
+        ui.drawOutput(std::format(":client whois {} :{}", result->nick, WhoisCache::toJson(*result, false)));
+}
+
+WhoisCache &IRCClient::getWhoisCache()
+{
+    return whois;
+}
+
+void IRCClient::requestWho(const std::string &channel)
+{
+    std::string request = whox ? std::format("WHO {} %{},{}\n", channel, whoxFields, whoxQueryType)
+                               : std::format("WHO {}\n", channel);
+    writeToServer(request);
+    logger.log(LogCategory::RawOut, LogLevel::Info, "→ " + request);
+}
+
+void IRCClient::requestHistory(const std::string &channel)
+{
+    if (!history.enabled() || !capabilities.isEnabled("draft/chathistory"))
+        return;
+    std::string request = history.request(channel);
+    writeToServer(request);
+    logger.log(LogCategory::RawOut, LogLevel::Info, "→ " + request);
+}
+
+User *IRCClient::findUser(std::string_view nick)
+{
+    NickTable &users = membership.nicks();
+    NickId id = users.find(nick);
+    if (id == noNick)
+        return nullptr;
+    // Handed out to be filled in; the next publish shows whatever the caller changes
+    state.markUser(id);
+    return &users.user(id);
 }
 
 void IRCClient::joinChannels(const std::vector<std::string> &channels)
@@ -333,30 +767,59 @@ void IRCClient::joinChannels(const std::vector<std::string> &channels)
     }
 }
 
-void IRCClient::signoff(const std::map<std::string, Channel> &channels, const std::string &quitMessage)
+void IRCClient::signoff(const ChannelMap &channels, const std::string &quitMessage)
 {
     for (const auto &pair : channels)
     {
         const std::string &chan = pair.first;
         std::string partMsg = "PART " + chan + " :Bye bye\n";
         writeToServer(partMsg);
-        logger.log("→ " + partMsg);
+        logger.log(LogCategory::RawOut, LogLevel::Info, "→ " + partMsg);
     }
 
     std::string quitMsg = "QUIT :" + quitMessage + "\n";
     writeToServer(quitMsg);
-    logger.log("→ " + quitMsg);
+    logger.log(LogCategory::RawOut, LogLevel::Info, "→ " + quitMsg);
 
     stop();
 }
 
+void IRCClient::quit(const std::string &quitMessage)
+{
+    asio::dispatch(strand, [this, quitMessage]
+                   {
+        if (!closing)
+            signoff(membership.channels(), quitMessage); });
+}
+
 void IRCClient::stop()
 {
     running = false;
+    asio::dispatch(strand, [this]
+                   {
+        if (closing)
+            return;
+        closing = true;
+
+        // Let the writer flush what is queued, but never wait on a stuck server forever
+        writeSignal.cancel();
+        if (uiInput)
+            uiInput->cancel();
+        closeDeadline.expires_after(std::chrono::seconds(5));
+        closeDeadline.async_wait([this](const asio::error_code &ec)
+                                 {
+            if (!ec)
+                closeSockets(); }); });
+}
+
+void IRCClient::closeSockets()
+{
+    asio::error_code ec;
     if (plainSocket)
-        plainSocket->close();
+        plainSocket->close(ec);
     if (sslSocket)
-        sslSocket->lowest_layer().close();
+        sslSocket->lowest_layer().close(ec);
+    closeDeadline.cancel();
 }
 
 std::string IRCClient::formatUserList(const std::string &channelName) const
@@ -370,13 +833,22 @@ std::string IRCClient::formatUserList(const std::string &channelName) const
     if (!chan.starts_with('#'))
         chan.insert(chan.begin(), '#');
 
-    auto it = channels.find(chan);
-    if (it == channels.end() || it->second.users.empty())
+    std::shared_ptr<const SessionSnapshot> snapshot = state.snapshot();
+    auto it = snapshot->channels.find(foldNick(chan, snapshot->caseMapping));
+    if (it == snapshot->channels.end() || it->second->members.empty())
         return std::format(":client error :channel {} not found or no users.", chan);
 
+    // Members are hashed; order them for display here rather than on every publish
+    std::vector<const MemberSnapshot *> members;
+    members.reserve(it->second->members.size());
+    for (const MemberSnapshot &member : it->second->members)
+        members.push_back(&member);
+    std::ranges::sort(members, [](const MemberSnapshot *a, const MemberSnapshot *b)
+                      { return std::tie(a->rank, a->nick) < std::tie(b->rank, b->nick); });
+
     std::string response;
-    for (const User *user : it->second.users)
-        response += std::format("{}{}, ", user->status, user->nick);
+    for (const MemberSnapshot *member : members)
+        response += std::format("{}{}, ", member->status, member->nick);
 
     if (!response.empty())
         response.pop_back(), response.pop_back();
@@ -385,27 +857,42 @@ std::string IRCClient::formatUserList(const std::string &channelName) const
 
 std::string IRCClient::formatChannelList() const
 {
-    if (channels.empty())
+    std::shared_ptr<const SessionSnapshot> snapshot = state.snapshot();
+    if (snapshot->channels.empty())
         return ":client channels: ";
     std::string response;
-    for (auto it = channels.begin(); it != channels.end(); ++it)
+    for (auto it = snapshot->channels.begin(); it != snapshot->channels.end(); ++it)
     {
         if (!response.empty())
             response += ", ";
-        response += it->first;
+        response += it->second->name;
     }
     return ":client channels :" + response;
 }
 
-void IRCClient::addEventHandler(const std::string &eventKey, std::function<void(IRCClient &, const std::string &)> handler)
+void IRCClient::addEventHandler(const std::string &eventKey, std::function<void(IRCClient &, const IrcMessage &)> handler)
 {
-    auto it = eventHandlers.find(eventKey);
-    if (it == eventHandlers.end())
-    {
-        throw std::runtime_error(":client error :add handler event key '" + eventKey + "' is not registered.");
-    }
+    dispatcher.subscribe(eventKey, std::move(handler));
+}
+
+void IRCClient::addCommandHandler(std::string_view command, std::function<void(IRCClient &, const IrcMessage &)> handler)
+{
+    dispatcher.subscribeCommand(command, std::move(handler));
+}
+
+void IRCClient::setTlsContext(asio::ssl::context &context)
+{
+    sharedSslContext = &context;
+}
 
-    it->second.handlers.push_back(std::move(handler));
+std::uint64_t IRCClient::getLinesReceived() const noexcept
+{
+    return linesReceived.load(std::memory_order_relaxed);
+}
+
+bool IRCClient::isRunning() const noexcept
+{
+    return running.load();
 }
 
 void IRCClient::sanitizeInput(std::string &input)
@@ -415,23 +902,37 @@ void IRCClient::sanitizeInput(std::string &input)
                 input.end());
 }
 
-void IRCClient::joinInputLoop()
+std::shared_ptr<const SessionSnapshot> IRCClient::getSnapshot() const
 {
-    // Tell the loop to exit (unblocks read()/getInput())
-    stop();
+    return state.snapshot();
+}
+
+std::string IRCClient::formatSnapshot()
+{
+    // On the strand every line drawn so far has been applied; publishing now makes the snapshot
+    // and the sequence number describe the same moment
+    publishState();
+    return ":client snapshot :" + SessionState::toJson(*state.snapshot(), membership.self(), ui.lastSequence());
+}
+
+void IRCClient::markRead(const std::string &channel)
+{
+    state.markRead(membership.channelKey(channel));
+}
 
-    if (inputThread.joinable())
-        inputThread.join();
+const ChannelMap &IRCClient::getChannels() const
+{
+    return membership.channels();
 }
 
-const std::map<std::string, Channel> &IRCClient::getChannels() const
+const Membership &IRCClient::getMembership() const
 {
-    return channels;
+    return membership;
 }
 
-const std::map<std::string, User> &IRCClient::getUsers() const
+const NickTable &IRCClient::getUsers() const
 {
-    return users;
+    return membership.nicks();
 }
 
 const std::vector<std::string> &IRCClient::getJoinedChannels() const
@@ -459,6 +960,16 @@ IOAdapter &IRCClient::getUi()
     return ui;
 }
 
+const OutboundQueue &IRCClient::getOutboundQueue() const
+{
+    return outbound;
+}
+
+IRCClient::strand_type &IRCClient::getStrand()
+{
+    return strand;
+}
+
 template <>
 asio::ip::tcp::socket &IRCClient::getSocket<asio::ip::tcp::socket>()
 {
@@ -3,6 +3,7 @@
 // Purpose: Declares the IRCClient class, which manages the lifecycle of an IRC session,
 //          including connection, authentication, input/output loops, command execution,
 //          event handling, and channel/user state. Central class in the client architecture.
+//          Every task of a session is an asio coroutine serialized on the session's strand.
 
 #pragma once
 
@@ -11,21 +12,32 @@
 #include <asio/ssl.hpp>
 
 #include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
-#include <thread>
 #include <vector>
 #include <stdexcept>
 
+#include "BatchCollector.hpp"
+#include "Capabilities.hpp"
 #include "Channel.hpp"
+#include "ChatHistory.hpp"
 #include "Commands/Command.hpp"
-#include "EventHandler.hpp"
+#include "EventDispatcher.hpp"
 #include "IOAdapter.hpp"
+#include "IrcMessage.hpp"
+#include "LineFramer.hpp"
 #include "Logger.hpp"
+#include "Membership.hpp"
+#include "OutboundQueue.hpp"
+#include "SessionState.hpp"
 #include "User.hpp"
+#include "WhoisCache.hpp"
 
 
 class IRCClient
@@ -33,46 +45,110 @@ class IRCClient
 public:
 	using tcp_socket = asio::ip::tcp::socket;
 	using ssl_stream = asio::ssl::stream<tcp_socket>;
+	using strand_type = asio::strand<asio::io_context::executor_type>;
 
-	IRCClient(asio::io_context &context, Logger &logger, IOAdapter &ui, const std::vector<std::string> &channels);
+	IRCClient(asio::io_context &context, Logger &logger, IOAdapter &ui, const std::vector<std::string> &channels,
+			  OutboundOptions outboundOptions = {}, WhoisOptions whoisOptions = {}, HistoryOptions historyOptions = {});
 
 	~IRCClient();
 
 	/**
-	 * Establish a connection to `server:port`.
-	 * If port==6697, performs a TLS handshake (may throw std::runtime_error on failure).
+	 * Runs the whole session on this client's strand: connects to `server:port`, then serves
+	 * server reads, UI input and queued writes until either side goes away. Completes only once
+	 * every task of the session has finished, rethrowing the first failure.
+	 * If port==6697, performs a TLS handshake (throws std::runtime_error on failure).
 	 */
-	void connect(const std::string &server, int port);
+	asio::awaitable<void> run(std::string server, int port);
+
+	// co_spawns run() on the strand; `onFinished` receives the failure, if any
+	void start(const std::string &server, int port, std::function<void(std::exception_ptr)> onFinished);
+
+	// Starts IRCv3 capability negotiation (CAP LS 302), then sends NICK and USER
 	void authenticate(const std::string &nick, const std::string &user, const std::string &realname);
-	void startInputLoop();
-	void readLoop(const std::vector<std::string> &channels);
-	void joinInputLoop();
+	// Sends CAP END once; registration completes after it. SASL calls this when it is done.
+	void endCapabilityNegotiation();
+	// Strategies add what they need (e.g. "sasl") before authenticate()
+	Capabilities &getCapabilities();
+
+	// Thread-safe: close the session, flushing anything already queued for the server first
 	void stop();
-	void signoff(const std::map<std::string, Channel> &channels, const std::string &quitMessage);
+	// Thread-safe: PART every channel and QUIT, then stop()
+	void quit(const std::string &quitMessage);
+	void signoff(const ChannelMap &channels, const std::string &quitMessage);
+	// Thread-safe: queues `message` for the session's single writer
 	void writeToServer(const std::string &message);
 
 	void joinChannels(const std::vector<std::string> &channels);
 
-	void addEventHandler(const std::string &eventKey, std::function<void(IRCClient &, const std::string &)> handler);
+	// Subscribes to a registered IRCEventKey, or to every message with IRCEventKey::Any
+	void addEventHandler(const std::string &eventKey, std::function<void(IRCClient &, const IrcMessage &)> handler);
+	// Subscribes to a raw command verb or numeric ("JOIN", "366") without a named event
+	void addCommandHandler(std::string_view command, std::function<void(IRCClient &, const IrcMessage &)> handler);
+
+	// Share one TLS context between sessions hosted in the same process (daemon mode)
+	void setTlsContext(asio::ssl::context &context);
+
+	[[nodiscard]] std::uint64_t getLinesReceived() const noexcept;
+	[[nodiscard]] bool isRunning() const noexcept;
 
 	[[nodiscard]] bool isChannelsJoined() const noexcept;
 	void setChannelsJoined(bool value);
 
+	// Both read the published snapshot, so they are safe from any thread
 	[[nodiscard]] std::string formatUserList(const std::string &channelName) const;
 	[[nodiscard]] std::string formatChannelList() const;
 
-	[[nodiscard]] const std::vector<std::string> &getJoinedChannels() const;
-	[[nodiscard]] const std::map<std::string, User> &getUsers() const;
-	[[nodiscard]] const std::map<std::string, Channel> &getChannels() const;
+	// Latest published channel/user state; thread-safe and never blocks the session
+	[[nodiscard]] std::shared_ptr<const SessionSnapshot> getSnapshot() const;
+	// `:client snapshot :<json>` of the whole session, up to date with every line drawn so far.
+	// Strand only: it publishes pending changes first.
+	[[nodiscard]] std::string formatSnapshot();
+	// Resets the unread count of `channel`, or of every channel when empty. Strand only.
+	void markRead(const std::string &channel);
 
-	User *findOrCreateUser(const std::string &nick);
+	// The batch whose lines are being dispatched, so a handler can treat it as one unit (a
+	// "BATCH" handler sees the closing line last); nullptr outside a batch. Strand only.
+	[[nodiscard]] const Batch *getBatch() const noexcept;
+
+	// Live state: session strand only
+	[[nodiscard]] const std::vector<std::string> &getJoinedChannels() const;
+	[[nodiscard]] const NickTable &getUsers() const;
+	[[nodiscard]] const ChannelMap &getChannels() const;
+	[[nodiscard]] const Membership &getMembership() const;
+
+	// WHOIS through the cache: answered from it when fresh, joined when already in flight, sent
+	// otherwise. Strand only.
+	void requestWhois(const std::string &nick);
+	// RPL_ENDOFWHOIS: caches the collected result and publishes `:client whois <nick> :<json>`
+	void completeWhois(std::string_view nick);
+	WhoisCache &getWhoisCache();
+
+	// Fields and query type of the WHOX request; 354 replies carry the type back
+	static constexpr std::string_view whoxFields = "tcuhnfar";
+	static constexpr std::string_view whoxQueryType = "152";
+	// Asks for the user, host, account, realname and away state of every member of `channel` in
+	// one round trip: WHOX when the server advertises it, plain WHO (no account) otherwise
+	void requestWho(const std::string &channel);
+	// User table entry for `nick`, or nullptr if we share no channel with them. Marks the user for
+	// the next publish, so WHO replies show up in every channel they share with us. Strand only.
+	User *findUser(std::string_view nick);
+
+	// With draft/chathistory: asks for what `channel` missed since its cursor (or the latest
+	// messages without one). The reply arrives as one chathistory batch.
+	void requestHistory(const std::string &channel);
 
 	Logger &getLogger();
 	IOAdapter &getUi();
+	strand_type &getStrand();
+	[[nodiscard]] const OutboundQueue &getOutboundQueue() const;
 
 	// Public for use in event handlers
-	void handlePing(const std::string &message);
-	void handleNameReply(const std::string &rawLine);
+	void handlePing(const IrcMessage &message);
+	void handleNameReply(const IrcMessage &message);
+	// 001, 005, 366, JOIN, PART, KICK, QUIT, NICK and channel MODE; our own JOIN also sends WHO
+	void handleMembership(const IrcMessage &message);
+	// CAP LS/ACK/NAK/DEL
+	void handleCap(const IrcMessage &message);
 
 	template <typename T>
 	T &getSocket();
@@ -81,30 +157,65 @@ private:
 	void registerEventHandlers();
 	void registerCommands();
 	void sanitizeInput(std::string &input);
-
-	std::size_t readFromServer(char *data, std::size_t size);
-
-	template <typename SocketType>
-	void writeToSocket(SocketType &socket, const std::string &message);
+	void processInbound();
+	// Dispatches and draws one inbound line; `line` is what `message` views into
+	void deliver(const std::string &line, const IrcMessage &message);
+	void deliverBatch();
+	// Chathistory playback: drawn for the peers, never applied to live state
+	void deliverHistory(const Batch &batch);
+	void handleCommand(const std::string &input);
+	void publishState();
+
+	asio::awaitable<void> connect(const std::string &server, int port);
+	asio::awaitable<void> readServer();
+	asio::awaitable<void> readInput();
+	asio::awaitable<void> writeQueued();
+
+	// Session tasks all run on the strand; run() waits for the last one to finish
+	void spawnTask(asio::awaitable<void> task);
+	void closeSockets();
 
 	asio::io_context &ioContext;
+	strand_type strand;
 	Logger &logger;
 	IOAdapter &ui;
 
-	std::function<void(const std::string &)> socketWriter;
 	std::unique_ptr<asio::ip::tcp::socket> plainSocket;
 	std::unique_ptr<asio::ssl::stream<asio::ip::tcp::socket>> sslSocket;
 	std::optional<asio::ssl::context> sslContext;
+	asio::ssl::context *sharedSslContext = nullptr;
+	std::optional<asio::posix::stream_descriptor> uiInput;
+
+	LineFramer inbound;
+	std::string currentLine; // reused for every inbound line
+	IrcMessage currentMessage;
+	IrcMessage batchMessage; // reused for every line of a delivered batch
+	BatchCollector batches;
+	const Batch *activeBatch = nullptr;
+	Capabilities capabilities;
+	bool capabilitiesEnded = false;
+	OutboundQueue outbound;
+	SessionState state;
+
+	asio::steady_timer writeSignal;
+	asio::steady_timer taskSignal;
+	asio::steady_timer closeDeadline;
+	std::size_t activeTasks = 0;
+	std::exception_ptr failure;
+	bool closing = false;
 
 	bool useTls = false;
 	std::atomic<bool> channelsJoined = false;
 	std::atomic<bool> running = true;
-
-	std::map<std::string, User> users;
-	std::map<std::string, Channel> channels;
-	std::map<std::string, EventHandler> eventHandlers;
+	std::atomic<std::uint64_t> linesReceived = 0;
+
+	Membership membership;
+	std::vector<std::string> touchedChannels; // reused by QUIT/NICK
+	WhoisCache whois;
+	std::string serverName; // source of 001, for WHOIS replies served from the cache
+	bool whox = false;		// ISUPPORT WHOX
+	ChatHistory history;
+	EventDispatcher dispatcher;
 	std::vector<Command> commands;
 	std::vector<std::string> joinedChannels;
-
-	std::thread inputThread;
 };
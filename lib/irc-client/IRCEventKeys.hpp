@@ -9,8 +9,11 @@ struct IRCEventKey
 {
 	static constexpr const char *Ping = "PING";
 	static constexpr const char *RplNameReply = "RPL_NAMEREPLY";
+	static constexpr const char *Membership = "MEMBERSHIP"; // JOIN/PART/KICK/QUIT/NICK/MODE, 366
 	static constexpr const char *MotdEnd = "MOTD_END";
 	static constexpr const char *Privmsg = "PRIVMSG";
 	static constexpr const char *Whois = "WHOIS";
+	static constexpr const char *Who = "WHO"; // 352/354 replies
 	static constexpr const char *Cap = "CAP"; // for CAP * LS / ACK
+	static constexpr const char *Any = "*";	  // wildcard: every inbound message
 };
@@ -0,0 +1,165 @@
+// File: IrcMessage.cpp
+// Requires: C++23
+// Purpose: Implements the single-pass IRC line parser. Each byte of the line is visited once and
+//          the result only holds views into it; tag values are left escaped until asked for.
+
+#include "IrcMessage.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Splits off the next space-delimited word, skipping any run of spaces before it
+	std::string_view nextWord(std::string_view &rest) noexcept
+	{
+		std::size_t start = rest.find_first_not_of(' ');
+		if (start == std::string_view::npos)
+		{
+			rest = {};
+			return {};
+		}
+		rest.remove_prefix(start);
+
+		std::size_t end = rest.find(' ');
+		std::string_view word = rest.substr(0, end);
+		rest.remove_prefix(end == std::string_view::npos ? rest.size() : end);
+		return word;
+	}
+}
+
+std::uint16_t parseIrcNumeric(std::string_view command) noexcept
+{
+	if (command.size() != 3)
+		return 0;
+	std::uint16_t value = 0;
+	for (char c : command)
+	{
+		if (c < '0' || c > '9')
+			return 0;
+		value = value * 10 + (c - '0');
+	}
+	return value;
+}
+
+bool parseIrcMessage(std::string_view line, IrcMessage &message) noexcept
+{
+	message = IrcMessage{};
+	message.raw = line;
+	std::string_view rest = line;
+
+	if (rest.starts_with('@'))
+	{
+		rest.remove_prefix(1);
+		message.tags = nextWord(rest);
+	}
+
+	rest.remove_prefix(std::min(rest.find_first_not_of(' '), rest.size()));
+	if (rest.starts_with(':'))
+	{
+		rest.remove_prefix(1);
+		message.prefix = nextWord(rest);
+
+		std::string_view source = message.prefix;
+		std::size_t at = source.find('@');
+		if (at != std::string_view::npos)
+		{
+			message.host = source.substr(at + 1);
+			source = source.substr(0, at);
+		}
+		std::size_t bang = source.find('!');
+		if (bang != std::string_view::npos)
+		{
+			message.user = source.substr(bang + 1);
+			source = source.substr(0, bang);
+		}
+		message.nick = source;
+	}
+
+	message.command = nextWord(rest);
+	if (message.command.empty())
+		return false;
+	message.numeric = parseIrcNumeric(message.command);
+
+	while (message.paramCount < IrcMessage::maxParams)
+	{
+		rest.remove_prefix(std::min(rest.find_first_not_of(' '), rest.size()));
+		if (rest.empty())
+			break;
+
+		// A ':' parameter (or the 15th one) swallows the rest of the line, spaces included
+		if (rest.front() == ':' || message.paramCount == IrcMessage::maxParams - 1)
+		{
+			if (rest.front() == ':')
+				rest.remove_prefix(1);
+			message.params[message.paramCount++] = rest;
+			break;
+		}
+
+		message.params[message.paramCount++] = nextWord(rest);
+	}
+
+	return true;
+}
+
+std::optional<std::string_view> IrcMessage::tag(std::string_view key) const noexcept
+{
+	std::string_view rest = tags;
+	while (!rest.empty())
+	{
+		std::size_t end = rest.find(';');
+		std::string_view item = rest.substr(0, end);
+		rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+
+		std::size_t eq = item.find('=');
+		if (item.substr(0, eq) == key)
+			return eq == std::string_view::npos ? std::string_view{} : item.substr(eq + 1);
+	}
+	return std::nullopt;
+}
+
+std::string_view channelParam(const IrcMessage &message) noexcept
+{
+	std::size_t last = message.paramCount > 1 ? message.paramCount - 1u : message.paramCount;
+	for (std::size_t i = 0; i < last && i < 3; ++i)
+	{
+		std::string_view param = message.params[i];
+		if (!param.empty() && (param.front() == '#' || param.front() == '&'))
+			return param;
+	}
+	return {};
+}
+
+std::string unescapeTagValue(std::string_view value)
+{
+	std::string out;
+	out.reserve(value.size());
+	for (std::size_t i = 0; i < value.size(); ++i)
+	{
+		if (value[i] != '\\')
+		{
+			out += value[i];
+			continue;
+		}
+		if (++i == value.size())
+			break; // a trailing lone backslash is dropped
+
+		switch (value[i])
+		{
+		case ':':
+			out += ';';
+			break;
+		case 's':
+			out += ' ';
+			break;
+		case 'r':
+			out += '\r';
+			break;
+		case 'n':
+			out += '\n';
+			break;
+		default:
+			out += value[i];
+		}
+	}
+	return out;
+}
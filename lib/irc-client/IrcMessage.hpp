@@ -0,0 +1,66 @@
+// File: IrcMessage.hpp
+// Requires: C++23
+// Purpose: Defines the IrcMessage struct, a parsed view of one IRC protocol line (IRCv3 tags,
+//          prefix split into nick/user/host, command or numeric, and parameters). All fields are
+//          std::string_view into the original line, so parsing never allocates.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct IrcMessage
+{
+	static constexpr std::size_t maxParams = 15; // RFC 1459 limit
+
+	std::string_view raw;
+	std::string_view tags;	 // without the leading '@'
+	std::string_view prefix; // without the leading ':'
+	std::string_view nick;	 // prefix up to '!' / '@' (the server name for server prefixes)
+	std::string_view user;
+	std::string_view host;
+	std::string_view command;
+	std::uint16_t numeric = 0; // 1-999 for three-digit replies, 0 for verbs
+
+	std::array<std::string_view, maxParams> params{};
+	std::uint8_t paramCount = 0;
+
+	[[nodiscard]] std::string_view param(std::size_t index) const noexcept
+	{
+		return index < paramCount ? params[index] : std::string_view{};
+	}
+
+	// Last parameter, which is where the free text of most messages lives
+	[[nodiscard]] std::string_view trailing() const noexcept
+	{
+		return paramCount ? params[paramCount - 1] : std::string_view{};
+	}
+
+	[[nodiscard]] bool is(std::string_view verb) const noexcept { return command == verb; }
+	[[nodiscard]] bool is(std::uint16_t code) const noexcept { return numeric == code; }
+
+	// Raw (still escaped) value of tag `key`; empty view for a tag without a value
+	[[nodiscard]] std::optional<std::string_view> tag(std::string_view key) const noexcept;
+};
+
+/**
+ * Parses `line` (without its line terminator) into `message`. Returns false when the line
+ * has no command. `message` views into `line`, which must outlive it.
+ */
+bool parseIrcMessage(std::string_view line, IrcMessage &message) noexcept;
+
+// 1-999 for a three-digit numeric reply code, 0 for anything else
+std::uint16_t parseIrcNumeric(std::string_view command) noexcept;
+
+/**
+ * The channel a message is about, or an empty view: the first of its first three middle
+ * parameters that names one (PRIVMSG #c, 366 me #c, 353 me = #c). The last parameter only
+ * counts when it is the only one (JOIN #c), since it is usually free text.
+ */
+std::string_view channelParam(const IrcMessage &message) noexcept;
+
+// Decodes IRCv3 tag value escapes (\: \s \\ \r \n). Only call this when the value is needed.
+std::string unescapeTagValue(std::string_view value);
@@ -0,0 +1,56 @@
+// File: Json.hpp
+// Requires: C++23
+// Purpose: Minimal JSON output helpers for the structured `:client` replies. Only writing is
+//          needed; values are appended straight into the caller's buffer.
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Appends `value` as a quoted JSON string, escaping quotes, backslashes and control characters
+inline void appendJsonString(std::string &out, std::string_view value)
+{
+	out += '"';
+	for (char c : value)
+	{
+		switch (c)
+		{
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+				out += escaped;
+			}
+			else
+			{
+				out += c;
+			}
+		}
+	}
+	out += '"';
+}
+
+// Appends `"key":` ready for a value
+inline void appendJsonKey(std::string &out, std::string_view key)
+{
+	appendJsonString(out, key);
+	out += ':';
+}
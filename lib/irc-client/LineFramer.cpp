@@ -0,0 +1,145 @@
+// File: LineFramer.cpp
+// Requires: C++23
+// Purpose: Implements the ring-buffer line framer used by the server read loop. Scanning resumes
+//          where the previous call stopped, so each byte is searched for '\n' exactly once, and
+//          consumed lines are released by moving an index rather than erasing from a string.
+
+#include "LineFramer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+LineFramer::LineFramer(std::size_t initialCapacity, std::size_t maxCapacity)
+	: ring(std::bit_ceil(std::max(initialCapacity, minReadSize * 2))),
+	  mask(ring.size() - 1),
+	  maxCapacity(std::max(std::bit_ceil(maxCapacity), ring.size()))
+{
+}
+
+std::span<char> LineFramer::prepare()
+{
+	if (ring.size() - buffered() < minReadSize)
+		grow();
+
+	std::size_t freeBytes = ring.size() - buffered();
+	std::size_t offset = tail & mask;
+	std::size_t contiguous = std::min(freeBytes, ring.size() - offset);
+
+	lastOffered = std::min(contiguous, readHint);
+	return {ring.data() + offset, lastOffered};
+}
+
+void LineFramer::commit(std::size_t bytes)
+{
+	tail += std::min(bytes, lastOffered);
+
+	// Reads that fill the whole region mean more is waiting: ask for more next time
+	if (bytes == lastOffered && lastOffered == readHint)
+		readHint = std::min(readHint * 2, maxCapacity / 2);
+	else if (bytes < readHint / 4)
+		readHint = std::max(readHint / 2, minReadSize);
+}
+
+bool LineFramer::next(std::string_view &line)
+{
+	while (true)
+	{
+		std::size_t newline = find(scanned, tail);
+		if (newline == tail)
+		{
+			scanned = tail;
+			return false;
+		}
+
+		std::size_t start = head;
+		std::size_t length = newline - head;
+		head = scanned = newline + 1;
+
+		if (discarding)
+		{
+			// Tail end of a line that overflowed the ring: drop it and keep going
+			dropped += length + 1;
+			discarding = false;
+			continue;
+		}
+
+		std::size_t offset = start & mask;
+		if (offset + length <= ring.size())
+		{
+			line = std::string_view(ring.data() + offset, length);
+		}
+		else
+		{
+			std::size_t first = ring.size() - offset;
+			spill.resize(length);
+			std::memcpy(spill.data(), ring.data() + offset, first);
+			std::memcpy(spill.data() + first, ring.data(), length - first);
+			line = spill;
+		}
+
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		return true;
+	}
+}
+
+std::size_t LineFramer::buffered() const noexcept
+{
+	return tail - head;
+}
+
+std::size_t LineFramer::capacity() const noexcept
+{
+	return ring.size();
+}
+
+std::size_t LineFramer::readSize() const noexcept
+{
+	return readHint;
+}
+
+std::uint64_t LineFramer::droppedBytes() const noexcept
+{
+	return dropped;
+}
+
+void LineFramer::grow()
+{
+	if (ring.size() >= maxCapacity)
+	{
+		// One line filled the largest ring allowed; nothing sane can be framed out of it
+		dropped += buffered();
+		head = scanned = tail;
+		discarding = true;
+		return;
+	}
+
+	std::vector<char> larger(ring.size() * 2);
+	std::size_t size = buffered();
+	std::size_t offset = head & mask;
+	std::size_t first = std::min(size, ring.size() - offset);
+	std::memcpy(larger.data(), ring.data() + offset, first);
+	std::memcpy(larger.data() + first, ring.data(), size - first);
+
+	scanned -= head;
+	head = 0;
+	tail = size;
+	ring.swap(larger);
+	mask = ring.size() - 1;
+}
+
+std::size_t LineFramer::find(std::size_t from, std::size_t to) const
+{
+	// At most two contiguous segments: up to the end of the ring, then from its start
+	while (from < to)
+	{
+		std::size_t offset = from & mask;
+		std::size_t span = std::min(to - from, ring.size() - offset);
+		const void *hit = std::memchr(ring.data() + offset, '\n', span);
+		if (hit)
+			return from + (static_cast<const char *>(hit) - (ring.data() + offset));
+		from += span;
+	}
+	return to;
+}
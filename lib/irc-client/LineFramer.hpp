@@ -0,0 +1,65 @@
+// File: LineFramer.hpp
+// Requires: C++23
+// Purpose: Declares the LineFramer class, which splits the inbound server byte stream into IRC
+//          lines. Bytes are read straight into a growable ring buffer and complete lines are
+//          handed out as std::string_view, so framing does no per-line allocation or copying.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class LineFramer
+{
+public:
+	explicit LineFramer(std::size_t initialCapacity = 4096, std::size_t maxCapacity = 1 << 20);
+
+	/**
+	 * Contiguous free region to read into next. Its size adapts to recent reads: it grows
+	 * while reads keep filling it and shrinks back when traffic is light. May grow the
+	 * ring, which invalidates any view returned by next(); drain next() before calling.
+	 */
+	std::span<char> prepare();
+
+	// Marks `bytes` of the region returned by prepare() as filled.
+	void commit(std::size_t bytes);
+
+	/**
+	 * Next complete line without its "\r\n" or "\n" terminator. The view points into the
+	 * ring (or, for the rare line that wraps around its end, into an internal scratch buffer)
+	 * and stays valid until the next call to next() or prepare().
+	 */
+	bool next(std::string_view &line);
+
+	[[nodiscard]] std::size_t buffered() const noexcept;
+	[[nodiscard]] std::size_t capacity() const noexcept;
+	[[nodiscard]] std::size_t readSize() const noexcept;
+	// Bytes thrown away because a single line did not fit in maxCapacity
+	[[nodiscard]] std::uint64_t droppedBytes() const noexcept;
+
+private:
+	static constexpr std::size_t minReadSize = 512;
+
+	void grow();
+	std::size_t find(std::size_t from, std::size_t to) const;
+
+	std::vector<char> ring; // size is always a power of two
+	std::size_t mask;
+	std::size_t maxCapacity;
+
+	// Monotonic stream positions; ring offsets are `position & mask`
+	std::size_t head = 0;	 // first unconsumed byte
+	std::size_t tail = 0;	 // one past the last committed byte
+	std::size_t scanned = 0; // bytes before this position hold no '\n'
+
+	std::size_t readHint = minReadSize * 2;
+	std::size_t lastOffered = 0;
+	bool discarding = false; // dropping the rest of an over-long line
+	std::uint64_t dropped = 0;
+
+	std::string spill; // reused for lines that wrap around the end of the ring
+};
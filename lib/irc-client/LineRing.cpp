@@ -0,0 +1,83 @@
+// File: LineRing.cpp
+// Requires: C++23
+// Purpose: Implements the fixed-capacity line ring behind scrollback and the resume window.
+
+#include "LineRing.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+LineRing::LineRing(std::size_t lines, std::size_t bytes)
+	: lines(lines ? lines : 1),
+	  bytes(bytes ? bytes : 1),
+	  arena(std::make_unique_for_overwrite<char[]>(this->bytes)),
+	  index(std::make_unique_for_overwrite<Entry[]>(this->lines))
+{
+}
+
+bool LineRing::push(std::string_view line, Clock::time_point time)
+{
+	std::size_t size = line.size() + 1;
+	if (size > bytes)
+		return false;
+
+	while (count == lines || used + size > bytes)
+		popOldest();
+
+	// Copy the line and its terminator in, wrapping at the end of the arena
+	std::size_t offset = (head + used) % bytes;
+	std::size_t before = std::min(line.size(), bytes - offset);
+	std::memcpy(arena.get() + offset, line.data(), before);
+	std::memcpy(arena.get(), line.data() + before, line.size() - before);
+	arena[(offset + line.size()) % bytes] = '\n';
+
+	index[(first + count) % lines] = {offset, size, time};
+	++count;
+	used += size;
+	return true;
+}
+
+void LineRing::popOldest()
+{
+	if (count == 0)
+		return;
+
+	const Entry &oldest = entry(0);
+	head = (head + oldest.size) % bytes;
+	used -= oldest.size;
+	first = (first + 1) % lines;
+	if (--count == 0)
+		head = first = 0;
+}
+
+void LineRing::clear() noexcept
+{
+	head = used = first = count = 0;
+}
+
+void LineRing::expire(Clock::time_point cutoff)
+{
+	while (count != 0 && entry(0).time < cutoff)
+		popOldest();
+}
+
+std::size_t LineRing::newest(std::size_t wanted, std::array<std::string_view, 2> &pieces) const
+{
+	pieces = {};
+	std::size_t taken = wanted == 0 ? count : std::min(wanted, count);
+	if (taken == 0)
+		return 0;
+
+	// Everything from the first wanted line to the write position, in one or two pieces
+	std::size_t start = entry(count - taken).offset;
+	std::size_t total = used - (start + bytes - head) % bytes;
+	std::size_t front = std::min(total, bytes - start);
+	pieces[0] = std::string_view(arena.get() + start, front);
+	pieces[1] = std::string_view(arena.get(), total - front);
+	return taken;
+}
+
+std::size_t LineRing::memoryBytes() const noexcept
+{
+	return bytes + lines * sizeof(Entry);
+}
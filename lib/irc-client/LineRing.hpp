@@ -0,0 +1,64 @@
+// File: LineRing.hpp
+// Requires: C++23
+// Purpose: Declares LineRing, a fixed-capacity ring of text lines over one byte arena and one
+//          line index, both allocated up front and never grown. Lines are copied in back to back,
+//          wrapping at the end of the arena, and the oldest are pushed out to make room, so the
+//          newest lines are always contiguous (at most wrapped once) and can be written to a
+//          socket as two pieces straight from the arena.
+//          Not thread-safe.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+class LineRing
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Holds at most `lines` lines and `bytes` bytes, terminators included
+	LineRing(std::size_t lines, std::size_t bytes);
+
+	/**
+	 * Appends `line` (without its terminator), pushing out the oldest lines until it fits.
+	 * False, with nothing changed, for a line longer than the whole arena.
+	 */
+	bool push(std::string_view line, Clock::time_point time = Clock::now());
+	void popOldest();
+	void clear() noexcept;
+	// Drops lines pushed before `cutoff`
+	void expire(Clock::time_point cutoff);
+
+	/**
+	 * The newest `count` lines (all when `count` is 0 or more than held), oldest first and
+	 * newline-terminated, as up to two pieces of the arena. Returns how many lines they hold.
+	 * The views are valid until the next push().
+	 */
+	std::size_t newest(std::size_t count, std::array<std::string_view, 2> &pieces) const;
+
+	[[nodiscard]] std::size_t size() const noexcept { return count; }
+	[[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+private:
+	struct Entry
+	{
+		std::size_t offset; // into the arena
+		std::size_t size;	// newline included
+		Clock::time_point time;
+	};
+
+	const Entry &entry(std::size_t i) const { return index[(first + i) % lines]; }
+
+	std::size_t lines;
+	std::size_t bytes;
+	std::unique_ptr<char[]> arena;
+	std::unique_ptr<Entry[]> index;
+	std::size_t head = 0;  // arena offset of the oldest line
+	std::size_t used = 0;  // arena bytes in use
+	std::size_t first = 0; // index slot of the oldest line
+	std::size_t count = 0;
+};
@@ -0,0 +1,168 @@
+// File: LogFilter.cpp
+// Requires: C++23
+// Purpose: Implements level/category filtering and the lock-free one-second sampling windows.
+
+#include "LogFilter.hpp"
+
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	constexpr std::array<std::string_view, LogFilter::categoryCount> categoryNames = {
+		"general", "raw-in", "raw-out", "protocol", "auth", "ui"};
+
+	constexpr std::array<std::string_view, 6> levelNames = {
+		"trace", "debug", "info", "warn", "error", "off"};
+
+	std::optional<LogCategory> parseCategory(std::string_view name)
+	{
+		for (std::size_t i = 0; i < categoryNames.size(); ++i)
+			if (categoryNames[i] == name)
+				return static_cast<LogCategory>(i);
+		return std::nullopt;
+	}
+
+	LogLevel parseLevel(std::string_view name)
+	{
+		for (std::size_t i = 0; i < levelNames.size(); ++i)
+			if (levelNames[i] == name)
+				return static_cast<LogLevel>(i);
+		throw std::invalid_argument("Invalid log level: " + std::string(name));
+	}
+
+	LogCategory requireCategory(std::string_view name)
+	{
+		if (auto category = parseCategory(name))
+			return *category;
+		throw std::invalid_argument("Invalid log category: " + std::string(name));
+	}
+
+	// Splits "a=b,c,d=e" into (key, value) pairs; a bare item has an empty key
+	std::vector<std::pair<std::string_view, std::string_view>> splitSpec(std::string_view spec)
+	{
+		std::vector<std::pair<std::string_view, std::string_view>> items;
+		while (!spec.empty())
+		{
+			std::size_t comma = spec.find(',');
+			std::string_view item = spec.substr(0, comma);
+			spec.remove_prefix(comma == std::string_view::npos ? spec.size() : comma + 1);
+			if (item.empty())
+				continue;
+
+			std::size_t eq = item.find('=');
+			if (eq == std::string_view::npos)
+				items.emplace_back(std::string_view{}, item);
+			else
+				items.emplace_back(item.substr(0, eq), item.substr(eq + 1));
+		}
+		return items;
+	}
+}
+
+void LogFilter::applyLevels(std::string_view spec)
+{
+	// Parse everything before touching any category so a bad spec changes nothing
+	std::vector<std::pair<std::optional<LogCategory>, LogLevel>> changes;
+	for (auto [key, value] : splitSpec(spec))
+	{
+		std::optional<LogCategory> category;
+		if (!key.empty())
+			category = requireCategory(key);
+		changes.emplace_back(category, parseLevel(value));
+	}
+
+	for (auto [category, level] : changes)
+	{
+		if (category)
+		{
+			categories[index(*category)].level.store(level, std::memory_order_relaxed);
+			continue;
+		}
+		for (auto &state : categories)
+			state.level.store(level, std::memory_order_relaxed);
+	}
+}
+
+void LogFilter::applySampling(std::string_view spec)
+{
+	std::vector<std::pair<LogCategory, std::uint32_t>> changes;
+	for (auto [key, value] : splitSpec(spec))
+	{
+		if (key.empty())
+			throw std::invalid_argument("Log sampling needs <category>=<lines per second>: " + std::string(value));
+		try
+		{
+			changes.emplace_back(requireCategory(key), static_cast<std::uint32_t>(std::stoul(std::string(value))));
+		}
+		catch (const std::logic_error &)
+		{
+			throw std::invalid_argument("Invalid log sampling rate: " + std::string(value));
+		}
+	}
+
+	for (auto [category, rate] : changes)
+		categories[index(category)].ratePerSecond.store(rate, std::memory_order_relaxed);
+}
+
+bool LogFilter::admit(LogCategory category, LogLevel level) noexcept
+{
+	CategoryState &state = categories[index(category)];
+	if (level < state.level.load(std::memory_order_relaxed))
+		return false;
+
+	std::uint32_t rate = state.ratePerSecond.load(std::memory_order_relaxed);
+	if (rate == 0 || level >= LogLevel::Warn)
+		return true;
+
+	// Fixed one-second windows; the thread that sees a new second resets the count. Races at
+	// the boundary can let a few extra lines through, which is fine for sampling.
+	std::int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+						   std::chrono::steady_clock::now().time_since_epoch())
+						   .count();
+	std::int64_t window = state.window.load(std::memory_order_relaxed);
+	if (window != now && state.window.compare_exchange_strong(window, now, std::memory_order_relaxed))
+		state.admitted.store(0, std::memory_order_relaxed);
+
+	if (state.admitted.fetch_add(1, std::memory_order_relaxed) < rate)
+		return true;
+
+	state.suppressed.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+std::uint64_t LogFilter::takeSuppressed(LogCategory category) noexcept
+{
+	return categories[index(category)].suppressed.exchange(0, std::memory_order_relaxed);
+}
+
+std::string LogFilter::describe() const
+{
+	std::string out;
+	for (std::size_t i = 0; i < categoryCount; ++i)
+	{
+		if (!out.empty())
+			out += ' ';
+		out += categoryNames[i];
+		out += '=';
+		out += name(categories[i].level.load(std::memory_order_relaxed));
+
+		std::uint32_t rate = categories[i].ratePerSecond.load(std::memory_order_relaxed);
+		if (rate != 0)
+			out += '/' + std::to_string(rate);
+	}
+	return out;
+}
+
+std::string_view LogFilter::name(LogCategory category) noexcept
+{
+	return categoryNames[index(category)];
+}
+
+std::string_view LogFilter::name(LogLevel level) noexcept
+{
+	return levelNames[static_cast<std::size_t>(level)];
+}
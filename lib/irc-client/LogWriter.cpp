@@ -0,0 +1,102 @@
+// File: LogWriter.cpp
+// Requires: C++23
+// Purpose: Implements the shared log writer thread. It sleeps until the earliest flush interval
+//          of the loggers it serves (or a wake()), then lets each due logger commit its batch.
+
+#include "LogWriter.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Upper bound on a sleep, so a writer with no due logger still checks in now and then
+	constexpr std::chrono::seconds idleInterval{1};
+}
+
+std::shared_ptr<LogWriter> LogWriter::shared()
+{
+	static std::mutex mutex;
+	static std::weak_ptr<LogWriter> current;
+
+	std::lock_guard lock(mutex);
+	std::shared_ptr<LogWriter> writer = current.lock();
+	if (!writer)
+	{
+		writer = std::make_shared<LogWriter>();
+		current = writer;
+	}
+	return writer;
+}
+
+LogWriter::LogWriter()
+	: thread([this]
+			 { run(); })
+{
+}
+
+LogWriter::~LogWriter()
+{
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	woken.notify_one();
+	thread.join();
+}
+
+void LogWriter::attach(Logger &logger)
+{
+	{
+		std::lock_guard service(serviceMutex);
+		loggers.push_back(&logger);
+	}
+	// Its interval may be shorter than the writer's current sleep
+	wake();
+}
+
+void LogWriter::detach(Logger &logger)
+{
+	std::lock_guard service(serviceMutex);
+	std::erase(loggers, &logger);
+}
+
+void LogWriter::wake()
+{
+	{
+		std::lock_guard lock(mutex);
+		wakeRequested = true;
+	}
+	woken.notify_one();
+}
+
+std::size_t LogWriter::loggerCount()
+{
+	std::lock_guard service(serviceMutex);
+	return loggers.size();
+}
+
+void LogWriter::run()
+{
+	Clock::time_point next = Clock::now();
+	std::unique_lock lock(mutex);
+	while (true)
+	{
+		woken.wait_until(lock, next, [&]
+						 { return stopping || wakeRequested; });
+		if (stopping)
+			return;
+		wakeRequested = false;
+		lock.unlock();
+
+		{
+			std::lock_guard service(serviceMutex);
+			Clock::time_point now = Clock::now();
+			next = now + idleInterval;
+			for (Logger *logger : loggers)
+				next = std::min(next, logger->service(now));
+		}
+
+		lock.lock();
+	}
+}
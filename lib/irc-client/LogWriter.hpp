@@ -0,0 +1,57 @@
+// File: LogWriter.hpp
+// Requires: C++23
+// Purpose: Declares LogWriter, the background thread that commits Logger batches. One writer
+//          serves every Logger in the process, so a daemon running many sessions (each with its
+//          own log file) still has a single logging thread. Each Logger is serviced on its own
+//          flush interval, or as soon as it asks to be woken.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Logger;
+
+class LogWriter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// The process-wide writer; started by the first caller and stopped once nobody holds it
+	static std::shared_ptr<LogWriter> shared();
+
+	LogWriter();
+	~LogWriter();
+
+	LogWriter(const LogWriter &) = delete;
+	LogWriter &operator=(const LogWriter &) = delete;
+
+	void attach(Logger &logger);
+	// Once this returns the writer will not touch `logger` again
+	void detach(Logger &logger);
+
+	// Services every attached logger that is due, without waiting out the current interval
+	void wake();
+
+	[[nodiscard]] std::size_t loggerCount();
+
+private:
+	void run();
+
+	// Held while servicing; attach() and detach() take it, so `loggers` never changes under the
+	// writer and a detached logger is never mid-write
+	std::mutex serviceMutex;
+	std::vector<Logger *> loggers;
+
+	// Held only briefly, so wake() never waits on disk
+	std::mutex mutex;
+	std::condition_variable woken;
+	bool wakeRequested = false;
+	bool stopping = false;
+
+	std::thread thread;
+};
@@ -1,39 +1,232 @@
 // File: Logger.cpp
 // Requires: C++23
 // Purpose: Provides logging functionality for both console and file output with trailing
-//          newline trimming. Used across the IRC client for consistent message logging.
+//          newline trimming. log() only appends to the pending batch under a short lock; the
+//          shared writer thread group-commits batches so the network threads never wait on disk.
 
 #include "Logger.hpp"
-#include <iostream>
+#include <cerrno>
+#include <stdexcept>
+#include <unistd.h>
 
-Logger::Logger(const std::string &path)
+Logger::Logger(const std::string &path, LoggerOptions options)
+	: options(options),
+	  file(path, options.segments),
+	  nextWrite(LogWriter::Clock::now() + options.flushInterval),
+	  writer(LogWriter::shared())
+{
+	filter.applyLevels(this->options.levels);
+	filter.applySampling(this->options.sampling);
+
+	writer->attach(*this);
+}
+
+Logger::~Logger()
 {
-	out.open(path, std::ios::out | std::ios::app);
-	if (!out)
 	{
-		std::cerr << "Failed to open log file: " << path << std::endl;
+		std::lock_guard lock(mutex);
+		stopping = true;
 	}
+	notFull.notify_all();
+	writer->detach(*this);
+
+	// Drain whatever is left; the writer will not come back for it
+	reportSuppressed();
+	std::lock_guard io(ioMutex);
+	commitBatch();
 }
 
-void Logger::log(const std::string &message)
+void Logger::log(std::string_view message)
 {
-	std::string trimmed = message;
+	log(LogCategory::General, LogLevel::Info, message);
+}
 
+void Logger::enqueue(std::string_view message)
+{
 	// Remove trailing \r and \n
-	while (!trimmed.empty() && (trimmed.back() == '\r' || trimmed.back() == '\n'))
+	while (!message.empty() && (message.back() == '\r' || message.back() == '\n'))
 	{
-		trimmed.pop_back();
+		message.remove_suffix(1);
 	}
 
-	if (out.is_open())
-		out << trimmed << std::endl;
-	std::cout << trimmed << std::endl;
+	bool wakeWriter = false;
+	{
+		std::unique_lock lock(mutex);
+		auto fits = [&]
+		{ return pending.empty() || pending.size() + message.size() + 1 <= options.queueBytes; };
+
+		if (!fits())
+		{
+			if (options.overflow == LogOverflow::Block)
+			{
+				writer->wake();
+				notFull.wait(lock, [&]
+							 { return stopping || fits(); });
+			}
+			else
+			{
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				if (options.overflow == LogOverflow::Count)
+					++droppedSinceMarker;
+				return;
+			}
+		}
+
+		if (droppedSinceMarker != 0)
+		{
+			pending += "[logger] " + std::to_string(droppedSinceMarker) + " messages dropped\n";
+			droppedSinceMarker = 0;
+		}
+
+		pending.append(message);
+		pending.push_back('\n');
+		++enqueued;
+
+		// Start writing early once half the queue is in use rather than waiting out the interval
+		wakeWriter = pending.size() >= options.queueBytes / 2;
+	}
+
+	if (wakeWriter)
+		writer->wake();
 }
 
 void Logger::flush()
 {
-	if (out.is_open())
+	std::unique_lock lock(mutex);
+	std::uint64_t target = enqueued;
+	if (written >= target || stopping)
+		return;
+
+	flushRequested = true;
+	writer->wake();
+	drained.wait(lock, [&]
+				 { return written >= target; });
+}
+
+void Logger::hardFlush() noexcept
+{
+	std::lock_guard io(ioMutex);
+	commitBatch();
+	file.sync();
+}
+
+std::uint64_t Logger::droppedMessages() const noexcept
+{
+	return dropped.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Logger::batchesWritten() const noexcept
+{
+	return batches.load(std::memory_order_relaxed);
+}
+
+LogOverflow Logger::parseOverflow(std::string_view name)
+{
+	if (name == "block")
+		return LogOverflow::Block;
+	if (name == "drop")
+		return LogOverflow::Drop;
+	if (name == "count")
+		return LogOverflow::Count;
+	throw std::invalid_argument("Invalid log overflow policy: " + std::string(name));
+}
+
+std::string_view Logger::overflowName(LogOverflow policy) noexcept
+{
+	switch (policy)
+	{
+	case LogOverflow::Drop:
+		return "drop";
+	case LogOverflow::Count:
+		return "count";
+	default:
+		return "block";
+	}
+}
+
+LogWriter::Clock::time_point Logger::service(LogWriter::Clock::time_point now)
+{
+	{
+		std::lock_guard lock(mutex);
+		if (!flushRequested && pending.size() < options.queueBytes / 2 && now < nextWrite)
+			return nextWrite;
+
+		nextWrite = now + options.flushInterval;
+		if (pending.empty())
+		{
+			// A hardFlush() already took the batch this flush was waiting on
+			flushRequested = false;
+			return nextWrite;
+		}
+	}
+
+	reportSuppressed();
+
+	std::lock_guard io(ioMutex);
+	commitBatch();
+	return nextWrite;
+}
+
+void Logger::reportSuppressed()
+{
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastSuppressedReport < std::chrono::seconds(1))
+		return;
+	lastSuppressedReport = now;
+
+	for (std::size_t i = 0; i < LogFilter::categoryCount; ++i)
+	{
+		auto category = static_cast<LogCategory>(i);
+		if (std::uint64_t count = filter.takeSuppressed(category))
+		{
+			// Straight into the batch: the writer must never wait on its own queue bound
+			std::lock_guard lock(mutex);
+			pending += std::format("[logger] sampled out {} {} lines\n", count, LogFilter::name(category));
+			++enqueued;
+		}
+	}
+}
+
+void Logger::commitBatch()
+{
+	std::uint64_t target;
+	{
+		std::lock_guard lock(mutex);
+		writing.swap(pending);
+		target = enqueued;
+		flushRequested = false;
+	}
+	notFull.notify_all();
+
+	if (!writing.empty())
+	{
+		// Group commit: one write per sink for the whole batch
+		file.append(writing);
+		if (options.echoStdout)
+			writeAll(STDOUT_FILENO, writing);
+		writing.clear();
+		batches.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard lock(mutex);
+		if (target > written)
+			written = target;
+	}
+	drained.notify_all();
+}
+
+void Logger::writeAll(int fd, std::string_view data) noexcept
+{
+	while (!data.empty())
 	{
-		out.flush();
+		ssize_t n = ::write(fd, data.data(), data.size());
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return; // nowhere left to report a failing log sink
+		}
+		data.remove_prefix(static_cast<std::size_t>(n));
 	}
 }
@@ -1,20 +1,137 @@
 // File: Logger.hpp
 // Requires: C++23
-// Purpose: Declares the Logger class, which provides simple logging functionality for writing
-//          messages to both a file and standard output. Supports message trimming and manual flushing.
+// Purpose: Declares the Logger class, which writes messages to both a file and standard output.
+//          Callers only append to a bounded in-memory batch; the shared LogWriter thread commits
+//          each batch with one write per sink, on a flush interval or when the batch fills up.
+//          The file side is a SegmentedLog, so batches are also the unit of compression.
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <fstream>
+#include <string_view>
+
+#include "LogFilter.hpp"
+#include "LogWriter.hpp"
+#include "SegmentedLog.hpp"
+
+// What log() does when the pending batch is full
+enum class LogOverflow
+{
+	Block, // wait for the writer to make room
+	Drop,  // discard the message; only droppedMessages() shows it
+	Count  // discard the message and record "N messages dropped" in the log once there is room
+};
+
+struct LoggerOptions
+{
+	std::chrono::milliseconds flushInterval{50};
+	std::size_t queueBytes = 1 << 20; // bound on messages waiting for the writer
+	LogOverflow overflow = LogOverflow::Block;
+	bool echoStdout = true;
+	LogSegmentOptions segments; // rotation, compression and retention of the log file
+	std::string levels;			// LogFilter::applyLevels spec, e.g. "info,raw-in=warn"
+	std::string sampling;		// LogFilter::applySampling spec, e.g. "raw-in=20"
+};
 
 class Logger
 {
 public:
-	explicit Logger(const std::string &path);
-	void log(const std::string &message);
+	explicit Logger(const std::string &path, LoggerOptions options = {});
+	~Logger();
+
+	Logger(const Logger &) = delete;
+	Logger &operator=(const Logger &) = delete;
+
+	// Queues `message` (trailing \r and \n trimmed) for the writer, as general/info
+	void log(std::string_view message);
+
+	void log(LogCategory category, LogLevel level, std::string_view message)
+	{
+		if (filter.admit(category, level))
+			enqueue(message);
+	}
+
+	// Formats only when the category and level are admitted, so filtered calls cost no formatting
+	template <typename... Args>
+		requires(sizeof...(Args) > 0)
+	void log(LogCategory category, LogLevel level, std::format_string<Args...> format, Args &&...args)
+	{
+		if (!filter.admit(category, level))
+			return;
+
+		thread_local std::string buffer;
+		buffer.clear();
+		std::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+		enqueue(buffer);
+	}
+
+	[[nodiscard]] bool enabled(LogCategory category, LogLevel level) const noexcept
+	{
+		return filter.enabled(category, level);
+	}
+
+	// Levels and sampling, adjustable at runtime
+	LogFilter &getFilter() noexcept { return filter; }
+
+	// Blocks until everything logged before the call has been written
 	void flush();
 
+	/**
+	 * Writes whatever is pending from the calling thread and fsyncs the file. For fatal paths
+	 * that may not give the writer thread another chance to run.
+	 */
+	void hardFlush() noexcept;
+
+	[[nodiscard]] std::uint64_t droppedMessages() const noexcept;
+	[[nodiscard]] std::uint64_t batchesWritten() const noexcept;
+
+	// "block", "drop" or "count"; throws std::invalid_argument otherwise
+	static LogOverflow parseOverflow(std::string_view name);
+	static std::string_view overflowName(LogOverflow policy) noexcept;
+
 private:
-	std::ofstream out;
+	friend class LogWriter;
+
+	void enqueue(std::string_view message);
+	// Writer thread: commits the pending batch if it is due; returns when it is next due
+	LogWriter::Clock::time_point service(LogWriter::Clock::time_point now);
+	// Logs how many lines sampling dropped per category since the last report
+	void reportSuppressed();
+	// Swaps out the pending batch and writes it; caller must hold ioMutex
+	void commitBatch();
+	static void writeAll(int fd, std::string_view data) noexcept;
+
+	LoggerOptions options;
+	SegmentedLog file;
+	LogFilter filter;
+	std::chrono::steady_clock::time_point lastSuppressedReport;
+
+	// Lock order: ioMutex, then mutex
+	std::mutex ioMutex;
+	std::mutex mutex;
+	std::condition_variable notFull; // producers blocked by LogOverflow::Block
+	std::condition_variable drained; // flush() waiters
+
+	std::string pending; // newline-terminated messages, filled by log()
+	std::string writing; // batch being written, owned by whoever holds ioMutex
+	std::uint64_t enqueued = 0;
+	std::uint64_t written = 0;
+	std::uint64_t droppedSinceMarker = 0;
+	bool flushRequested = false;
+	bool stopping = false;
+	LogWriter::Clock::time_point nextWrite; // writer thread only
+
+	std::atomic<std::uint64_t> dropped = 0;
+	std::atomic<std::uint64_t> batches = 0;
+
+	std::shared_ptr<LogWriter> writer; // shared by every Logger in the process
 };
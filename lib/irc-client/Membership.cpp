@@ -0,0 +1,459 @@
+// File: Membership.cpp
+// Requires: C++23
+// Purpose: Implements the channel membership engine. Every JOIN/PART/KICK/MODE touches one hash
+//          entry; QUIT touches one entry per shared channel and NICK only the nick table; NAMES
+//          is applied per page as it arrives and swapped in whole at RPL_ENDOFNAMES.
+
+#include "Membership.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+PrefixModes::PrefixModes()
+	: modes("ov"), prefixes("@+")
+{
+}
+
+bool PrefixModes::parse(std::string_view value)
+{
+	if (value.empty())
+	{
+		modes.clear();
+		prefixes.clear();
+		return true;
+	}
+
+	std::size_t close = value.find(')');
+	if (value.front() != '(' || close == std::string_view::npos)
+		return false;
+
+	std::string_view newModes = value.substr(1, close - 1);
+	std::string_view newPrefixes = value.substr(close + 1);
+	if (newModes.size() != newPrefixes.size() || newModes.size() > maxModes)
+		return false;
+
+	modes = newModes;
+	prefixes = newPrefixes;
+	return true;
+}
+
+MemberModes PrefixModes::fromMode(char mode) const noexcept
+{
+	std::size_t index = modes.find(mode);
+	return index == std::string::npos ? 0 : static_cast<MemberModes>(1u << index);
+}
+
+MemberModes PrefixModes::fromPrefix(char prefix) const noexcept
+{
+	std::size_t index = prefixes.find(prefix);
+	return index == std::string::npos ? 0 : static_cast<MemberModes>(1u << index);
+}
+
+std::string PrefixModes::symbols(MemberModes bits) const
+{
+	std::string out;
+	for (std::size_t i = 0; i < prefixes.size(); ++i)
+	{
+		if (bits & (1u << i))
+			out += prefixes[i];
+	}
+	return out;
+}
+
+std::size_t PrefixModes::rank(MemberModes bits) const noexcept
+{
+	return bits ? static_cast<std::size_t>(std::countr_zero(bits)) : maxModes;
+}
+
+void Membership::setSelf(std::string_view nick)
+{
+	selfNick = nick;
+}
+
+const std::string &Membership::self() const noexcept
+{
+	return selfNick;
+}
+
+void Membership::setPrefixes(std::string_view value)
+{
+	prefixModes.parse(value);
+}
+
+void Membership::setChannelModes(std::string_view value)
+{
+	std::string *groups[] = {&listModes, &alwaysParamModes, &setParamModes};
+	for (std::string *group : groups)
+	{
+		std::size_t comma = value.find(',');
+		*group = value.substr(0, comma);
+		value.remove_prefix(comma == std::string_view::npos ? value.size() : comma + 1);
+	}
+}
+
+void Membership::setCaseMapping(std::string_view value)
+{
+	CaseMapping mapping;
+	if (!NickTable::parseCaseMapping(value, mapping))
+		return;
+	nickTable.setCaseMapping(mapping);
+
+	// Rekeyed in place: extract() keeps every node, so memberOf's pointers stay valid
+	ChannelMap rekeyed;
+	while (!channelMap.empty())
+	{
+		auto node = channelMap.extract(channelMap.begin());
+		node.key() = channelKey(node.mapped().name);
+		rekeyed.insert(std::move(node));
+	}
+	channelMap.swap(rekeyed);
+}
+
+const PrefixModes &Membership::prefixes() const noexcept
+{
+	return prefixModes;
+}
+
+const NickTable &Membership::nicks() const noexcept
+{
+	return nickTable;
+}
+
+NickTable &Membership::nicks() noexcept
+{
+	return nickTable;
+}
+
+void Membership::namesReply(std::string_view channelName, std::string_view names)
+{
+	std::string key = channelKey(channelName);
+	auto it = channelMap.find(key);
+	if (it == channelMap.end())
+	{
+		it = channelMap.emplace(std::move(key), Channel{}).first;
+		it->second.name = channelName;
+	}
+
+	// The first page of a reply starts a fresh list; the current one stays visible meanwhile
+	Channel &channel = it->second;
+	if (!channel.receivingNames)
+	{
+		for (const auto &[id, modes] : channel.pendingNames)
+			nickTable.release(id);
+		channel.pendingNames.clear();
+		channel.receivingNames = true;
+	}
+
+	while (!names.empty())
+	{
+		std::size_t space = names.find(' ');
+		std::string_view entry = names.substr(0, space);
+		names.remove_prefix(space == std::string_view::npos ? names.size() : space + 1);
+
+		MemberModes bits = 0;
+		while (!entry.empty())
+		{
+			MemberModes bit = prefixModes.fromPrefix(entry.front());
+			if (!bit)
+				break;
+			bits |= bit;
+			entry.remove_prefix(1);
+		}
+
+		// userhost-in-names sends nick!user@host
+		std::string_view nick = entry.substr(0, entry.find('!'));
+		if (nick.empty())
+			continue;
+
+		NickId id = nickTable.acquire(nick);
+		if (nick.size() < entry.size())
+		{
+			std::string_view userHost = entry.substr(nick.size() + 1);
+			std::size_t at = userHost.find('@');
+			User &user = nickTable.user(id);
+			user.username = userHost.substr(0, at);
+			user.host = at == std::string_view::npos ? std::string_view() : userHost.substr(at + 1);
+		}
+		addMember(channel.pendingNames, id, bits);
+		nickTable.release(id);
+	}
+}
+
+void Membership::namesEnd(std::string_view channelName)
+{
+	auto it = channelMap.find(channelKey(channelName));
+	if (it == channelMap.end() || !it->second.receivingNames)
+		return;
+
+	Channel &channel = it->second;
+	for (const auto &[id, modes] : channel.members)
+	{
+		if (!channel.pendingNames.contains(id))
+			unlink(id, channel);
+	}
+	for (const auto &[id, modes] : channel.pendingNames)
+	{
+		if (!channel.members.contains(id))
+			link(id, channel);
+	}
+
+	// The new list holds its own references; the old one's go now
+	channel.members.swap(channel.pendingNames);
+	for (const auto &[id, modes] : channel.pendingNames)
+		nickTable.release(id);
+	channel.pendingNames = MemberMap{};
+	channel.receivingNames = false;
+}
+
+void Membership::join(std::string_view channelName, std::string_view nick)
+{
+	std::string key = channelKey(channelName);
+	auto it = channelMap.find(key);
+	if (it == channelMap.end())
+	{
+		// Only our own JOIN starts tracking a channel
+		if (!isSelf(nick))
+			return;
+		it = channelMap.emplace(std::move(key), Channel{}).first;
+		it->second.name = channelName;
+	}
+
+	Channel &channel = it->second;
+	NickId id = nickTable.acquire(nick);
+	// Joined after the server took the NAMES list that is still arriving: keep it across the swap
+	if (channel.receivingNames)
+		addMember(channel.pendingNames, id, 0);
+	if (!channel.members.contains(id))
+	{
+		addMember(channel.members, id, 0);
+		link(id, channel);
+	}
+	nickTable.release(id);
+}
+
+void Membership::part(std::string_view channelName, std::string_view nick)
+{
+	auto it = channelMap.find(channelKey(channelName));
+	if (it == channelMap.end())
+		return;
+
+	if (isSelf(nick))
+	{
+		forget(it);
+		return;
+	}
+
+	NickId id = nickTable.find(nick);
+	if (id == noNick)
+		return;
+
+	Channel &channel = it->second;
+	removeMember(channel.pendingNames, id);
+	if (channel.members.contains(id))
+	{
+		unlink(id, channel);
+		removeMember(channel.members, id);
+	}
+}
+
+void Membership::quit(std::string_view nick, std::vector<std::string> &touched)
+{
+	NickId id = nickTable.find(nick);
+	if (id != noNick)
+		dropMemberships(id, touched);
+}
+
+void Membership::rename(std::string_view from, std::string_view to, std::vector<std::string> &touched)
+{
+	if (isSelf(from))
+		selfNick = to;
+
+	NickId id = nickTable.find(from);
+	if (id == noNick)
+		return;
+
+	// The server only lets a nick change onto a free nick, so an entry still holding `to` is one
+	// whose own QUIT or NICK we never saw (a NAMES list that raced it, a lost line). It is not a
+	// QUIT to report: its memberships are simply out of date, and dropping them lets the table
+	// reclaim the entry before `id` takes the nick over
+	if (NickId stale = nickTable.find(to); stale != noNick && stale != id)
+		dropMemberships(stale, touched);
+
+	// Members are keyed by id, so only the table entry changes
+	nickTable.rename(id, to);
+	if (id < memberOf.size())
+	{
+		for (Channel *channel : memberOf[id])
+			touched.push_back(channel->name);
+	}
+}
+
+void Membership::mode(std::string_view channelName, std::string_view modeString, std::span<const std::string_view> args)
+{
+	auto it = channelMap.find(channelKey(channelName));
+	if (it == channelMap.end())
+		return;
+
+	Channel &channel = it->second;
+	bool adding = true;
+	std::size_t next = 0;
+	for (char mode : modeString)
+	{
+		if (mode == '+' || mode == '-')
+		{
+			adding = mode == '+';
+			continue;
+		}
+
+		if (MemberModes bit = prefixModes.fromMode(mode))
+		{
+			if (next >= args.size())
+				return;
+			NickId id = nickTable.find(args[next++]);
+			if (id == noNick)
+				continue;
+			for (MemberMap *members : {&channel.members, &channel.pendingNames})
+			{
+				auto member = members->find(id);
+				if (member == members->end())
+					continue;
+				if (adding)
+					member->second |= bit;
+				else
+					member->second &= static_cast<MemberModes>(~bit);
+			}
+			continue;
+		}
+
+		if (takesParameter(mode, adding))
+			++next;
+	}
+}
+
+bool Membership::setTopic(std::string_view channelName, std::string_view topic)
+{
+	auto it = channelMap.find(channelKey(channelName));
+	if (it == channelMap.end())
+		return false;
+	it->second.topic = topic;
+	return true;
+}
+
+std::string Membership::channelKey(std::string_view channelName) const
+{
+	return foldNick(channelName, nickTable.caseMapping());
+}
+
+const ChannelMap &Membership::channels() const noexcept
+{
+	return channelMap;
+}
+
+const Channel *Membership::find(std::string_view channelName) const
+{
+	auto it = channelMap.find(channelKey(channelName));
+	return it == channelMap.end() ? nullptr : &it->second;
+}
+
+bool Membership::isMember(std::string_view channelName, std::string_view nick) const
+{
+	const Channel *channel = find(channelName);
+	NickId id = nickTable.find(nick);
+	return channel && id != noNick && channel->members.contains(id);
+}
+
+std::size_t Membership::channelCount(std::string_view nick) const
+{
+	NickId id = nickTable.find(nick);
+	return id < memberOf.size() ? memberOf[id].size() : 0;
+}
+
+std::span<Channel *const> Membership::channelsOf(NickId id) const
+{
+	if (id >= memberOf.size())
+		return {};
+	return memberOf[id];
+}
+
+void Membership::addMember(MemberMap &members, NickId id, MemberModes modes)
+{
+	auto [member, inserted] = members.try_emplace(id, modes);
+	if (inserted)
+		nickTable.retain(id);
+	else
+		member->second |= modes;
+}
+
+bool Membership::removeMember(MemberMap &members, NickId id)
+{
+	auto member = members.find(id);
+	if (member == members.end())
+		return false;
+	members.erase(member);
+	nickTable.release(id);
+	return true;
+}
+
+void Membership::link(NickId id, Channel &channel)
+{
+	if (id >= memberOf.size())
+		memberOf.resize(id + 1);
+	ChannelList &list = memberOf[id];
+	if (std::ranges::find(list, &channel) == list.end())
+		list.push_back(&channel);
+}
+
+void Membership::unlink(NickId id, Channel &channel)
+{
+	if (id >= memberOf.size())
+		return;
+	ChannelList &list = memberOf[id];
+	if (auto pos = std::ranges::find(list, &channel); pos != list.end())
+	{
+		*pos = list.back();
+		list.pop_back();
+	}
+}
+
+void Membership::forget(ChannelMap::iterator it)
+{
+	Channel &channel = it->second;
+	for (const auto &[id, modes] : channel.members)
+		unlink(id, channel);
+	for (MemberMap *members : {&channel.members, &channel.pendingNames})
+	{
+		for (const auto &[id, modes] : *members)
+			nickTable.release(id);
+	}
+	channelMap.erase(it);
+}
+
+void Membership::dropMemberships(NickId id, std::vector<std::string> &touched)
+{
+	if (id >= memberOf.size())
+		return;
+
+	// Taken first: the last removeMember() may reclaim the id
+	ChannelList channels = std::move(memberOf[id]);
+	memberOf[id].clear();
+	for (Channel *channel : channels)
+		touched.push_back(channel->name);
+	for (Channel *channel : channels)
+	{
+		removeMember(channel->pendingNames, id);
+		removeMember(channel->members, id);
+	}
+}
+
+bool Membership::isSelf(std::string_view nick) const noexcept
+{
+	return nickTable.equal(nick, selfNick);
+}
+
+bool Membership::takesParameter(char mode, bool adding) const noexcept
+{
+	if (listModes.find(mode) != std::string::npos || alwaysParamModes.find(mode) != std::string::npos)
+		return true;
+	return adding && setParamModes.find(mode) != std::string::npos;
+}
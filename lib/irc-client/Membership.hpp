@@ -0,0 +1,111 @@
+// File: Membership.hpp
+// Requires: C++23
+// Purpose: Declares Membership, the channel membership engine of a session, and PrefixModes,
+//          the server's channel prefix modes (ISUPPORT PREFIX). Membership accumulates NAMES
+//          pages until RPL_ENDOFNAMES and then applies JOIN/PART/KICK/QUIT/NICK/MODE
+//          incrementally. Members are NickTable ids; a per-nick channel list keeps QUIT and NICK
+//          proportional to the channels the user shares with us, never to the size of those
+//          channels, and a user is reclaimed from the table when they share none.
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Channel.hpp"
+#include "NickTable.hpp"
+
+class PrefixModes
+{
+public:
+	static constexpr std::size_t maxModes = 8; // MemberModes is 8 bits
+
+	PrefixModes(); // RFC 1459 default: (ov)@+
+
+	// Applies an ISUPPORT PREFIX value such as "(qaohv)~&@%+"; false (and no change) if malformed
+	bool parse(std::string_view value);
+
+	[[nodiscard]] MemberModes fromMode(char mode) const noexcept;	   // 0 unless a prefix mode
+	[[nodiscard]] MemberModes fromPrefix(char prefix) const noexcept; // 0 unless a prefix symbol
+	// Every prefix symbol in `modes`, highest rank first ("@+" with multi-prefix semantics)
+	[[nodiscard]] std::string symbols(MemberModes modes) const;
+	// Lower is more privileged; members without prefix modes rank last
+	[[nodiscard]] std::size_t rank(MemberModes modes) const noexcept;
+
+private:
+	std::string modes;	  // e.g. "ov"
+	std::string prefixes; // e.g. "@+"
+};
+
+class Membership
+{
+public:
+	// Our own nick: our JOIN creates a channel, our PART/KICK forgets it
+	void setSelf(std::string_view nick);
+	[[nodiscard]] const std::string &self() const noexcept;
+
+	// ISUPPORT PREFIX and CHANMODES, so MODE knows which letters take a parameter
+	void setPrefixes(std::string_view value);
+	void setChannelModes(std::string_view value);
+	// ISUPPORT CASEMAPPING; unknown values keep the current mapping
+	void setCaseMapping(std::string_view value);
+	[[nodiscard]] const PrefixModes &prefixes() const noexcept;
+
+	[[nodiscard]] const NickTable &nicks() const noexcept;
+	[[nodiscard]] NickTable &nicks() noexcept;
+
+	// RPL_NAMREPLY page: space separated, each optionally prefixed and/or "nick!user@host"
+	void namesReply(std::string_view channel, std::string_view names);
+	// RPL_ENDOFNAMES: the collected pages become the member list
+	void namesEnd(std::string_view channel);
+
+	void join(std::string_view channel, std::string_view nick);
+	// PART and KICK
+	void part(std::string_view channel, std::string_view nick);
+	// QUIT and NICK append every channel they changed to `touched`
+	void quit(std::string_view nick, std::vector<std::string> &touched);
+	void rename(std::string_view from, std::string_view to, std::vector<std::string> &touched);
+	// Channel MODE: `args` are the parameters after the mode string; only prefix modes change state
+	void mode(std::string_view channel, std::string_view modeString, std::span<const std::string_view> args);
+	// RPL_TOPIC, RPL_NOTOPIC (empty) and TOPIC; false if the channel is not tracked
+	bool setTopic(std::string_view channel, std::string_view topic);
+
+	// Channels are keyed by their name folded with the server's CASEMAPPING, as nicks are, so
+	// "#Foo" and "#foo" are one channel; Channel::name keeps the case we first saw
+	[[nodiscard]] std::string channelKey(std::string_view channel) const;
+	[[nodiscard]] const ChannelMap &channels() const noexcept;
+	[[nodiscard]] const Channel *find(std::string_view channel) const;
+	[[nodiscard]] bool isMember(std::string_view channel, std::string_view nick) const;
+	// Channels `nick` shares with us
+	[[nodiscard]] std::size_t channelCount(std::string_view nick) const;
+	// The channels whose member list holds `id`
+	[[nodiscard]] std::span<Channel *const> channelsOf(NickId id) const;
+
+private:
+	using ChannelList = std::vector<Channel *>; // ChannelMap nodes never move
+
+	// Adds `id` to `members` (taking a reference) unless already there; modes are OR-ed in
+	void addMember(MemberMap &members, NickId id, MemberModes modes);
+	// Removes `id` from `members` and drops its reference; false if it was not there
+	bool removeMember(MemberMap &members, NickId id);
+	void link(NickId id, Channel &channel);
+	void unlink(NickId id, Channel &channel);
+	void forget(ChannelMap::iterator channel);
+	// Removes `id` from every channel it is a member of, appending those channels to `touched`
+	void dropMemberships(NickId id, std::vector<std::string> &touched);
+	[[nodiscard]] bool isSelf(std::string_view nick) const noexcept;
+	[[nodiscard]] bool takesParameter(char mode, bool adding) const noexcept;
+
+	NickTable nickTable;
+	std::string selfNick;
+	PrefixModes prefixModes;
+	// CHANMODES groups A,B,C,D: A and B always take a parameter, C only when set, D never
+	std::string listModes = "b";
+	std::string alwaysParamModes = "k";
+	std::string setParamModes = "l";
+
+	ChannelMap channelMap;
+	std::vector<ChannelList> memberOf; // indexed by NickId: the channels `members` holds it in
+};
@@ -4,6 +4,7 @@
 //          Provides interactive I/O handling for IRC messages within a terminal environment.
 
 #include "NcursesUI.hpp"
+#include <unistd.h>
 
 void NcursesUI::init()
 {
@@ -22,6 +23,7 @@ void NcursesUI::init()
 
 	scrollok(outputWin, TRUE);
 	keypad(inputWin, TRUE);
+	nodelay(inputWin, TRUE);
 	box(inputWin, 0, 0);
 	wmove(inputWin, 1, 1);
 
@@ -42,11 +44,44 @@ void NcursesUI::drawOutput(const std::string &line)
 	wrefresh(outputWin);
 }
 
-std::string NcursesUI::getInput()
+int NcursesUI::inputFd() const
 {
-	char buf[512];
-	werase(inputWin);
-	box(inputWin, 0, 0);
-	mvwgetnstr(inputWin, 1, 1, buf, sizeof(buf) - 1);
-	return std::string(buf);
+	return STDIN_FILENO;
+}
+
+std::optional<std::string> NcursesUI::getInput()
+{
+	// Line editing is done here since the input window is non-blocking
+	int ch;
+	while ((ch = wgetch(inputWin)) != ERR)
+	{
+		if (ch == '\n' || ch == KEY_ENTER)
+		{
+			std::string line = std::move(pending);
+			pending.clear();
+			werase(inputWin);
+			box(inputWin, 0, 0);
+			wmove(inputWin, 1, 1);
+			wrefresh(inputWin);
+			return line;
+		}
+
+		if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b')
+		{
+			if (!pending.empty())
+			{
+				pending.pop_back();
+				mvwaddch(inputWin, 1, 1 + static_cast<int>(pending.size()), ' ');
+				wmove(inputWin, 1, 1 + static_cast<int>(pending.size()));
+			}
+		}
+		else if (ch >= 32 && ch < 256 && pending.size() < 511)
+		{
+			pending.push_back(static_cast<char>(ch));
+			waddch(inputWin, ch);
+		}
+	}
+
+	wrefresh(inputWin);
+	return std::nullopt;
 }
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <ncurses.h>
 #include "IOAdapter.hpp"
@@ -15,9 +16,11 @@ public:
 	void init() override;
 	void shutdown() override;
 	void drawOutput(const std::string &line) override;
-	std::string getInput() override;
+	int inputFd() const override;
+	std::optional<std::string> getInput() override;
 
 private:
 	WINDOW *outputWin = nullptr;
 	WINDOW *inputWin = nullptr;
+	std::string pending; // characters typed since the last Enter
 };
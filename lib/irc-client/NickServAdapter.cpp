@@ -4,9 +4,9 @@
 void NickServAdapter::negotiate(IRCClient &client)
 {
 	client.addEventHandler(IRCEventKey::MotdEnd,
-						   [&](IRCClient &c, const std::string &)
+						   [&](IRCClient &c, const IrcMessage &)
 						   {
 							   // debug: NickServ identify point reached
-							   c.getLogger().log("[DEBUG] MOTD end; client ready for NickServ IDENTIFY");
+							   c.getLogger().log(LogCategory::Auth, LogLevel::Debug, "MOTD end; client ready for NickServ IDENTIFY");
 						   });
 }
@@ -0,0 +1,306 @@
+// File: NickTable.cpp
+// Requires: C++23
+// Purpose: Implements the interned nick table: casefolding, the open-addressing index (linear
+//          probing with backward-shift deletion, so there are no tombstones to accumulate over a
+//          long session) and reference-counted reclamation of entries.
+
+#include "NickTable.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	char fold(char c, CaseMapping mapping) noexcept
+	{
+		if (c >= 'A' && c <= 'Z')
+			return static_cast<char>(c + ('a' - 'A'));
+		if (mapping == CaseMapping::Ascii)
+			return c;
+		switch (c)
+		{
+		case '[':
+			return '{';
+		case ']':
+			return '}';
+		case '\\':
+			return '|';
+		case '~':
+			return mapping == CaseMapping::Rfc1459 ? '^' : c;
+		default:
+			return c;
+		}
+	}
+
+	std::size_t heapBytes(const std::string &value) noexcept
+	{
+		// Short strings live inside the object itself
+		return value.capacity() > std::string().capacity() ? value.capacity() + 1 : 0;
+	}
+}
+
+std::string foldNick(std::string_view nick, CaseMapping mapping)
+{
+	std::string folded(nick);
+	for (char &c : folded)
+		c = fold(c, mapping);
+	return folded;
+}
+
+NickTable::NickTable(CaseMapping mapping)
+	: mapping(mapping)
+{
+}
+
+bool NickTable::parseCaseMapping(std::string_view value, CaseMapping &mapping)
+{
+	if (value == "ascii")
+		mapping = CaseMapping::Ascii;
+	else if (value == "rfc1459")
+		mapping = CaseMapping::Rfc1459;
+	else if (value == "strict-rfc1459")
+		mapping = CaseMapping::StrictRfc1459;
+	else
+		return false;
+	return true;
+}
+
+void NickTable::setCaseMapping(CaseMapping newMapping)
+{
+	if (newMapping == mapping)
+		return;
+	mapping = newMapping;
+
+	std::fill(index.begin(), index.end(), Slot{});
+	indexedCount = 0;
+	for (NickId id = 0; id < entries.size(); ++id)
+	{
+		Entry &entry = entries[id];
+		if (!entry.indexed)
+			continue;
+		entry.indexed = false;
+		entry.hash = hashOf(entry.user.nick);
+		if (findSlot(entry.user.nick, entry.hash) == npos)
+			insertIndex(id);
+	}
+}
+
+CaseMapping NickTable::caseMapping() const noexcept
+{
+	return mapping;
+}
+
+bool NickTable::equal(std::string_view a, std::string_view b) const noexcept
+{
+	if (a.size() != b.size())
+		return false;
+	for (std::size_t i = 0; i < a.size(); ++i)
+	{
+		if (fold(a[i], mapping) != fold(b[i], mapping))
+			return false;
+	}
+	return true;
+}
+
+NickId NickTable::find(std::string_view nick) const noexcept
+{
+	std::size_t slot = findSlot(nick, hashOf(nick));
+	return slot == npos ? noNick : index[slot].id;
+}
+
+NickId NickTable::acquire(std::string_view nick)
+{
+	std::uint32_t hash = hashOf(nick);
+	if (std::size_t slot = findSlot(nick, hash); slot != npos)
+	{
+		NickId id = index[slot].id;
+		++entries[id].refs;
+		return id;
+	}
+
+	NickId id;
+	if (!freeIds.empty())
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else
+	{
+		id = static_cast<NickId>(entries.size());
+		entries.emplace_back();
+	}
+
+	Entry &entry = entries[id];
+	entry.user.nick = nick;
+	nickHeapBytes += heapBytes(entry.user.nick);
+	entry.refs = 1;
+	entry.hash = hash;
+	entry.live = true;
+	++liveCount;
+	insertIndex(id);
+	return id;
+}
+
+void NickTable::retain(NickId id) noexcept
+{
+	++entries[id].refs;
+}
+
+bool NickTable::release(NickId id)
+{
+	Entry &entry = entries[id];
+	if (!entry.live || --entry.refs > 0)
+		return false;
+
+	if (entry.indexed)
+		eraseIndex(id);
+	nickHeapBytes -= heapBytes(entry.user.nick);
+	entry.user = User{}; // gives the nick and WHO strings back now, not when the slot is reused
+	entry.live = false;
+	--liveCount;
+	freeIds.push_back(id);
+	return true;
+}
+
+void NickTable::rename(NickId id, std::string_view nick)
+{
+	Entry &entry = entries[id];
+	std::uint32_t hash = hashOf(nick);
+	std::size_t slot = findSlot(nick, hash);
+	if (slot != npos && index[slot].id == id)
+	{
+		// Only the case changed: same key, same slot
+		setNick(entry, nick);
+		return;
+	}
+
+	if (slot != npos)
+		eraseIndex(index[slot].id);
+	if (entry.indexed)
+		eraseIndex(id);
+	setNick(entry, nick);
+	entry.hash = hash;
+	insertIndex(id);
+}
+
+const std::string &NickTable::nick(NickId id) const noexcept
+{
+	return entries[id].user.nick;
+}
+
+User &NickTable::user(NickId id) noexcept
+{
+	return entries[id].user;
+}
+
+const User &NickTable::user(NickId id) const noexcept
+{
+	return entries[id].user;
+}
+
+std::uint32_t NickTable::references(NickId id) const noexcept
+{
+	return entries[id].refs;
+}
+
+std::size_t NickTable::size() const noexcept
+{
+	return liveCount;
+}
+
+std::size_t NickTable::memoryBytes() const noexcept
+{
+	return entries.size() * sizeof(Entry) + index.capacity() * sizeof(Slot) + freeIds.capacity() * sizeof(NickId) +
+		   nickHeapBytes;
+}
+
+void NickTable::setNick(Entry &entry, std::string_view nick)
+{
+	nickHeapBytes -= heapBytes(entry.user.nick);
+	entry.user.nick = nick;
+	nickHeapBytes += heapBytes(entry.user.nick);
+}
+
+std::uint32_t NickTable::hashOf(std::string_view nick) const noexcept
+{
+	// FNV-1a over the casefolded bytes
+	std::uint32_t hash = 2166136261u;
+	for (char c : nick)
+	{
+		hash ^= static_cast<unsigned char>(fold(c, mapping));
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+std::size_t NickTable::findSlot(std::string_view nick, std::uint32_t hash) const noexcept
+{
+	if (index.empty())
+		return npos;
+
+	std::size_t mask = index.size() - 1;
+	for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+	{
+		const Slot &slot = index[i];
+		if (slot.id == noNick)
+			return npos;
+		if (slot.hash == hash && equal(entries[slot.id].user.nick, nick))
+			return i;
+	}
+}
+
+void NickTable::insertIndex(NickId id)
+{
+	if ((indexedCount + 1) * 4 > index.size() * 3)
+		growIndex();
+
+	Entry &entry = entries[id];
+	std::size_t mask = index.size() - 1;
+	std::size_t i = entry.hash & mask;
+	while (index[i].id != noNick)
+		i = (i + 1) & mask;
+	index[i] = Slot{entry.hash, id};
+	entry.indexed = true;
+	++indexedCount;
+}
+
+void NickTable::eraseIndex(NickId id)
+{
+	Entry &entry = entries[id];
+	std::size_t mask = index.size() - 1;
+	std::size_t hole = entry.hash & mask;
+	while (index[hole].id != id)
+		hole = (hole + 1) & mask;
+
+	// Backward shift: pull later members of the probe run into the hole when that keeps them
+	// reachable from their home slot
+	for (std::size_t j = (hole + 1) & mask; index[j].id != noNick; j = (j + 1) & mask)
+	{
+		std::size_t home = index[j].hash & mask;
+		if (((j - home) & mask) >= ((j - hole) & mask))
+		{
+			index[hole] = index[j];
+			hole = j;
+		}
+	}
+	index[hole] = Slot{};
+	entry.indexed = false;
+	--indexedCount;
+}
+
+void NickTable::growIndex()
+{
+	std::vector<Slot> old(std::max<std::size_t>(16, index.size() * 2));
+	old.swap(index);
+	std::size_t mask = index.size() - 1;
+	for (const Slot &slot : old)
+	{
+		if (slot.id == noNick)
+			continue;
+		std::size_t i = slot.hash & mask;
+		while (index[i].id != noNick)
+			i = (i + 1) & mask;
+		index[i] = slot;
+	}
+}
@@ -0,0 +1,109 @@
+// File: NickTable.hpp
+// Requires: C++23
+// Purpose: Declares NickTable, the session's interned user table. Every nick the session knows
+//          maps to one stable NickId under the server's CASEMAPPING, so "Foo" and "foo" are the
+//          same user. Lookups go through an open-addressing index that hashes the casefolded nick
+//          without allocating. Entries are reference counted by whoever holds the id (channel
+//          memberships) and reclaimed as soon as the last holder lets go.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "User.hpp"
+
+using NickId = std::uint32_t;
+inline constexpr NickId noNick = std::numeric_limits<NickId>::max();
+
+// ISUPPORT CASEMAPPING; servers that do not advertise one use rfc1459
+enum class CaseMapping
+{
+	Ascii,		  // A-Z only
+	Rfc1459,	  // also []\~ == {}|^
+	StrictRfc1459 // also []\ == {}|
+};
+
+// `nick` in the canonical case of `mapping`, for use as a key outside the table
+std::string foldNick(std::string_view nick, CaseMapping mapping);
+
+class NickTable
+{
+public:
+	explicit NickTable(CaseMapping mapping = CaseMapping::Rfc1459);
+
+	// "ascii", "rfc1459" or "strict-rfc1459"; false for anything else
+	static bool parseCaseMapping(std::string_view value, CaseMapping &mapping);
+
+	/**
+	 * Switches the casemapping and reindexes every entry. Two entries that become equal under the
+	 * new mapping stay separate; lookups find the one with the lower id until it is released.
+	 */
+	void setCaseMapping(CaseMapping mapping);
+	[[nodiscard]] CaseMapping caseMapping() const noexcept;
+	[[nodiscard]] bool equal(std::string_view a, std::string_view b) const noexcept;
+
+	// noNick if nobody by that nick (in any case) is known
+	[[nodiscard]] NickId find(std::string_view nick) const noexcept;
+
+	// Finds or creates the entry for `nick` and takes one reference to it
+	NickId acquire(std::string_view nick);
+	void retain(NickId id) noexcept;
+	// Drops one reference; returns true if that was the last one and the entry was reclaimed
+	bool release(NickId id);
+
+	/**
+	 * Re-keys `id` under `nick`; the id, its references and its User data are unchanged. If a
+	 * different entry already answers to `nick`, it stops being findable but lives on until it is
+	 * released.
+	 */
+	void rename(NickId id, std::string_view nick);
+
+	// `id` must be live. References stay valid until the entry is reclaimed.
+	[[nodiscard]] const std::string &nick(NickId id) const noexcept;
+	[[nodiscard]] User &user(NickId id) noexcept;
+	[[nodiscard]] const User &user(NickId id) const noexcept;
+	[[nodiscard]] std::uint32_t references(NickId id) const noexcept;
+
+	[[nodiscard]] std::size_t size() const noexcept; // live entries
+	// Bytes held by entries, the index and out-of-line nick storage (WHO strings not counted)
+	[[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+private:
+	struct Entry
+	{
+		User user;
+		std::uint32_t refs = 0;
+		std::uint32_t hash = 0;
+		bool live = false;
+		bool indexed = false;
+	};
+
+	// The hash is kept next to the id so a probe only touches an entry on a likely match
+	struct Slot
+	{
+		std::uint32_t hash = 0;
+		NickId id = noNick;
+	};
+
+	void setNick(Entry &entry, std::string_view nick);
+	[[nodiscard]] std::uint32_t hashOf(std::string_view nick) const noexcept;
+	// Index slot holding `nick`, or npos
+	[[nodiscard]] std::size_t findSlot(std::string_view nick, std::uint32_t hash) const noexcept;
+	void insertIndex(NickId id);
+	void eraseIndex(NickId id);
+	void growIndex();
+
+	CaseMapping mapping;
+	std::deque<Entry> entries; // a deque so references to entries survive growth
+	std::vector<NickId> freeIds;
+	std::vector<Slot> index; // power-of-two size, linear probing, at most 3/4 full
+	std::size_t indexedCount = 0;
+	std::size_t liveCount = 0;
+	std::size_t nickHeapBytes = 0;
+};
@@ -0,0 +1,179 @@
+// File: OutboundQueue.cpp
+// Requires: C++23
+// Purpose: Implements the two-lane outbound queue and its token bucket. Tokens accrue
+//          continuously at one per interval up to the burst size; each paced line costs one.
+
+#include "OutboundQueue.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+
+namespace
+{
+	constexpr std::array<std::string_view, OutboundQueue::classCount> classNames = {
+		"keepalive", "registration", "chat", "other"};
+
+	bool equalsUpper(std::string_view word, std::string_view upper) noexcept
+	{
+		return word.size() == upper.size() &&
+			   std::equal(word.begin(), word.end(), upper.begin(), [](char a, char b)
+						  { return std::toupper(static_cast<unsigned char>(a)) == b; });
+	}
+
+	bool isPriority(OutboundClass type) noexcept
+	{
+		return type == OutboundClass::Keepalive || type == OutboundClass::Registration;
+	}
+
+	std::int64_t toMs(std::chrono::steady_clock::duration d)
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+	}
+}
+
+OutboundQueue::OutboundQueue(OutboundOptions options)
+	: options(options), tokens(static_cast<double>(options.burst))
+{
+}
+
+void OutboundQueue::push(std::string_view text, Clock::time_point now)
+{
+	while (!text.empty())
+	{
+		std::size_t newline = text.find('\n');
+		std::string_view line = text.substr(0, newline);
+		text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+		if (line.empty() || line == "\r")
+			continue;
+
+		Entry entry{std::string(line), now, classify(line)};
+		entry.line.push_back('\n');
+		(isPriority(entry.type) ? priority : regular).push_back(std::move(entry));
+	}
+}
+
+std::size_t OutboundQueue::take(std::string &out, Clock::time_point now, bool unpaced)
+{
+	std::size_t taken = 0;
+	for (const Entry &entry : priority)
+	{
+		out += entry.line;
+		record(entry, now);
+		++taken;
+	}
+	priority.clear();
+
+	refill(now);
+	while (!regular.empty() && (unpaced || !paced() || tokens >= 1.0))
+	{
+		const Entry &entry = regular.front();
+		out += entry.line;
+		record(entry, now);
+		regular.pop_front();
+		++taken;
+		if (paced())
+			tokens = std::max(tokens - 1.0, 0.0);
+	}
+	return taken;
+}
+
+OutboundQueue::Clock::time_point OutboundQueue::nextReady(Clock::time_point now) const
+{
+	if (!priority.empty())
+		return now;
+	if (regular.empty())
+		return Clock::time_point::max();
+	if (!paced())
+		return now;
+
+	// Same arithmetic as refill(), without committing it
+	double interval = std::chrono::duration<double>(options.interval).count();
+	double available = std::min(tokens + std::chrono::duration<double>(now - refilled).count() / interval,
+								static_cast<double>(options.burst));
+	if (available >= 1.0)
+		return now;
+	return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((1.0 - available) * interval));
+}
+
+bool OutboundQueue::empty() const noexcept
+{
+	return priority.empty() && regular.empty();
+}
+
+std::size_t OutboundQueue::size() const noexcept
+{
+	return priority.size() + regular.size();
+}
+
+void OutboundQueue::clear() noexcept
+{
+	priority.clear();
+	regular.clear();
+}
+
+const OutboundLatency &OutboundQueue::latency(OutboundClass type) const noexcept
+{
+	return latencies[static_cast<std::size_t>(type)];
+}
+
+std::string OutboundQueue::describe() const
+{
+	std::string out;
+	for (std::size_t i = 0; i < classCount; ++i)
+	{
+		const OutboundLatency &stats = latencies[i];
+		std::int64_t avg = stats.messages ? toMs(stats.total) / static_cast<std::int64_t>(stats.messages) : 0;
+		out += std::format("{} n={} avg_ms={} max_ms={} ", classNames[i], stats.messages, avg, toMs(stats.max));
+	}
+	out += std::format("queued={}", size());
+	return out;
+}
+
+OutboundClass OutboundQueue::classify(std::string_view line) noexcept
+{
+	std::string_view command = line.substr(0, line.find(' '));
+	if (!command.empty() && command.back() == '\r')
+		command.remove_suffix(1);
+
+	if (equalsUpper(command, "PONG") || equalsUpper(command, "PING"))
+		return OutboundClass::Keepalive;
+	if (equalsUpper(command, "CAP") || equalsUpper(command, "AUTHENTICATE") || equalsUpper(command, "PASS") ||
+		equalsUpper(command, "NICK") || equalsUpper(command, "USER"))
+		return OutboundClass::Registration;
+	if (equalsUpper(command, "PRIVMSG") || equalsUpper(command, "NOTICE"))
+		return OutboundClass::Chat;
+	return OutboundClass::Other;
+}
+
+std::string_view OutboundQueue::name(OutboundClass type) noexcept
+{
+	return classNames[static_cast<std::size_t>(type)];
+}
+
+void OutboundQueue::refill(Clock::time_point now)
+{
+	if (!paced())
+		return;
+
+	if (refilled != Clock::time_point{} && now > refilled)
+	{
+		double earned = std::chrono::duration<double>(now - refilled) / std::chrono::duration<double>(options.interval);
+		tokens = std::min(tokens + earned, static_cast<double>(options.burst));
+	}
+	refilled = now;
+}
+
+void OutboundQueue::record(const Entry &entry, Clock::time_point now)
+{
+	OutboundLatency &stats = latencies[static_cast<std::size_t>(entry.type)];
+	Clock::duration waited = now - entry.queued;
+	++stats.messages;
+	stats.total += waited;
+	stats.max = std::max(stats.max, waited);
+}
+
+bool OutboundQueue::paced() const noexcept
+{
+	return options.burst != 0 && options.interval.count() > 0;
+}
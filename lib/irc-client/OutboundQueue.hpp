@@ -0,0 +1,94 @@
+// File: OutboundQueue.hpp
+// Requires: C++23
+// Purpose: Declares OutboundQueue, the per-session queue of lines waiting to be written to the
+//          server. Keepalive and registration traffic goes out on a priority lane; everything
+//          else is paced by a token bucket modelled on the server's flood rules, so a pasted
+//          wall of text is spread out instead of getting the session killed for excess flood.
+//          Not thread-safe: owned by the session and only touched on its strand.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+enum class OutboundClass : std::uint8_t
+{
+	Keepalive,	  // PING, PONG
+	Registration, // CAP, AUTHENTICATE, PASS, NICK, USER
+	Chat,		  // PRIVMSG, NOTICE
+	Other,
+	Count
+};
+
+struct OutboundOptions
+{
+	// RFC 1459 flood control: a burst of 5 lines, then one every 2 seconds. 0 disables pacing.
+	std::size_t burst = 5;
+	std::chrono::milliseconds interval{2000};
+};
+
+// Time from push() to take() for one message class
+struct OutboundLatency
+{
+	std::uint64_t messages = 0;
+	std::chrono::steady_clock::duration total{};
+	std::chrono::steady_clock::duration max{};
+};
+
+class OutboundQueue
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr std::size_t classCount = static_cast<std::size_t>(OutboundClass::Count);
+
+	explicit OutboundQueue(OutboundOptions options = {});
+
+	// Queues every line of `text`; a missing final "\n" is added
+	void push(std::string_view text, Clock::time_point now);
+
+	/**
+	 * Appends to `out` everything that may be written at `now`: all priority lines, then as many
+	 * paced lines as the bucket allows (all of them when `unpaced`, e.g. while closing).
+	 * Returns the number of lines taken.
+	 */
+	std::size_t take(std::string &out, Clock::time_point now, bool unpaced = false);
+
+	// When take() will next have something: `now` if ready, time_point::max() if empty
+	[[nodiscard]] Clock::time_point nextReady(Clock::time_point now) const;
+
+	[[nodiscard]] bool empty() const noexcept;
+	[[nodiscard]] std::size_t size() const noexcept;
+	void clear() noexcept;
+
+	[[nodiscard]] const OutboundLatency &latency(OutboundClass type) const noexcept;
+	// "keepalive n=12 avg_ms=0 max_ms=1 ... queued=3", for the runtime command and shutdown log
+	[[nodiscard]] std::string describe() const;
+
+	static OutboundClass classify(std::string_view line) noexcept;
+	static std::string_view name(OutboundClass type) noexcept;
+
+private:
+	struct Entry
+	{
+		std::string line;
+		Clock::time_point queued;
+		OutboundClass type;
+	};
+
+	void refill(Clock::time_point now);
+	void record(const Entry &entry, Clock::time_point now);
+	[[nodiscard]] bool paced() const noexcept;
+
+	OutboundOptions options;
+	std::deque<Entry> priority;
+	std::deque<Entry> regular;
+
+	double tokens;
+	Clock::time_point refilled{};
+	std::array<OutboundLatency, classCount> latencies{};
+};
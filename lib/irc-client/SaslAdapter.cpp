@@ -1,22 +1,37 @@
 #include <asio/write.hpp>
 #include <functional>
+#include <string_view>
 #include "SaslAdapter.hpp"
 #include "IRCEventKeys.hpp"
 
+namespace
+{
+	// Matches a capability name in a CAP list, ignoring any "=value" suffix
+	bool hasCapability(std::string_view list, std::string_view name)
+	{
+		while (!list.empty())
+		{
+			std::size_t end = list.find(' ');
+			std::string_view token = list.substr(0, end);
+			list.remove_prefix(end == std::string_view::npos ? list.size() : end + 1);
+			if (token.substr(0, token.find('=')) == name)
+				return true;
+		}
+		return false;
+	}
+}
+
 void SaslAdapter::negotiate(IRCClient &client)
 {
-	// Advertise capabilities
-	client.writeToServer("CAP LS 302\n");
+	// Requested with the session's other capabilities when the server offers it
+	client.getCapabilities().want("sasl");
 
-	// When LS arrives, ask for SASL
+	// Once SASL is acknowledged, authenticate; CAP END waits for the result
 	client.addEventHandler(IRCEventKey::Cap,
-						   [&](IRCClient &c, const std::string &line)
+						   [&](IRCClient &c, const IrcMessage &message)
 						   {
-							   if (line.find(" LS ") != std::string::npos && line.find("sasl") != std::string::npos)
-							   {
-								   c.writeToServer("CAP REQ :sasl\n");
-							   }
-							   else if (line.find(" ACK :sasl") != std::string::npos)
+							   // CAP <target> <subcommand> [*] :<capabilities>
+							   if (message.param(1) == "ACK" && hasCapability(message.trailing(), "sasl"))
 							   {
 								   c.writeToServer("AUTHENTICATE PLAIN\n");
 							   }
@@ -24,21 +39,21 @@ void SaslAdapter::negotiate(IRCClient &client)
 
 	// On numeric 903 (success), finish capability negotiation —
 	client.addEventHandler("903",
-						   [&](IRCClient &c, const std::string &)
+						   [&](IRCClient &c, const IrcMessage &)
 						   {
-							   c.writeToServer("CAP END\n");
+							   c.endCapabilityNegotiation();
 						   });
 
 	// — Step F: On 904–907 (failures), log, notify UI, and end CAP —
 	auto makeHandler = [&](const char *code, const char *msg)
 	{
 		client.addEventHandler(code,
-							   [code, msg](IRCClient &c, const std::string &)
+							   [code, msg](IRCClient &c, const IrcMessage &)
 							   {
 								   std::string out = std::string("! SASL error (") + code + "): " + msg;
-								   c.getLogger().log(out);
+								   c.getLogger().log(LogCategory::Auth, LogLevel::Error, out);
 								   c.getUi().drawOutput(out);
-								   c.writeToServer("CAP END\n");
+								   c.endCapabilityNegotiation();
 							   });
 	};
 	makeHandler("904", "authentication failed");
@@ -0,0 +1,116 @@
+// File: Scrollback.cpp
+// Requires: C++23
+// Purpose: Implements per-buffer scrollback: which buffer a line belongs to, and a bounded set
+//          of LineRings, one per buffer.
+
+#include "Scrollback.hpp"
+#include "NickTable.hpp"
+
+#include <algorithm>
+
+Scrollback::Scrollback(ScrollbackOptions options)
+	: options(options)
+{
+}
+
+bool Scrollback::enabled() const noexcept
+{
+	return options.lines != 0 && options.bytes != 0 && options.buffers != 0;
+}
+
+void Scrollback::add(std::string_view line, Clock::time_point now)
+{
+	if (!enabled())
+		return;
+
+	IrcMessage message;
+	if (!parseIrcMessage(line, message))
+		return;
+
+	// Follow our own nick, which decides whose query a private message belongs to
+	if (message.is(1) && message.paramCount > 0)
+		self = bufferName(message.param(0));
+	else if (message.is("NICK") && message.paramCount > 0 && bufferName(message.nick) == self)
+		self = bufferName(message.param(0));
+
+	if (line.size() + 1 > options.bytes)
+		return;
+
+	Buffer &target = bufferFor(bufferOf(message));
+	expire(target.lines, now);
+	target.lines.push(line, now);
+	target.lastWrite = ++writes;
+}
+
+std::size_t Scrollback::last(std::string_view buffer, std::size_t count, std::array<std::string_view, 2> &pieces,
+							 Clock::time_point now)
+{
+	pieces = {};
+	auto it = buffers.find(bufferName(buffer));
+	if (it == buffers.end())
+		return 0;
+
+	expire(it->second.lines, now);
+	return it->second.lines.newest(count, pieces);
+}
+
+std::size_t Scrollback::bufferCount() const noexcept
+{
+	return buffers.size();
+}
+
+std::size_t Scrollback::memoryBytes() const noexcept
+{
+	std::size_t total = 0;
+	for (const auto &[name, held] : buffers)
+		total += held.lines.memoryBytes();
+	return total;
+}
+
+std::string Scrollback::bufferOf(std::string_view line) const
+{
+	IrcMessage message;
+	if (!parseIrcMessage(line, message))
+		return std::string(serverBuffer);
+	return bufferOf(message);
+}
+
+std::string Scrollback::bufferOf(const IrcMessage &message) const
+{
+	if (std::string_view channel = channelParam(message); !channel.empty())
+		return bufferName(channel);
+
+	// A private message from a user goes to their query; one we sent goes to the recipient's
+	if ((message.is("PRIVMSG") || message.is("NOTICE") || message.is("TAGMSG")) && !message.user.empty() &&
+		message.paramCount > 0)
+	{
+		std::string sender = bufferName(message.nick);
+		return sender == self ? bufferName(message.param(0)) : sender;
+	}
+	return std::string(serverBuffer);
+}
+
+std::string Scrollback::bufferName(std::string_view name)
+{
+	return foldNick(name, CaseMapping::Rfc1459);
+}
+
+Scrollback::Buffer &Scrollback::bufferFor(const std::string &name)
+{
+	if (auto it = buffers.find(name); it != buffers.end())
+		return it->second;
+
+	if (buffers.size() >= options.buffers)
+	{
+		auto oldest = std::min_element(buffers.begin(), buffers.end(), [](const auto &a, const auto &b)
+									   { return a.second.lastWrite < b.second.lastWrite; });
+		buffers.erase(oldest);
+	}
+	return buffers.try_emplace(name, Buffer{LineRing(options.lines, options.bytes)}).first->second;
+}
+
+void Scrollback::expire(LineRing &lines, Clock::time_point now) const
+{
+	if (options.maxAge.count() != 0)
+		lines.expire(now - options.maxAge);
+}
@@ -0,0 +1,78 @@
+// File: Scrollback.hpp
+// Requires: C++23
+// Purpose: Declares Scrollback, the recent output of a session kept per buffer (channel, query
+//          or the server buffer) so a peer that attaches late can ask for it with /replay. Each
+//          buffer is a LineRing bounded by lines, bytes and age; the number of buffers is bounded
+//          too, so a session never holds more than buffers * (bytes + lines * index entry).
+//          Not thread-safe: guarded by the owning UnixSocketUI's mutex.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "IrcMessage.hpp"
+#include "LineRing.hpp"
+
+struct ScrollbackOptions
+{
+	std::size_t lines = 500;		// per buffer; 0 keeps no scrollback
+	std::size_t bytes = 64 * 1024;	// arena per buffer; longer lines are not kept
+	std::chrono::seconds maxAge{0}; // 0 keeps lines until they are pushed out
+	std::size_t buffers = 64;		// the least recently written one makes room for a new one
+};
+
+class Scrollback
+{
+public:
+	using Clock = LineRing::Clock;
+
+	// Name of the buffer for server lines and anything not tied to a channel or query
+	static constexpr std::string_view serverBuffer = "*";
+
+	explicit Scrollback(ScrollbackOptions options = {});
+
+	[[nodiscard]] bool enabled() const noexcept;
+
+	// Files `line` (without its terminator) under its buffer
+	void add(std::string_view line, Clock::time_point now = Clock::now());
+
+	/**
+	 * The newest `count` lines of `buffer` (all it holds when `count` is 0), oldest first and
+	 * newline-terminated, as up to two pieces of its arena. Returns how many lines they hold.
+	 * The views are valid until the next add().
+	 */
+	std::size_t last(std::string_view buffer, std::size_t count, std::array<std::string_view, 2> &pieces,
+					 Clock::time_point now = Clock::now());
+
+	[[nodiscard]] std::size_t bufferCount() const noexcept;
+	// Arena and index memory held right now
+	[[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+	// The casefolded buffer a line belongs to: its channel, the other side of a private message,
+	// or serverBuffer. Our own nick is learned from 001 and NICK lines passing through add().
+	[[nodiscard]] std::string bufferOf(std::string_view line) const;
+	// Casefolds a buffer name the way bufferOf() does
+	[[nodiscard]] static std::string bufferName(std::string_view name);
+
+private:
+	struct Buffer
+	{
+		LineRing lines;
+		std::uint64_t lastWrite = 0;
+	};
+
+	std::string bufferOf(const IrcMessage &message) const;
+	Buffer &bufferFor(const std::string &name);
+	void expire(LineRing &lines, Clock::time_point now) const;
+
+	ScrollbackOptions options;
+	std::unordered_map<std::string, Buffer> buffers;
+	std::uint64_t writes = 0;
+	std::string self; // casefolded
+};
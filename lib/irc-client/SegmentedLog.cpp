@@ -0,0 +1,225 @@
+// File: SegmentedLog.cpp
+// Requires: C++23
+// Purpose: Implements rotation, per-batch zstd compression and the time index for log segments.
+//          Only the Logger writer thread calls into a SegmentedLog, so it needs no locking.
+
+#include "SegmentedLog.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <zstd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr std::int64_t indexIntervalMs = 1000;
+
+	std::int64_t nowUnixMs()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+				   std::chrono::system_clock::now().time_since_epoch())
+			.count();
+	}
+
+	// 20261017T120000.123Z: sorts chronologically as a string
+	std::string utcStamp(std::int64_t unixMs)
+	{
+		std::time_t seconds = static_cast<std::time_t>(unixMs / 1000);
+		std::tm tm{};
+		gmtime_r(&seconds, &tm);
+		char buf[32];
+		std::strftime(buf, sizeof(buf), "%Y%m%dT%H%M%S", &tm);
+		return std::format("{}.{:03}Z", buf, unixMs % 1000);
+	}
+}
+
+SegmentedLog::SegmentedLog(std::string path, LogSegmentOptions options)
+	: path(std::move(path)),
+	  options(options)
+{
+	active = this->path + (options.compression == LogCompression::Zstd ? ".zst" : "");
+	if (options.compression == LogCompression::Zstd)
+		cctx = ZSTD_createCCtx();
+	openActive();
+}
+
+SegmentedLog::~SegmentedLog()
+{
+	closeActive();
+	if (cctx)
+		ZSTD_freeCCtx(cctx);
+}
+
+void SegmentedLog::append(std::string_view batch)
+{
+	if (fd < 0 || batch.empty())
+		return;
+
+	bool tooBig = options.maxBytes != 0 && size >= options.maxBytes;
+	bool tooOld = options.maxAge.count() != 0 &&
+				  std::chrono::steady_clock::now() - openedAt >= options.maxAge;
+	if (size != 0 && (tooBig || tooOld))
+		rotate();
+
+	std::string_view out = batch;
+	if (cctx)
+	{
+		compressed.resize(ZSTD_compressBound(batch.size()));
+		std::size_t n = ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(),
+										  batch.data(), batch.size(), options.compressionLevel);
+		if (ZSTD_isError(n))
+			return; // a batch lost to the compressor beats a corrupt segment
+		out = std::string_view(compressed.data(), n);
+	}
+
+	// Index the batch's starting offset, at most once per interval, so readers can seek to it
+	std::int64_t now = nowUnixMs();
+	if (indexFd >= 0 && (size == 0 || now - lastIndexedMs >= indexIntervalMs))
+	{
+		IndexRecord record{now, size};
+		writeAll(indexFd, std::string_view(reinterpret_cast<const char *>(&record), sizeof(record)));
+		lastIndexedMs = now;
+	}
+
+	writeAll(fd, out);
+	size += out.size();
+}
+
+void SegmentedLog::sync() noexcept
+{
+	if (fd >= 0)
+		::fsync(fd);
+	if (indexFd >= 0)
+		::fsync(indexFd);
+}
+
+std::uint64_t SegmentedLog::locate(const std::string &indexPath, std::int64_t unixMs)
+{
+	int idx = ::open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (idx < 0)
+		return 0;
+
+	struct stat st{};
+	::fstat(idx, &st);
+	std::size_t count = static_cast<std::size_t>(st.st_size) / sizeof(IndexRecord);
+
+	auto recordAt = [&](std::size_t i)
+	{
+		IndexRecord record{};
+		::pread(idx, &record, sizeof(record), static_cast<off_t>(i * sizeof(record)));
+		return record;
+	};
+
+	// Last record committed at or before `unixMs`: batches after it may hold later lines
+	std::size_t lo = 0, hi = count;
+	while (lo < hi)
+	{
+		std::size_t mid = lo + (hi - lo) / 2;
+		if (recordAt(mid).unixMs <= unixMs)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	std::uint64_t offset = lo == 0 ? 0 : recordAt(lo - 1).offset;
+	::close(idx);
+	return offset;
+}
+
+void SegmentedLog::openActive()
+{
+	fd = ::open(active.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (fd < 0)
+	{
+		std::cerr << "Failed to open log file: " << active << std::endl;
+		return;
+	}
+	indexFd = ::open((active + ".idx").c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+	struct stat st{};
+	::fstat(fd, &st);
+	size = static_cast<std::uint64_t>(st.st_size);
+	openedAt = std::chrono::steady_clock::now();
+	lastIndexedMs = 0;
+}
+
+void SegmentedLog::closeActive() noexcept
+{
+	if (fd >= 0)
+		::close(fd);
+	if (indexFd >= 0)
+		::close(indexFd);
+	fd = indexFd = -1;
+}
+
+void SegmentedLog::rotate()
+{
+	closeActive();
+
+	// <path>.<stamp>[.zst], bumping the stamp's suffix on the rare same-millisecond rotation
+	std::string suffix = options.compression == LogCompression::Zstd ? ".zst" : "";
+	std::string base = path + "." + utcStamp(nowUnixMs());
+	std::string rotated = base + suffix;
+	for (int n = 1; fs::exists(rotated); ++n)
+		rotated = base + "-" + std::to_string(n) + suffix;
+
+	std::error_code ec;
+	fs::rename(active, rotated, ec);
+	fs::rename(active + ".idx", rotated + ".idx", ec);
+
+	prune();
+	openActive();
+}
+
+void SegmentedLog::prune()
+{
+	if (options.keep == 0)
+		return;
+
+	fs::path base(path);
+	std::string prefix = base.filename().string() + ".";
+	std::vector<fs::path> segments;
+	std::error_code ec;
+	for (const auto &entry : fs::directory_iterator(base.parent_path(), ec))
+	{
+		std::string name = entry.path().filename().string();
+		fs::path activeName = fs::path(active).filename();
+		if (!name.starts_with(prefix) || name.ends_with(".idx") || entry.path().filename() == activeName)
+			continue;
+		segments.push_back(entry.path());
+	}
+
+	if (segments.size() <= options.keep)
+		return;
+
+	std::sort(segments.begin(), segments.end());
+	for (std::size_t i = 0; i + options.keep < segments.size(); ++i)
+	{
+		fs::remove(segments[i], ec);
+		fs::remove(segments[i].string() + ".idx", ec);
+	}
+}
+
+void SegmentedLog::writeAll(int fd, std::string_view data) noexcept
+{
+	while (!data.empty())
+	{
+		ssize_t n = ::write(fd, data.data(), data.size());
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return; // nowhere left to report a failing log sink
+		}
+		data.remove_prefix(static_cast<std::size_t>(n));
+	}
+}
@@ -0,0 +1,88 @@
+// File: SegmentedLog.hpp
+// Requires: C++23
+// Purpose: Declares SegmentedLog, the file sink behind Logger. Writes go to an active segment
+//          that is rotated by size or age, optionally zstd-compressed one frame per batch, with
+//          a sidecar index mapping commit time to segment offset so a time range can be read
+//          back without scanning the whole log.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct ZSTD_CCtx_s;
+
+enum class LogCompression
+{
+	None,
+	Zstd // each batch is an independent zstd frame, so the segment stays a valid .zst stream
+};
+
+struct LogSegmentOptions
+{
+	std::uint64_t maxBytes = 0;		  // rotate once the active segment reaches this size; 0 = never
+	std::chrono::seconds maxAge{0};	  // rotate once the active segment is this old; 0 = never
+	std::size_t keep = 0;			  // rotated segments to keep; 0 = keep all
+	LogCompression compression = LogCompression::None;
+	int compressionLevel = 3;
+};
+
+/**
+ * Segment layout for a log at `path`:
+ *   <path>[.zst]                       active segment
+ *   <path>.<UTC stamp>[.zst]           rotated segments, oldest first when sorted by name
+ *   <segment>.idx                      index: fixed 16-byte {unix ms, offset} records, one per
+ *                                      second of writes at most, sorted by time
+ */
+class SegmentedLog
+{
+public:
+	SegmentedLog(std::string path, LogSegmentOptions options);
+	~SegmentedLog();
+
+	SegmentedLog(const SegmentedLog &) = delete;
+	SegmentedLog &operator=(const SegmentedLog &) = delete;
+
+	[[nodiscard]] bool isOpen() const noexcept { return fd >= 0; }
+	[[nodiscard]] const std::string &activePath() const noexcept { return active; }
+
+	// Appends one batch of newline-terminated lines, rotating first when the segment is due
+	void append(std::string_view batch);
+	void sync() noexcept;
+
+	/**
+	 * Offset in the segment behind `indexPath` from which every batch committed at or after
+	 * `unixMs` can be read. Binary search over the index; 0 when the index is missing or
+	 * starts later.
+	 */
+	static std::uint64_t locate(const std::string &indexPath, std::int64_t unixMs);
+
+private:
+	struct IndexRecord
+	{
+		std::int64_t unixMs;
+		std::uint64_t offset;
+	};
+
+	void openActive();
+	void closeActive() noexcept;
+	void rotate();
+	void prune();
+	static void writeAll(int fd, std::string_view data) noexcept;
+
+	std::string path;
+	std::string active;
+	LogSegmentOptions options;
+
+	int fd = -1;
+	int indexFd = -1;
+	std::uint64_t size = 0;
+	std::chrono::steady_clock::time_point openedAt;
+	std::int64_t lastIndexedMs = 0;
+
+	ZSTD_CCtx_s *cctx = nullptr;
+	std::string compressed;
+};
@@ -0,0 +1,134 @@
+// File: Session.cpp
+// Requires: C++23
+// Purpose: Implements a self-contained IRC session for daemon mode. Mirrors the startup sequence
+//          of the single-session process (UI attach, auth, NICK/USER, connect) but runs on the
+//          shared io_context and reports failures without taking the daemon down.
+
+#include "Session.hpp"
+#include "SaslAdapter.hpp"
+#include "NickServAdapter.hpp"
+#include "UnixSocketUI.hpp"
+#include "EventHandlers/DefaultHandlers.hpp"
+
+Session::Session(asio::io_context &context, const ParsedArgs &args, asio::ssl::context &tlsContext)
+	: args(args),
+	  logger(args.logPath, args.logOptions),
+	  ui(std::make_unique<UnixSocketUI>(args.listenSocket, logger, args.uiOptions)),
+	  auth(args.useSasl ? std::unique_ptr<AuthStrategy>(std::make_unique<SaslAdapter>())
+						: std::unique_ptr<AuthStrategy>(std::make_unique<NickServAdapter>())),
+	  client(context, logger, *ui, args.channels, args.outboundOptions, args.whoisOptions,
+			 args.historyOptions)
+{
+	client.setTlsContext(tlsContext);
+	registerDefaultHandlers(client);
+}
+
+Session::~Session()
+{
+	stop("eIRC ( https://github.com/jesse-greathouse/eIRC )");
+	join();
+}
+
+void Session::start()
+{
+	// The socket UI listens without blocking; output before the web side attaches is kept for it
+	ui->init();
+
+	std::lock_guard lock(stateMutex);
+	if (stopRequested)
+		return finish();
+
+	logger.log("Starting IRC session " + args.instance);
+	try
+	{
+		auth->negotiate(client);
+		client.authenticate(args.nick, args.user, args.realname);
+	}
+	catch (const std::exception &ex)
+	{
+		logger.log("Session " + args.instance + " failed: " + ex.what());
+		return finish();
+	}
+
+	started = true;
+	client.start(args.server, args.port, [this](std::exception_ptr ex)
+				 {
+		if (ex)
+		{
+			try
+			{
+				std::rethrow_exception(ex);
+			}
+			catch (const std::exception &e)
+			{
+				logger.log("Session " + args.instance + " failed: " + e.what());
+				logger.hardFlush();
+			}
+		}
+
+		// A quit() that stop() queued before this point is still ahead of us on the strand;
+		// finishing behind it means join() cannot return while it is pending
+		std::lock_guard lock(stateMutex);
+		completed = true;
+		asio::post(client.getStrand(), [this]
+				   { finish(); }); });
+}
+
+void Session::finish()
+{
+	ui->shutdown();
+	logger.flush();
+	finished = true;
+	finished.notify_all();
+}
+
+void Session::stop(const std::string &quitMessage)
+{
+	std::lock_guard lock(stateMutex);
+	stopRequested = true;
+
+	// A finished client must not be handed work: quit() would post to the strand of an
+	// IRCClient that ~Session is about to destroy
+	if (completed || finished.load())
+		return;
+
+	if (started)
+		client.quit(quitMessage);
+	else
+		ui->shutdown();
+}
+
+void Session::join()
+{
+	finished.wait(false);
+}
+
+bool Session::isFinished() const noexcept
+{
+	return finished.load();
+}
+
+const std::string &Session::getInstance() const noexcept
+{
+	return args.instance;
+}
+
+std::uint64_t Session::getLinesReceived() const noexcept
+{
+	return client.getLinesReceived();
+}
+
+UiOutputStats Session::getUiOutputStats() const noexcept
+{
+	return ui->outputStats();
+}
+
+UiQueueStats Session::getUiQueueStats() const
+{
+	return ui->queueStats();
+}
+
+std::shared_ptr<const SessionSnapshot> Session::getSnapshot() const
+{
+	return client.getSnapshot();
+}
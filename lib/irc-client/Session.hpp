@@ -0,0 +1,61 @@
+// File: Session.hpp
+// Requires: C++23
+// Purpose: Declares the Session class, which bundles everything one IRC session owns (logger,
+//          UI adapter, auth strategy and IRCClient) so that many sessions can be hosted by a
+//          single daemon process and share its io_context thread pool.
+
+#pragma once
+
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "ArgParser.hpp"
+#include "AuthStrategy.hpp"
+#include "UnixSocketUI.hpp"
+#include "IRCClient.hpp"
+#include "Logger.hpp"
+
+class Session
+{
+public:
+	Session(asio::io_context &context, const ParsedArgs &args, asio::ssl::context &tlsContext);
+	~Session();
+
+	Session(const Session &) = delete;
+	Session &operator=(const Session &) = delete;
+
+	// Starts the session; from here on everything runs as coroutines on the client's strand
+	void start();
+	void stop(const std::string &quitMessage);
+	// Blocks until the session has fully finished. The io_context must still be served.
+	void join();
+
+	[[nodiscard]] bool isFinished() const noexcept;
+	[[nodiscard]] const std::string &getInstance() const noexcept;
+	[[nodiscard]] std::uint64_t getLinesReceived() const noexcept;
+	[[nodiscard]] UiOutputStats getUiOutputStats() const noexcept;
+	[[nodiscard]] UiQueueStats getUiQueueStats() const;
+	// Published channel/user state; never waits on the session
+	[[nodiscard]] std::shared_ptr<const SessionSnapshot> getSnapshot() const;
+
+private:
+	void finish();
+
+	ParsedArgs args;
+	Logger logger;
+	std::unique_ptr<UnixSocketUI> ui;
+	std::unique_ptr<AuthStrategy> auth;
+	IRCClient client;
+
+	std::mutex stateMutex;
+	bool started = false;
+	bool stopRequested = false;
+	bool completed = false; // run() is over; nothing may be handed to the client any more
+	std::atomic<bool> finished = false;
+};
@@ -0,0 +1,254 @@
+// File: SessionManager.cpp
+// Requires: C++23
+// Purpose: Implements session lifecycle management for daemon mode, including the shared TLS
+//          context, periodic reaping of finished sessions, and the stats report (RSS per session,
+//          lines processed per CPU-second) used to compare against the process-per-user model.
+
+#include "SessionManager.hpp"
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace
+{
+	long readRssKb()
+	{
+		std::ifstream statm("/proc/self/statm");
+		long pages = 0, residentPages = 0;
+		if (!(statm >> pages >> residentPages))
+			return 0;
+		return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+	}
+
+	long cpuTimeMs()
+	{
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+			   (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+	}
+}
+
+SessionManager::SessionManager(asio::io_context &context, Logger &logger, const ParsedArgs &defaults, std::size_t poolThreads)
+	: ioContext(context),
+	  logger(logger),
+	  defaults(defaults),
+	  poolThreads(poolThreads),
+	  tlsContext(asio::ssl::context::tlsv12_client),
+	  reapTimer(context),
+	  baselineRssKb(readRssKb())
+{
+	tlsContext.set_verify_mode(asio::ssl::verify_none);
+	scheduleReap();
+}
+
+SessionManager::~SessionManager()
+{
+	shutdown();
+}
+
+std::string SessionManager::create(std::vector<std::string> args)
+{
+	// Sessions inherit the daemon's socket and log directories unless told otherwise;
+	// later tokens win, so the defaults go first.
+	if (!defaults.listenDir.empty())
+		args.insert(args.begin(), "--listen=" + defaults.listenDir);
+	if (!defaults.logDir.empty())
+		args.insert(args.begin(), "--log=" + defaults.logDir);
+	args.insert(args.begin(), {
+								  "--log-flush-ms=" + std::to_string(defaults.logOptions.flushInterval.count()),
+								  "--log-queue-kb=" + std::to_string(defaults.logOptions.queueBytes / 1024),
+								  "--log-overflow=" + std::string(Logger::overflowName(defaults.logOptions.overflow)),
+								  "--log-rotate-mb=" + std::to_string(defaults.logOptions.segments.maxBytes / (1024 * 1024)),
+								  "--log-rotate-min=" + std::to_string(defaults.logOptions.segments.maxAge.count() / 60),
+								  "--log-keep=" + std::to_string(defaults.logOptions.segments.keep),
+								  std::string("--log-compress=") + (defaults.logOptions.segments.compression == LogCompression::Zstd ? "zstd" : "none"),
+								  "--ui-queue-kb=" + std::to_string(defaults.uiOptions.queueBytes / 1024),
+								  "--ui-overflow=" + std::string(UnixSocketUI::overflowName(defaults.uiOptions.overflow)),
+								  "--ui-spill-mb=" + std::to_string(defaults.uiOptions.spillBytes / (1024 * 1024)),
+								  "--detach-lines=" + std::to_string(defaults.uiOptions.detachLines),
+								  "--scrollback=" + std::to_string(defaults.uiOptions.scrollback.lines),
+								  "--scrollback-kb=" + std::to_string(defaults.uiOptions.scrollback.bytes / 1024),
+								  "--scrollback-age-min=" + std::to_string(defaults.uiOptions.scrollback.maxAge.count() / 60),
+								  "--scrollback-buffers=" + std::to_string(defaults.uiOptions.scrollback.buffers),
+								  "--resume-lines=" + std::to_string(defaults.uiOptions.resumeLines),
+								  "--resume-kb=" + std::to_string(defaults.uiOptions.resumeBytes / 1024),
+								  "--flood-burst=" + std::to_string(defaults.outboundOptions.burst),
+								  "--flood-interval-ms=" + std::to_string(defaults.outboundOptions.interval.count()),
+								  "--whois-ttl-s=" + std::to_string(defaults.whoisOptions.ttl.count()),
+								  "--whois-cache=" + std::to_string(defaults.whoisOptions.capacity),
+								  "--history=" + std::to_string(defaults.historyOptions.limit),
+							  });
+	if (!defaults.logOptions.levels.empty())
+		args.insert(args.begin(), "--log-level=" + defaults.logOptions.levels);
+	if (!defaults.logOptions.sampling.empty())
+		args.insert(args.begin(), "--log-sample=" + defaults.logOptions.sampling);
+
+	ParsedArgs sessionArgs;
+	try
+	{
+		sessionArgs = ArgParser(args).getArgs();
+	}
+	catch (const std::exception &ex)
+	{
+		return std::string("error ") + ex.what();
+	}
+
+	if (sessionArgs.daemon)
+		return "error sessions cannot be daemons";
+
+	std::lock_guard lock(mutex);
+	auto it = sessions.find(sessionArgs.instance);
+	if (it != sessions.end() && !it->second->isFinished())
+		return "ok " + sessionArgs.instance + " already running";
+
+	if (it != sessions.end())
+	{
+		retiredLines += it->second->getLinesReceived();
+		retiredUiOutput += it->second->getUiOutputStats();
+		retiredUiQueues += it->second->getUiQueueStats();
+		sessions.erase(it);
+	}
+
+	auto session = std::make_unique<Session>(ioContext, sessionArgs, tlsContext);
+	session->start();
+	sessions.emplace(sessionArgs.instance, std::move(session));
+
+	logger.log("Session created: " + sessionArgs.instance);
+	return "ok " + sessionArgs.instance;
+}
+
+std::string SessionManager::destroy(const std::string &instance)
+{
+	std::lock_guard lock(mutex);
+	auto it = sessions.find(instance);
+	if (it == sessions.end())
+		return "error unknown instance " + instance;
+
+	// Joining here could wait on this very pool thread; the reaper collects it once finished
+	it->second->stop("eIRC ( https://github.com/jesse-greathouse/eIRC )");
+
+	logger.log("Session destroyed: " + instance);
+	return "ok " + instance;
+}
+
+std::string SessionManager::list()
+{
+	std::lock_guard lock(mutex);
+	std::string response = "ok";
+	for (const auto &[instance, session] : sessions)
+	{
+		response += ' ';
+		response += instance;
+		if (session->isFinished())
+			response += "(finished)";
+	}
+	return response;
+}
+
+std::string SessionManager::stats()
+{
+	std::size_t count = 0;
+	std::uint64_t lines = 0;
+	UiOutputStats ui;
+	UiQueueStats queues;
+	std::size_t channels = 0;
+	std::size_t users = 0;
+	std::size_t nickBytes = 0;
+	{
+		std::lock_guard lock(mutex);
+		count = sessions.size();
+		lines = retiredLines;
+		ui = retiredUiOutput;
+		queues = retiredUiQueues;
+		for (const auto &[instance, session] : sessions)
+		{
+			lines += session->getLinesReceived();
+			ui += session->getUiOutputStats();
+			queues += session->getUiQueueStats();
+
+			std::shared_ptr<const SessionSnapshot> snapshot = session->getSnapshot();
+			channels += snapshot->channels.size();
+			users += snapshot->nickCount;
+			nickBytes += snapshot->nickBytes;
+		}
+	}
+
+	long rssKb = readRssKb();
+	long perSessionKb = count ? std::max(0L, rssKb - baselineRssKb) / static_cast<long>(count) : 0;
+	long cpuMs = cpuTimeMs();
+	std::uint64_t linesPerCpuSec = cpuMs ? lines * 1000 / cpuMs : 0;
+
+	// Coalescing shows up as syscalls-per-line well below 1 and bytes-per-syscall well above a line
+	double uiSyscallsPerLine = ui.lines ? double(ui.syscalls) / double(ui.lines) : 0.0;
+	std::uint64_t uiBytesPerSyscall = ui.syscalls ? ui.bytes / ui.syscalls : 0;
+
+	return std::format("ok sessions={} pool_threads={} rss_kb={} baseline_kb={} "
+					   "per_session_kb={} lines={} cpu_ms={} lines_per_cpu_sec={} channels={} users={} nick_kb={} "
+					   "ui_lines={} ui_syscalls={} ui_syscalls_per_line={:.3f} ui_bytes_per_syscall={} "
+					   "ui_queued_bytes={} ui_spilled_bytes={} ui_queue_peak_bytes={} ui_dropped_lines={} ui_lagging_disconnects={}",
+					   count, poolThreads, rssKb, baselineRssKb,
+					   perSessionKb, lines, cpuMs, linesPerCpuSec, channels, users, nickBytes / 1024,
+					   ui.lines, ui.syscalls, uiSyscallsPerLine, uiBytesPerSyscall,
+					   queues.queuedBytes, queues.spilledBytes, queues.peakBytes, queues.droppedLines, queues.disconnects);
+}
+
+void SessionManager::shutdown()
+{
+	reapTimer.cancel();
+
+	std::map<std::string, std::unique_ptr<Session>> draining;
+	{
+		std::lock_guard lock(mutex);
+		draining.swap(sessions);
+	}
+
+	for (auto &[instance, session] : draining)
+	{
+		session->stop("eIRC ( https://github.com/jesse-greathouse/eIRC )");
+		session->join();
+	}
+}
+
+void SessionManager::scheduleReap()
+{
+	reapTimer.expires_after(std::chrono::seconds(1));
+	reapTimer.async_wait([this](const asio::error_code &ec)
+						 {
+		if (ec)
+			return;
+		reap();
+		scheduleReap(); });
+}
+
+void SessionManager::reap()
+{
+	std::vector<std::unique_ptr<Session>> finished;
+	{
+		std::lock_guard lock(mutex);
+		for (auto it = sessions.begin(); it != sessions.end();)
+		{
+			if (it->second->isFinished())
+			{
+				retiredLines += it->second->getLinesReceived();
+				retiredUiOutput += it->second->getUiOutputStats();
+				retiredUiQueues += it->second->getUiQueueStats();
+				finished.push_back(std::move(it->second));
+				it = sessions.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	for (auto &session : finished)
+	{
+		logger.log("Session finished: " + session->getInstance());
+		session->join();
+	}
+}
@@ -0,0 +1,59 @@
+// File: SessionManager.hpp
+// Requires: C++23
+// Purpose: Declares the SessionManager class, which owns every Session hosted by a daemon process.
+//          Sessions are created and destroyed by instance id, finished sessions are reaped on a
+//          timer, and process-wide memory and throughput figures are reported for the whole pool.
+
+#pragma once
+
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ArgParser.hpp"
+#include "Logger.hpp"
+#include "Session.hpp"
+
+class SessionManager
+{
+public:
+	SessionManager(asio::io_context &context, Logger &logger, const ParsedArgs &defaults, std::size_t poolThreads);
+	~SessionManager();
+
+	/**
+	 * Each method answers with a single protocol line for the control socket:
+	 * "ok ..." on success, "error ..." otherwise.
+	 */
+	std::string create(std::vector<std::string> args);
+	std::string destroy(const std::string &instance);
+	std::string list();
+	std::string stats();
+
+	// Signs off and joins every session. Must run while the io_context is still being served.
+	void shutdown();
+
+private:
+	void scheduleReap();
+	void reap();
+
+	asio::io_context &ioContext;
+	Logger &logger;
+	ParsedArgs defaults;
+	std::size_t poolThreads;
+
+	asio::ssl::context tlsContext;
+	asio::steady_timer reapTimer;
+
+	std::mutex mutex;
+	std::map<std::string, std::unique_ptr<Session>> sessions;
+	std::uint64_t retiredLines = 0; // lines received by sessions that were already reaped
+	UiOutputStats retiredUiOutput;	// UI output of sessions that were already reaped
+	UiQueueStats retiredUiQueues;
+	long baselineRssKb = 0;			// process RSS before any session existed
+};
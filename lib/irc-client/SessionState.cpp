@@ -0,0 +1,315 @@
+// File: SessionState.cpp
+// Requires: C++23
+// Purpose: Implements snapshot publication. Each publish copies the top-level map (pointers
+//          only) and, for each channel marked dirty, its chunk list (pointers again); only the
+//          marked members get new nodes, and only their chunks are copied. Unread counts are
+//          copied only when one changed.
+
+#include "SessionState.hpp"
+#include "Json.hpp"
+
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+	bool sameMember(const MemberSnapshot &member, const User &user, const std::string &status, std::size_t rank)
+	{
+		return member.status == status && member.rank == rank && member.nick == user.nick &&
+			   member.username == user.username && member.host == user.host && member.account == user.account &&
+			   member.realname == user.realname && member.away == user.away;
+	}
+}
+
+MemberList::Editor::Editor(MemberList &list)
+	: list(list), owned(list.chunks.size(), nullptr)
+{
+}
+
+const MemberList::Node &MemberList::Editor::at(std::size_t position) const
+{
+	return list.node(position);
+}
+
+void MemberList::Editor::set(std::size_t position, Node node)
+{
+	chunk(position / chunkSize)[position % chunkSize] = std::move(node);
+}
+
+void MemberList::Editor::push(Node node)
+{
+	if (list.count % chunkSize == 0)
+	{
+		auto fresh = std::make_shared<std::vector<Node>>();
+		fresh->reserve(chunkSize);
+		owned.push_back(fresh.get());
+		list.chunks.push_back(std::move(fresh));
+	}
+	chunk(list.chunks.size() - 1).push_back(std::move(node));
+	++list.count;
+}
+
+void MemberList::Editor::pop()
+{
+	std::vector<Node> &last = chunk(list.chunks.size() - 1);
+	last.pop_back();
+	if (last.empty())
+	{
+		list.chunks.pop_back();
+		owned.pop_back();
+	}
+	--list.count;
+}
+
+std::vector<MemberList::Node> &MemberList::Editor::chunk(std::size_t index)
+{
+	if (!owned[index])
+	{
+		auto copy = std::make_shared<std::vector<Node>>(*list.chunks[index]);
+		owned[index] = copy.get();
+		list.chunks[index] = std::move(copy);
+	}
+	return *owned[index];
+}
+
+SessionState::SessionState()
+	: last(std::make_shared<const SessionSnapshot>()), current(last)
+{
+}
+
+void SessionState::markChannel(const std::string &name)
+{
+	dirtyChannels[name].all = true;
+}
+
+void SessionState::markTopic(const std::string &name)
+{
+	dirtyChannels.try_emplace(name);
+}
+
+void SessionState::markMember(const std::string &channel, NickId id)
+{
+	dirtyChannels[channel].members.push_back(id);
+}
+
+void SessionState::markUser(NickId id)
+{
+	dirtyUsers.push_back(id);
+}
+
+void SessionState::countUnread(std::string_view channel)
+{
+	auto it = unread.find(channel);
+	if (it == unread.end())
+		it = unread.emplace(std::string(channel), 0).first;
+	++it->second;
+	unreadChanged = true;
+}
+
+void SessionState::markRead(const std::string &channel)
+{
+	if (channel.empty())
+	{
+		unreadChanged |= !unread.empty();
+		unread.clear();
+		return;
+	}
+	unreadChanged |= unread.erase(channel) != 0;
+}
+
+void SessionState::publish(const Membership &membership)
+{
+	const ChannelMap &channels = membership.channels();
+	const NickTable &nicks = membership.nicks();
+	const PrefixModes &prefixes = membership.prefixes();
+
+	if (dirtyChannels.empty() && dirtyUsers.empty() && !unreadChanged)
+		return;
+
+	auto next = std::make_shared<SessionSnapshot>(*last);
+	++next->version;
+	next->caseMapping = nicks.caseMapping();
+
+	// Marks as channel keys; a user's change shows in every channel that still holds them
+	std::map<std::string, ChannelMarks, std::less<>> changes;
+	for (auto &[name, marks] : dirtyChannels)
+	{
+		ChannelMarks &merged = changes[membership.channelKey(name)];
+		merged.all |= marks.all;
+		merged.members.insert(merged.members.end(), marks.members.begin(), marks.members.end());
+	}
+	for (NickId id : dirtyUsers)
+	{
+		for (const Channel *channel : membership.channelsOf(id))
+			changes[membership.channelKey(channel->name)].members.push_back(id);
+	}
+
+	for (const auto &[key, marks] : changes)
+	{
+		auto it = channels.find(key);
+		if (it == channels.end())
+		{
+			next->channels.erase(key);
+			memberIndexes.erase(key);
+			unreadChanged |= unread.erase(key) != 0;
+			continue;
+		}
+
+		const Channel &live = it->second;
+		std::shared_ptr<const ChannelSnapshot> &published = next->channels[key];
+		bool fresh = !published;
+		auto channel = fresh ? std::make_shared<ChannelSnapshot>() : std::make_shared<ChannelSnapshot>(*published);
+		channel->name = live.name;
+		channel->topic = live.topic;
+
+		MemberIndex &index = memberIndexes[key];
+		MemberList::Editor editor(channel->members);
+		if (marks.all || fresh)
+		{
+			// Walking down, whatever removeMember() swaps into a position was already kept
+			for (std::size_t position = index.ids.size(); position-- > 0;)
+			{
+				if (!live.members.contains(index.ids[position]))
+					removeMember(editor, index, position);
+			}
+			for (const auto &[id, modes] : live.members)
+				syncMember(editor, index, live, id, nicks, prefixes);
+		}
+		else
+		{
+			for (NickId id : marks.members)
+				syncMember(editor, index, live, id, nicks, prefixes);
+		}
+		published = std::move(channel);
+	}
+
+	next->nickCount = nicks.size();
+	next->nickBytes = nicks.memoryBytes();
+	if (unreadChanged)
+		next->unread = unread;
+
+	dirtyChannels.clear();
+	dirtyUsers.clear();
+	unreadChanged = false;
+	last = std::move(next);
+	current.store(last);
+}
+
+void SessionState::syncMember(MemberList::Editor &editor, MemberIndex &index, const Channel &channel, NickId id,
+							  const NickTable &nicks, const PrefixModes &prefixes)
+{
+	auto position = index.positions.find(id);
+	auto member = channel.members.find(id);
+	if (member == channel.members.end())
+	{
+		if (position != index.positions.end())
+			removeMember(editor, index, position->second);
+		return;
+	}
+
+	const User &user = nicks.user(id);
+	std::string status = prefixes.symbols(member->second);
+	std::size_t rank = prefixes.rank(member->second);
+	if (position != index.positions.end() && sameMember(*editor.at(position->second), user, status, rank))
+		return;
+
+	auto node = std::make_shared<const MemberSnapshot>(MemberSnapshot{
+		user.nick, std::move(status), rank, user.username, user.host, user.account, user.realname, user.away});
+	if (position != index.positions.end())
+	{
+		editor.set(position->second, std::move(node));
+		return;
+	}
+	index.positions.emplace(id, index.ids.size());
+	index.ids.push_back(id);
+	editor.push(std::move(node));
+}
+
+void SessionState::removeMember(MemberList::Editor &editor, MemberIndex &index, std::size_t position)
+{
+	// The last member moves into the hole, so the list stays dense
+	std::size_t last = index.ids.size() - 1;
+	index.positions.erase(index.ids[position]);
+	if (position != last)
+	{
+		MemberList::Node moved = editor.at(last);
+		editor.set(position, std::move(moved));
+		index.ids[position] = index.ids[last];
+		index.positions[index.ids[position]] = position;
+	}
+	index.ids.pop_back();
+	editor.pop();
+}
+
+std::shared_ptr<const SessionSnapshot> SessionState::snapshot() const
+{
+	return current.load();
+}
+
+std::string SessionState::toJson(const SessionSnapshot &snapshot, std::string_view self, std::uint64_t sequence)
+{
+	std::size_t memberCount = 0;
+	for (const auto &[name, channel] : snapshot.channels)
+		memberCount += channel->members.size();
+
+	// Sized once for the usual nick and host lengths; members of several channels are listed once
+	std::string out;
+	out.reserve(128 + snapshot.channels.size() * 128 + memberCount * 96);
+	std::vector<const MemberSnapshot *> users;
+	std::unordered_set<std::string_view> seen;
+	users.reserve(memberCount);
+	seen.reserve(memberCount);
+
+	out += "{\"version\":";
+	out += std::to_string(snapshot.version);
+	out += ",\"seq\":";
+	out += std::to_string(sequence);
+	out += ',';
+	appendJsonKey(out, "self");
+	appendJsonString(out, self);
+	out += ",\"channels\":[";
+	for (auto it = snapshot.channels.begin(); it != snapshot.channels.end(); ++it)
+	{
+		const ChannelSnapshot &channel = *it->second;
+		auto unread = snapshot.unread.find(it->first);
+		if (it != snapshot.channels.begin())
+			out += ',';
+		out += "{\"name\":";
+		appendJsonString(out, channel.name);
+		out += ",\"topic\":";
+		appendJsonString(out, channel.topic);
+		out += ",\"unread\":";
+		out += std::to_string(unread == snapshot.unread.end() ? 0 : unread->second);
+		out += ",\"members\":{";
+		for (auto member = channel.members.begin(); member != channel.members.end(); ++member)
+		{
+			if (member != channel.members.begin())
+				out += ',';
+			appendJsonKey(out, member->nick);
+			appendJsonString(out, member->status);
+			if (seen.insert(member->nick).second)
+				users.push_back(&*member);
+		}
+		out += "}}";
+	}
+
+	out += "],\"users\":{";
+	for (std::size_t i = 0; i < users.size(); ++i)
+	{
+		const MemberSnapshot &user = *users[i];
+		if (i != 0)
+			out += ',';
+		appendJsonKey(out, user.nick);
+		out += "{\"username\":";
+		appendJsonString(out, user.username);
+		out += ",\"host\":";
+		appendJsonString(out, user.host);
+		out += ",\"account\":";
+		appendJsonString(out, user.account);
+		out += ",\"realname\":";
+		appendJsonString(out, user.realname);
+		out += user.away ? ",\"away\":true}" : ",\"away\":false}";
+	}
+	out += "}}";
+	return out;
+}
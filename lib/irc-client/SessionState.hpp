@@ -0,0 +1,199 @@
+// File: SessionState.hpp
+// Requires: C++23
+// Purpose: Declares SessionState, which publishes immutable snapshots of a session's channels and
+//          their members. The session strand owns the live state and marks what it changes; after
+//          each burst it publishes a new snapshot that shares every unchanged channel, and within a
+//          changed channel every unchanged member, with the previous one. Readers on any thread
+//          load the current snapshot without taking a lock the network path ever waits on, and keep
+//          it alive for as long as they hold it.
+//          toJson() serializes a whole snapshot for `/snapshot`, so a UI boots in one round trip.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Membership.hpp"
+
+struct MemberSnapshot
+{
+	std::string nick;
+	std::string status; // every prefix symbol the member holds, highest first: "", "@", "@+"
+	std::size_t rank = PrefixModes::maxModes; // PrefixModes::rank(), for ordering
+	// From WHO/WHOX; empty until the channel's WHO reply arrives
+	std::string username;
+	std::string host;
+	std::string account;
+	std::string realname;
+	bool away = false;
+};
+
+/**
+ * A channel's members, in no particular order, as fixed-size chunks of shared immutable nodes.
+ * Copying a MemberList copies chunk pointers only; an Editor copies a chunk the first time it
+ * writes to it, so a JOIN or MODE in a huge channel costs one node and one chunk, not the channel.
+ */
+class MemberList
+{
+public:
+	using Node = std::shared_ptr<const MemberSnapshot>;
+	static constexpr std::size_t chunkSize = 64;
+
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = MemberSnapshot;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const MemberSnapshot *;
+		using reference = const MemberSnapshot &;
+
+		const_iterator() = default;
+
+		reference operator*() const { return *list->node(position); }
+		pointer operator->() const { return list->node(position).get(); }
+		const_iterator &operator++()
+		{
+			++position;
+			return *this;
+		}
+		const_iterator operator++(int)
+		{
+			const_iterator previous = *this;
+			++position;
+			return previous;
+		}
+		bool operator==(const const_iterator &) const = default;
+
+	private:
+		friend class MemberList;
+		const_iterator(const MemberList *list, std::size_t position) : list(list), position(position) {}
+
+		const MemberList *list = nullptr;
+		std::size_t position = 0;
+	};
+
+	// Writes through to `list`; every chunk it touches is a private copy from then on
+	class Editor
+	{
+	public:
+		explicit Editor(MemberList &list);
+
+		[[nodiscard]] const Node &at(std::size_t position) const;
+		void set(std::size_t position, Node node);
+		void push(Node node);
+		void pop();
+
+	private:
+		std::vector<Node> &chunk(std::size_t index);
+
+		MemberList &list;
+		std::vector<std::vector<Node> *> owned; // per chunk: our copy, or null while still shared
+	};
+
+	[[nodiscard]] std::size_t size() const noexcept { return count; }
+	[[nodiscard]] bool empty() const noexcept { return count == 0; }
+	[[nodiscard]] const_iterator begin() const { return {this, 0}; }
+	[[nodiscard]] const_iterator end() const { return {this, count}; }
+
+private:
+	[[nodiscard]] const Node &node(std::size_t position) const
+	{
+		return (*chunks[position / chunkSize])[position % chunkSize];
+	}
+
+	std::vector<std::shared_ptr<const std::vector<Node>>> chunks; // all full but the last
+	std::size_t count = 0;
+};
+
+struct ChannelSnapshot
+{
+	std::string name;
+	std::string topic;
+	MemberList members;
+};
+
+struct SessionSnapshot
+{
+	std::uint64_t version = 0;
+	// Both keyed by Membership::channelKey(); `caseMapping` folds a channel name the same way
+	std::map<std::string, std::shared_ptr<const ChannelSnapshot>> channels;
+	// Messages to each channel since it was last marked read; only channels with any are listed
+	std::map<std::string, std::uint64_t, std::less<>> unread;
+	CaseMapping caseMapping = CaseMapping::Rfc1459;
+	std::size_t nickCount = 0; // NickTable::size() and memoryBytes() when published
+	std::size_t nickBytes = 0;
+};
+
+class SessionState
+{
+public:
+	SessionState();
+
+	// Writer side, session strand only: record what changed since the last publish().
+	// markChannel() rechecks the whole channel (its member list was replaced, or we joined or
+	// left it); the narrower marks cost the next publish only what they name.
+	void markChannel(const std::string &name);
+	void markTopic(const std::string &name);
+	// `id` joined, left or changed prefix modes in `channel`
+	void markMember(const std::string &channel, NickId id);
+	// The nick or details of `id` changed, in every channel that holds it
+	void markUser(NickId id);
+	// A message arrived in `channel` (a Membership::channelKey()); markRead() resets its count,
+	// or every count with no name
+	void countUnread(std::string_view channel);
+	void markRead(const std::string &channel = {});
+
+	/**
+	 * Publishes a snapshot of the live state if anything was marked since the last call. Only the
+	 * marked channels are copied, and in them only the marked members are rebuilt; a channel that
+	 * is no longer tracked is dropped.
+	 */
+	void publish(const Membership &membership);
+
+	// Reader side, any thread. Never null; the empty snapshot has version 0.
+	[[nodiscard]] std::shared_ptr<const SessionSnapshot> snapshot() const;
+
+	/**
+	 * One JSON object holding everything in `snapshot`: channels with their topic, unread count
+	 * and members (nick to status), and every member's user details once, keyed by nick.
+	 * `sequence` is the number of the last line the snapshot reflects.
+	 */
+	static std::string toJson(const SessionSnapshot &snapshot, std::string_view self, std::uint64_t sequence);
+
+private:
+	struct ChannelMarks
+	{
+		bool all = false;
+		std::vector<NickId> members;
+	};
+
+	// Where each member of a published channel sits in its MemberList
+	struct MemberIndex
+	{
+		std::unordered_map<NickId, std::size_t> positions;
+		std::vector<NickId> ids; // by position
+	};
+
+	// Brings `id`'s node in line with `channel`: added, replaced if it changed, or removed
+	static void syncMember(MemberList::Editor &editor, MemberIndex &index, const Channel &channel, NickId id,
+						   const NickTable &nicks, const PrefixModes &prefixes);
+	static void removeMember(MemberList::Editor &editor, MemberIndex &index, std::size_t position);
+
+	std::map<std::string, ChannelMarks> dirtyChannels; // as marked; folded into channel keys on publish
+	std::vector<NickId> dirtyUsers;
+	std::map<std::string, MemberIndex, std::less<>> memberIndexes; // keyed like SessionSnapshot::channels
+	std::map<std::string, std::uint64_t, std::less<>> unread;
+	bool unreadChanged = false;
+	std::shared_ptr<const SessionSnapshot> last; // writer's reference to what it published
+	std::atomic<std::shared_ptr<const SessionSnapshot>> current;
+};
@@ -1,17 +1,35 @@
 // File: UnixSocketUI.cpp
 // Requires: C++23
-// Purpose: Implements a UNIX domain socket-based UI adapter for headless I/O. Accepts connections
-//          from an external client, facilitating bidirectional communication between the IRC client
-//          and a socket peer (e.g. a WebSocket server or monitoring tool).
+// Purpose: Implements a UNIX domain socket-based UI adapter for headless I/O. Accepts any number
+//          of peers (e.g. WebSocket server connections or monitoring tools) without blocking,
+//          fans output out to all of them and multiplexes their input into one command stream.
 
 #include "UnixSocketUI.hpp"
 #include "Logger.hpp"
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <format>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 
-UnixSocketUI::UnixSocketUI(const std::string &path, Logger &logger)
-	: socketPath(path), logger(logger) {}
+UnixSocketUI::UnixSocketUI(const std::string &path, Logger &logger, UiOptions options)
+	: socketPath(path), logger(logger), options(options), scrollback(options.scrollback)
+{
+	if (options.resumeLines != 0)
+		resumeWindow.emplace(options.resumeLines, options.resumeBytes);
+}
 
 UnixSocketUI::~UnixSocketUI()
 {
@@ -20,8 +38,10 @@ UnixSocketUI::~UnixSocketUI()
 
 void UnixSocketUI::init()
 {
-	serverFd = socket(AF_UNIX, SOCK_STREAM, 0);
-	if (serverFd < 0)
+	std::lock_guard lock(mutex);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
 	{
 		perror("socket");
 		return;
@@ -32,66 +52,815 @@ void UnixSocketUI::init()
 	std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
 	unlink(socketPath.c_str());
 
-	if (bind(serverFd, (sockaddr *)&addr, sizeof(addr)) == -1)
+	if (bind(fd, (sockaddr *)&addr, sizeof(addr)) == -1)
 	{
 		perror("bind");
+		close(fd);
 		return;
 	}
 
-	if (listen(serverFd, 1) == -1)
+	if (listen(fd, SOMAXCONN) == -1)
 	{
 		perror("listen");
+		close(fd);
 		return;
 	}
 
-	std::string waitMsg = "Waiting for socket client: " + socketPath;
-	logger.log(waitMsg);
+	int ep = epoll_create1(EPOLL_CLOEXEC);
+	if (ep < 0)
+	{
+		perror("epoll_create1");
+		close(fd);
+		return;
+	}
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = fd;
+	epoll_ctl(ep, EPOLL_CTL_ADD, fd, &event);
+
+	serverFd = fd;
+	epollFd = ep;
+	logger.log(LogCategory::Ui, LogLevel::Info, "Listening for socket clients: {}", socketPath);
+}
+
+void UnixSocketUI::shutdown()
+{
+	std::lock_guard lock(mutex);
+	flushLocked();
+
+	if (std::uint64_t syscalls = syscallsOut.load(); syscalls != 0 && serverFd.load() >= 0)
+	{
+		std::uint64_t lines = linesOut.load();
+		logger.log(LogCategory::Ui, LogLevel::Info, "UI output: {} lines, {} bytes in {} syscalls ({:.2f} syscalls/line, {} bytes/syscall)",
+				   lines, bytesOut.load(), syscalls, lines ? double(syscalls) / double(lines) : 0.0, bytesOut.load() / syscalls);
+	}
+	if (droppedLines != 0 || overflowDisconnects != 0)
+		logger.log(LogCategory::Ui, LogLevel::Warn, "UI backpressure: deepest queue {} bytes, {} lines dropped, {} peers disconnected",
+				   peakQueued, droppedLines, overflowDisconnects);
+
+	// shutdown() before close() wakes anything still waiting on the descriptors
+	for (auto &[fd, peer] : peers)
+	{
+		::shutdown(fd, SHUT_RDWR);
+		close(fd);
+	}
+	peers.clear();
+
+	if (int fd = serverFd.exchange(-1); fd >= 0)
+	{
+		::shutdown(fd, SHUT_RDWR);
+		close(fd);
+		unlink(socketPath.c_str());
+	}
+	if (int fd = epollFd.exchange(-1); fd >= 0)
+	{
+		close(fd);
+	}
+}
 
-	clientFd = accept(serverFd, nullptr, nullptr);
-	if (clientFd < 0)
+void UnixSocketUI::drawOutput(const std::string &line)
+{
+	std::lock_guard lock(mutex);
+	scrollback.add(line);
+	sequence(line);
+
+	if (!everAttached)
 	{
-		perror("accept");
+		backlog.push_back(line);
+		if (backlog.size() > options.backlogLines)
+			backlog.pop_front();
+		sequencedBatch.clear();
+		return;
+	}
+
+	batch.append(line);
+	batch.push_back('\n');
+	++batchLines;
+	if (eventPeers != 0)
+		appendEventFrame(eventBatch, line, lastSeq);
+
+	// Bound the batch for callers that draw a lot before flushing
+	if (batch.size() >= maxBatchBytes || sequencedBatch.size() >= maxBatchBytes || eventBatch.size() >= maxBatchBytes)
+		flushLocked();
+}
+
+void UnixSocketUI::sequence(std::string_view line)
+{
+	++lastSeq;
+	if (!resumeWindow)
+		return;
+
+	std::int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+							 std::chrono::system_clock::now().time_since_epoch())
+							 .count();
+	if (nowMs != stampMs)
+	{
+		// The server-time format, so peers read both tags the same way
+		std::time_t seconds = static_cast<std::time_t>(nowMs / 1000);
+		std::tm tm{};
+		gmtime_r(&seconds, &tm);
+		char buf[32];
+		std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+		stamp = std::format("{}.{:03}Z", buf, nowMs % 1000);
+		stampMs = nowMs;
+	}
+
+	// Merged into the line's own tags: @eirc/seq=<n>;eirc/recv=<time>[;<tags>] <rest of the line>
+	std::size_t start = sequencedBatch.size();
+	std::format_to(std::back_inserter(sequencedBatch), "@eirc/seq={};eirc/recv={}", lastSeq, stamp);
+	if (line.starts_with('@'))
+	{
+		sequencedBatch += ';';
+		sequencedBatch.append(line.substr(1));
 	}
 	else
 	{
-		std::string msg = "Client connected to socket: " + socketPath;
-		logger.log(msg);
+		sequencedBatch += ' ';
+		sequencedBatch.append(line);
 	}
+
+	// The window only ever holds consecutive numbers: a line too long for it starts it over
+	if (!resumeWindow->push(std::string_view(sequencedBatch).substr(start)))
+		resumeWindow->clear();
+	sequencedBatch += '\n';
 }
 
-void UnixSocketUI::shutdown()
+void UnixSocketUI::flushOutput()
 {
-	if (clientFd >= 0)
-		close(clientFd);
-	if (serverFd >= 0)
-		close(serverFd);
-	unlink(socketPath.c_str());
+	std::lock_guard lock(mutex);
+	flushLocked();
 }
 
-void UnixSocketUI::drawOutput(const std::string &line)
+void UnixSocketUI::flushLocked()
 {
-	if (clientFd >= 0)
+	if (batch.empty())
+		return;
+
+	// Nobody to send to: a detached session holds the output for whoever attaches next
+	if (detached && peers.empty())
+	{
+		std::string_view lines = batch;
+		for (std::size_t end; (end = lines.find('\n')) != std::string_view::npos; lines.remove_prefix(end + 1))
+			detached->add(lines.substr(0, end));
+		batch.clear();
+		sequencedBatch.clear();
+		eventBatch.clear();
+		batchLines = 0;
+		return;
+	}
+
+	// One shared batch for every peer (one per form, when some want sequence numbers or events);
+	// only a peer that falls behind gets its own copy of the rest
+	std::vector<int> lagging;
+	std::string_view raw[] = {batch};
+	std::string_view sequenced[] = {sequencedBatch};
+	std::string_view events[] = {eventBatch};
+	for (auto &[fd, peer] : peers)
 	{
-		send(clientFd, line.c_str(), line.length(), 0);
-		send(clientFd, "\n", 1, 0);
+		if (!sendToPeer(peer, peer.events ? events : peer.sequenced ? sequenced : raw))
+			lagging.push_back(fd);
 	}
+	for (int fd : lagging)
+		disconnectLagging(fd);
+
+	linesOut.fetch_add(batchLines, std::memory_order_relaxed);
+	batch.clear();
+	sequencedBatch.clear();
+	eventBatch.clear();
+	batchLines = 0;
 }
 
-std::string UnixSocketUI::getInput()
+int UnixSocketUI::inputFd() const
 {
-	char buf[512] = {0};
-	if (clientFd >= 0)
+	return epollFd.load();
+}
+
+std::optional<std::string> UnixSocketUI::getInput()
+{
+	std::lock_guard lock(mutex);
+
+	if (ready.empty())
+		pollEvents();
+
+	if (!ready.empty())
 	{
-		ssize_t len = recv(clientFd, buf, sizeof(buf) - 1, 0);
-		if (len > 0)
+		std::string input = std::move(ready.front());
+		ready.pop_front();
+		return input;
+	}
+
+	if (closed())
+		return "";
+	return std::nullopt;
+}
+
+bool UnixSocketUI::getInputBatch(std::vector<std::string> &commands)
+{
+	std::lock_guard lock(mutex);
+
+	pollEvents();
+	std::move(ready.begin(), ready.end(), std::back_inserter(commands));
+	ready.clear();
+	return !closed();
+}
+
+void UnixSocketUI::pollEvents()
+{
+	int ep = epollFd.load();
+	if (ep < 0)
+		return;
+
+	epoll_event events[32];
+	int n = epoll_wait(ep, events, 32, 0);
+	for (int i = 0; i < n; ++i)
+	{
+		int fd = events[i].data.fd;
+		if (fd == serverFd.load())
+		{
+			acceptPeers();
+			continue;
+		}
+
+		auto it = peers.find(fd);
+		if (it == peers.end())
+			continue;
+
+		if (events[i].events & EPOLLOUT)
+			flushPending(it->second);
+		if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+			readPeer(it->second); // a hangup reads as EOF and closes the peer
+	}
+
+	// Answered once reading is done, so a peer that has to be dropped for it is not mid-read.
+	// Whatever is batched goes out first, since /resume counts it as sent.
+	if (!peerCommands.empty())
+		flushLocked();
+	for (const auto &[fd, command] : peerCommands)
+		answer(fd, command);
+	peerCommands.clear();
+}
+
+bool UnixSocketUI::closed() const
+{
+	// Closed once everyone who attached has left, or if the socket never came up; a detached
+	// session stays open for the next peer
+	return epollFd.load() < 0 || (everAttached && peers.empty() && options.detachLines == 0);
+}
+
+std::size_t UnixSocketUI::peerCount() const
+{
+	std::lock_guard lock(mutex);
+	return peers.size();
+}
+
+std::size_t UnixSocketUI::detachedLines() const
+{
+	std::lock_guard lock(mutex);
+	return detached ? detached->size() : 0;
+}
+
+std::size_t UnixSocketUI::scrollbackBytes() const
+{
+	std::lock_guard lock(mutex);
+	return scrollback.memoryBytes();
+}
+
+std::uint64_t UnixSocketUI::lastSequence() const
+{
+	std::lock_guard lock(mutex);
+	return lastSeq;
+}
+
+UiQueueStats UnixSocketUI::queueStats() const
+{
+	std::lock_guard lock(mutex);
+	UiQueueStats stats;
+	for (const auto &[fd, peer] : peers)
+	{
+		stats.queuedBytes += peer.pending.size();
+		stats.spilledBytes += peer.spilled();
+	}
+	stats.peakBytes = peakQueued;
+	stats.droppedLines = droppedLines;
+	stats.disconnects = overflowDisconnects;
+	return stats;
+}
+
+UiOverflow UnixSocketUI::parseOverflow(std::string_view name)
+{
+	if (name == "drop-oldest")
+		return UiOverflow::DropOldest;
+	if (name == "disconnect")
+		return UiOverflow::Disconnect;
+	if (name == "spill")
+		return UiOverflow::Spill;
+	throw std::invalid_argument("Invalid UI overflow policy: " + std::string(name));
+}
+
+std::string_view UnixSocketUI::overflowName(UiOverflow policy) noexcept
+{
+	switch (policy)
+	{
+	case UiOverflow::Disconnect:
+		return "disconnect";
+	case UiOverflow::Spill:
+		return "spill";
+	default:
+		return "drop-oldest";
+	}
+}
+
+UiOutputStats UnixSocketUI::outputStats() const
+{
+	return UiOutputStats{linesOut.load(std::memory_order_relaxed),
+						 syscallsOut.load(std::memory_order_relaxed),
+						 bytesOut.load(std::memory_order_relaxed)};
+}
+
+void UnixSocketUI::acceptPeers()
+{
+	while (true)
+	{
+		int fd = accept4(serverFd.load(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
 		{
-			return std::string(buf, len);
+			if (errno == EINTR)
+				continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				perror("accept");
+			return;
 		}
-		else if (len == 0)
+
+		epoll_event event{};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		event.data.fd = fd;
+		epoll_ctl(epollFd.load(), EPOLL_CTL_ADD, fd, &event);
+
+		Peer &peer = peers[fd];
+		peer.fd = fd;
+		logger.log(LogCategory::Ui, LogLevel::Info, "Client connected to socket: {} ({} attached)", socketPath, peers.size());
+
+		// The first peer gets everything that happened before anyone was listening
+		if (!everAttached)
 		{
-			// Connection closed by client
-			return ""; // Let the caller decide what to do
+			everAttached = true;
+			for (const auto &line : backlog)
+			{
+				peer.pending += line;
+				peer.pending += '\n';
+			}
+			linesOut.fetch_add(backlog.size(), std::memory_order_relaxed);
+			backlog.clear();
+			flushPending(peer);
 		}
+		else if (detached)
+			replayDetached(peer);
 	}
-	return "";
+}
+
+void UnixSocketUI::replayDetached(Peer &peer)
+{
+	std::uint64_t dropped = detached->dropped();
+	std::size_t lines = detached->drain(peer.pending);
+	detached.reset();
+
+	// Lets the peer tell a resumed session from a fresh one, and whether anything was lost
+	peer.pending += std::format(":client reattached {} {}\n", lines, dropped);
+	linesOut.fetch_add(lines + 1, std::memory_order_relaxed);
+	logger.log(LogCategory::Ui, LogLevel::Info, "Reattached: replayed {} lines ({} dropped while detached)", lines, dropped);
+	flushPending(peer);
+}
+
+void UnixSocketUI::answer(int fd, std::string_view command)
+{
+	auto it = peers.find(fd);
+	if (it == peers.end())
+		return; // left before it could be answered
+
+	std::size_t space = command.find(' ');
+	std::string_view args = space == std::string_view::npos ? std::string_view() : command.substr(space + 1);
+	if (command.starts_with("/replay"))
+		replay(it->second, args);
+	else if (command.starts_with("/resume"))
+		resume(it->second, args);
+	else
+		protocol(it->second, args);
+}
+
+void UnixSocketUI::reply(Peer &peer, std::span<const std::string_view> data)
+{
+	std::string framed;
+	if (peer.events)
+	{
+		// Scrollback can wrap mid-line across its two pieces: join them before splitting lines
+		std::string lines;
+		for (std::string_view part : data)
+			lines.append(part);
+		appendEventFrames(framed, lines);
+	}
+	std::string_view frames[] = {framed};
+	if (!sendToPeer(peer, peer.events ? std::span<const std::string_view>(frames) : data))
+		disconnectLagging(peer.fd);
+}
+
+void UnixSocketUI::protocol(Peer &peer, std::string_view args)
+{
+	if (args != "events" && args != "lines")
+	{
+		std::string_view data[] = {":client error :usage: /protocol events|lines\n"};
+		reply(peer, data);
+		return;
+	}
+
+	std::string header = std::format(":client protocol {}\n", args);
+	std::string_view data[] = {header};
+	reply(peer, data);
+
+	bool events = args == "events";
+	if (events && !peer.events)
+		++eventPeers;
+	else if (!events && peer.events)
+		--eventPeers;
+	peer.events = events;
+}
+
+void UnixSocketUI::replay(Peer &peer, std::string_view args)
+{
+	// /replay <#channel|nick|*> [lines]
+	std::size_t space = args.find(' ');
+	std::string_view buffer = args.substr(0, space);
+	std::string_view countText = space == std::string_view::npos ? std::string_view() : args.substr(space + 1);
+	std::size_t count = 0; // all of it
+	bool valid = !buffer.empty();
+	if (valid && !countText.empty())
+	{
+		auto [end, ec] = std::from_chars(countText.data(), countText.data() + countText.size(), count);
+		valid = ec == std::errc() && end == countText.data() + countText.size();
+	}
+	if (!valid)
+	{
+		std::string_view data[] = {":client error :usage: /replay <#channel|nick|*> [lines]\n"};
+		reply(peer, data);
+		return;
+	}
+
+	// Header and scrollback go out together, the scrollback straight from its arena
+	std::array<std::string_view, 2> pieces;
+	std::size_t lines = scrollback.last(buffer, count, pieces);
+	std::string header = std::format(":client replay {} {}\n", Scrollback::bufferName(buffer), lines);
+	std::string_view data[] = {header, pieces[0], pieces[1]};
+	linesOut.fetch_add(lines + 1, std::memory_order_relaxed);
+	reply(peer, data);
+}
+
+void UnixSocketUI::resume(Peer &peer, std::string_view args)
+{
+	if (!resumeWindow)
+	{
+		std::string_view data[] = {":client error :/resume is not enabled\n"};
+		reply(peer, data);
+		return;
+	}
+
+	// /resume [sequence]: without one, just start numbering from here
+	std::uint64_t after = lastSeq;
+	if (!args.empty())
+	{
+		auto [end, ec] = std::from_chars(args.data(), args.data() + args.size(), after);
+		if (ec != std::errc() || end != args.data() + args.size())
+		{
+			std::string_view data[] = {":client error :usage: /resume [sequence]\n"};
+			reply(peer, data);
+			return;
+		}
+	}
+	peer.sequenced = true;
+
+	// Past the window, or from before this session started: the peer has to reload
+	std::uint64_t oldest = lastSeq - resumeWindow->size() + 1;
+	if (after > lastSeq || after + 1 < oldest)
+	{
+		std::string header = std::format(":client resume-gap {} {}\n", after, oldest);
+		std::string_view data[] = {header};
+		reply(peer, data);
+		return;
+	}
+
+	std::array<std::string_view, 2> pieces;
+	std::size_t lines = static_cast<std::size_t>(lastSeq - after);
+	if (lines != 0)
+		resumeWindow->newest(lines, pieces);
+	std::string header = std::format(":client resume {} {}\n", after + 1, lastSeq);
+	std::string_view data[] = {header, pieces[0], pieces[1]};
+	linesOut.fetch_add(lines + 1, std::memory_order_relaxed);
+	reply(peer, data);
+}
+
+void UnixSocketUI::disconnectLagging(int fd)
+{
+	++overflowDisconnects;
+	logger.log(LogCategory::Ui, LogLevel::Warn, "Disconnecting socket client that fell {} bytes behind", peers[fd].pending.size() + peers[fd].spilled());
+	closePeer(fd);
+}
+
+void UnixSocketUI::readPeer(Peer &peer)
+{
+	// Commands are newline-terminated and may arrive several to a read or split across reads
+	for (int reads = 0; reads < maxReadsPerEvent; ++reads)
+	{
+		std::span<char> space = peer.framer.prepare();
+		ssize_t len = recv(peer.fd, space.data(), space.size(), MSG_DONTWAIT);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return;
+		if (len <= 0)
+		{
+			// Connection closed by this peer; an unterminated last command is discarded
+			closePeer(peer.fd);
+			return;
+		}
+
+		peer.framer.commit(static_cast<std::size_t>(len));
+		std::string_view line;
+		while (peer.framer.next(line))
+		{
+			if (line == "/replay" || line.starts_with("/replay ") || line == "/resume" || line.starts_with("/resume ") ||
+				line == "/protocol" || line.starts_with("/protocol "))
+				peerCommands.emplace_back(peer.fd, line);
+			else if (!line.empty())
+				ready.emplace_back(line);
+		}
+
+		// A short read drained the socket; level-triggered epoll reports anything newer
+		if (static_cast<std::size_t>(len) < space.size())
+			return;
+	}
+}
+
+void UnixSocketUI::closePeer(int fd)
+{
+	if (auto it = peers.find(fd); it != peers.end() && it->second.framer.droppedBytes() != 0)
+		logger.log(LogCategory::Ui, LogLevel::Warn, "Dropped {} bytes of over-long commands from a socket client",
+				   it->second.framer.droppedBytes());
+
+	if (auto it = peers.find(fd); it != peers.end() && it->second.spillFd >= 0)
+		close(it->second.spillFd);
+	if (auto it = peers.find(fd); it != peers.end() && it->second.events)
+		--eventPeers;
+
+	epoll_ctl(epollFd.load(), EPOLL_CTL_DEL, fd, nullptr);
+	close(fd);
+	peers.erase(fd);
+	logger.log(LogCategory::Ui, LogLevel::Info, "Client left socket: {} ({} attached)", socketPath, peers.size());
+
+	if (peers.empty() && options.detachLines != 0)
+	{
+		detached.emplace(options.detachLines);
+		logger.log(LogCategory::Ui, LogLevel::Info, "Detached: keeping up to {} lines per channel for the next client", options.detachLines);
+	}
+}
+
+bool UnixSocketUI::sendToPeer(Peer &peer, std::span<const std::string_view> data)
+{
+	// Anything on disk is older than `data`; it all goes out through flushPending() in order
+	if (peer.spilled() != 0)
+	{
+		for (std::string_view part : data)
+		{
+			if (!enqueue(peer, part))
+				return false;
+		}
+		return true;
+	}
+
+	// Leftovers first, then the new data, in a single call
+	iovec iov[1 + maxSendParts];
+	std::size_t parts = 0;
+	if (!peer.pending.empty())
+		iov[parts++] = {peer.pending.data(), peer.pending.size()};
+	for (std::string_view part : data.first(std::min(data.size(), maxSendParts)))
+	{
+		if (!part.empty())
+			iov[parts++] = {const_cast<char *>(part.data()), part.size()};
+	}
+	if (parts == 0)
+		return true;
+	msghdr msg{};
+	msg.msg_iov = iov;
+	msg.msg_iovlen = parts;
+
+	ssize_t sent;
+	do
+	{
+		sent = sendmsg(peer.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+	} while (sent < 0 && errno == EINTR);
+
+	if (sent < 0)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			return true; // broken peer; its hangup is picked up by getInput()
+		sent = 0;
+	}
+	syscallsOut.fetch_add(1, std::memory_order_relaxed);
+	bytesOut.fetch_add(static_cast<std::uint64_t>(sent), std::memory_order_relaxed);
+
+	// Drop what went out, keep the rest and wait for the peer to drain
+	std::size_t done = static_cast<std::size_t>(sent);
+	if (done != 0)
+	{
+		// Whether the peer was left mid-line decides what dropOldest() may cut
+		std::size_t at = done - 1;
+		for (std::size_t i = 0; i < parts; ++i)
+		{
+			if (at < iov[i].iov_len)
+			{
+				peer.midLine = static_cast<const char *>(iov[i].iov_base)[at] != '\n';
+				break;
+			}
+			at -= iov[i].iov_len;
+		}
+	}
+	std::size_t fromPending = std::min(done, peer.pending.size());
+	peer.pending.erase(0, fromPending);
+	done -= fromPending;
+	for (std::string_view part : data)
+	{
+		std::size_t taken = std::min(done, part.size());
+		done -= taken;
+		if (taken < part.size() && !enqueue(peer, part.substr(taken)))
+			return false;
+	}
+	return true;
+}
+
+bool UnixSocketUI::enqueue(Peer &peer, std::string_view data)
+{
+	if (peer.spilled() == 0 && peer.pending.size() + data.size() <= options.queueBytes)
+	{
+		peer.pending.append(data);
+	}
+	else
+	{
+		if (!peer.overflowing)
+		{
+			peer.overflowing = true;
+			logger.log(LogCategory::Ui, LogLevel::Warn, "Socket client is {} bytes behind; applying {} policy",
+					   peer.pending.size() + peer.spilled(), overflowName(options.overflow));
+		}
+
+		switch (options.overflow)
+		{
+		case UiOverflow::Disconnect:
+			return false;
+		case UiOverflow::Spill:
+			if (!spill(peer, data))
+				return false;
+			break;
+		case UiOverflow::DropOldest:
+			peer.pending.append(data);
+			dropOldest(peer);
+			break;
+		}
+	}
+
+	peakQueued = std::max<std::uint64_t>(peakQueued, peer.pending.size() + peer.spilled());
+	watchWrite(peer, true);
+	return true;
+}
+
+void UnixSocketUI::dropOldest(Peer &peer)
+{
+	std::string &pending = peer.pending;
+	if (pending.size() <= options.queueBytes)
+		return;
+
+	// Never cut into a line the peer has already started receiving
+	std::size_t start = 0;
+	if (peer.midLine)
+	{
+		start = pending.find('\n');
+		if (start == std::string::npos)
+			return;
+		++start;
+	}
+
+	// Whole lines only: cut through the end of the line holding the last byte over the bound
+	std::size_t excess = pending.size() - options.queueBytes;
+	std::size_t end = pending.find('\n', std::min(start + excess, pending.size()) - 1);
+	end = end == std::string::npos ? pending.size() : end + 1;
+
+	droppedLines += static_cast<std::uint64_t>(std::count(pending.begin() + start, pending.begin() + end, '\n'));
+	pending.erase(start, end - start);
+}
+
+bool UnixSocketUI::spill(Peer &peer, std::string_view data)
+{
+	if (peer.spilled() + data.size() > options.spillBytes)
+		return false;
+
+	if (peer.spillFd < 0)
+	{
+		// Unlinked right away: the file lives exactly as long as the descriptor
+		std::string path = socketPath + ".spill.XXXXXX";
+		peer.spillFd = mkostemp(path.data(), O_CLOEXEC);
+		if (peer.spillFd < 0)
+		{
+			perror("mkostemp");
+			return false;
+		}
+		unlink(path.c_str());
+	}
+
+	while (!data.empty())
+	{
+		ssize_t written = pwrite(peer.spillFd, data.data(), data.size(), static_cast<off_t>(peer.spillWrite));
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+		{
+			perror("pwrite");
+			return false;
+		}
+		peer.spillWrite += static_cast<std::uint64_t>(written);
+		data.remove_prefix(static_cast<std::size_t>(written));
+	}
+	return true;
+}
+
+bool UnixSocketUI::refill(Peer &peer)
+{
+	if (peer.spilled() == 0)
+		return false;
+
+	std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(peer.spilled(), std::max(options.queueBytes, maxBatchBytes)));
+	peer.pending.resize(size);
+	ssize_t got;
+	do
+	{
+		got = pread(peer.spillFd, peer.pending.data(), size, static_cast<off_t>(peer.spillRead));
+	} while (got < 0 && errno == EINTR);
+
+	if (got <= 0)
+	{
+		// Unreadable spill file: the queued output is gone either way
+		perror("pread");
+		peer.pending.clear();
+		peer.spillRead = peer.spillWrite;
+	}
+	else
+	{
+		peer.pending.resize(static_cast<std::size_t>(got));
+		peer.spillRead += static_cast<std::uint64_t>(got);
+	}
+
+	// Caught up with the file: start it over instead of letting it grow
+	if (peer.spilled() == 0)
+	{
+		peer.spillRead = peer.spillWrite = 0;
+		if (ftruncate(peer.spillFd, 0) != 0)
+			perror("ftruncate");
+	}
+	return !peer.pending.empty();
+}
+
+void UnixSocketUI::flushPending(Peer &peer)
+{
+	while (!peer.pending.empty() || refill(peer))
+	{
+		ssize_t sent = send(peer.fd, peer.pending.data(), peer.pending.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				watchWrite(peer, true);
+				return;
+			}
+			peer.pending.clear(); // broken peer; its hangup is picked up by getInput()
+			peer.spillRead = peer.spillWrite = 0;
+			break;
+		}
+		syscallsOut.fetch_add(1, std::memory_order_relaxed);
+		bytesOut.fetch_add(static_cast<std::uint64_t>(sent), std::memory_order_relaxed);
+		if (sent > 0)
+			peer.midLine = peer.pending[static_cast<std::size_t>(sent) - 1] != '\n';
+		peer.pending.erase(0, static_cast<std::size_t>(sent));
+	}
+	peer.overflowing = false;
+	watchWrite(peer, false);
+}
+
+void UnixSocketUI::watchWrite(Peer &peer, bool enable)
+{
+	if (peer.watchingWrite == enable)
+		return;
+
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+	event.data.fd = peer.fd;
+	epoll_ctl(epollFd.load(), EPOLL_CTL_MOD, peer.fd, &event);
+	peer.watchingWrite = enable;
 }
@@ -2,29 +2,218 @@
 // Requires: C++23
 // Purpose: Declares the UnixSocketUI class, an implementation of the IOAdapter interface that uses
 //          UNIX domain sockets to enable communication between the IRC client and external processes.
-//          Provides methods for initialization, shutdown, output rendering, and input retrieval.
+//          Any number of peers (browser tabs, monitoring tools) can attach; output fans out to all
+//          of them and their commands are multiplexed into the session. Non-blocking throughout,
+//          driven by one epoll descriptor that the session waits on. /replay, /resume and
+//          /protocol are answered here, since only the UI knows which peer asked. A peer gets raw
+//          IRC lines unless it negotiates framed, pre-parsed events with `/protocol events`.
 
 #pragma once
 
+#include "DetachBuffer.hpp"
+#include "EventFrame.hpp"
 #include "IOAdapter.hpp"
+#include "LineFramer.hpp"
+#include "LineRing.hpp"
 #include "Logger.hpp"
+#include "Scrollback.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <sys/socket.h>
 #include <sys/un.h>
 
+// What happens to a peer whose unsent output reaches UiOptions::queueBytes
+enum class UiOverflow
+{
+	DropOldest, // discard whole lines from the front of its queue
+	Disconnect, // close it; the web tier reconnects and starts fresh
+	Spill		// move the excess to an unlinked temp file, up to UiOptions::spillBytes
+};
+
+struct UiOptions
+{
+	std::size_t backlogLines = 1000;		   // output kept for the first peer to attach
+	std::size_t queueBytes = 1 << 20;		   // unsent output held in memory per peer
+	UiOverflow overflow = UiOverflow::DropOldest;
+	std::size_t spillBytes = 64 << 20; // per peer; a peer that falls further behind is disconnected
+	// Detached mode: output kept per channel while no peer is attached, replayed to the next one.
+	// 0 reports the UI closed once the last peer leaves, which signs the session off.
+	std::size_t detachLines = 0;
+	ScrollbackOptions scrollback; // recent output per channel and query, for /replay
+	// Sequenced output kept for /resume; 0 lines turns sequencing off
+	std::size_t resumeLines = 10000;
+	std::size_t resumeBytes = 2 << 20;
+};
+
+// Queue depth across peers; current values plus totals since start
+struct UiQueueStats
+{
+	std::uint64_t queuedBytes = 0;	// in memory now
+	std::uint64_t spilledBytes = 0; // on disk now
+	std::uint64_t peakBytes = 0;	// deepest any one peer's queue has been
+	std::uint64_t droppedLines = 0;
+	std::uint64_t disconnects = 0; // peers closed for falling behind
+
+	UiQueueStats &operator+=(const UiQueueStats &other)
+	{
+		queuedBytes += other.queuedBytes;
+		spilledBytes += other.spilledBytes;
+		peakBytes = std::max(peakBytes, other.peakBytes);
+		droppedLines += other.droppedLines;
+		disconnects += other.disconnects;
+		return *this;
+	}
+};
+
+// Output counters, to see how well drawOutput() batches are coalesced
+struct UiOutputStats
+{
+	std::uint64_t lines = 0;
+	std::uint64_t syscalls = 0;
+	std::uint64_t bytes = 0;
+
+	UiOutputStats &operator+=(const UiOutputStats &other)
+	{
+		lines += other.lines;
+		syscalls += other.syscalls;
+		bytes += other.bytes;
+		return *this;
+	}
+};
+
 class UnixSocketUI : public IOAdapter
 {
 public:
-	UnixSocketUI(const std::string &path, Logger &logger);
+	// Output drawn before the first peer attaches is kept, up to `backlogLines`, and replayed to it
+	UnixSocketUI(const std::string &path, Logger &logger, UiOptions options = {});
 	~UnixSocketUI();
 	void init() override;
 	void shutdown() override;
+	// Appends `line` to the current batch; nothing is sent until flushOutput()
 	void drawOutput(const std::string &line) override;
-	std::string getInput() override;
+	// Sends the batch to every peer with one sendmsg each
+	void flushOutput() override;
+	// The epoll descriptor: readable whenever a peer connects, sends, hangs up or drains
+	int inputFd() const override;
+	// One newline-terminated command; empty string once the last attached peer has gone away
+	// (never, in detached mode)
+	std::optional<std::string> getInput() override;
+	// Every complete command from every peer that is ready; false once the last peer has gone
+	// (never, in detached mode)
+	bool getInputBatch(std::vector<std::string> &commands) override;
+
+	[[nodiscard]] std::size_t peerCount() const;
+	// Lines held for the next peer while detached
+	[[nodiscard]] std::size_t detachedLines() const;
+	// Arena and index memory held for /replay
+	[[nodiscard]] std::size_t scrollbackBytes() const;
+	// Sequence number of the last line drawn
+	[[nodiscard]] std::uint64_t lastSequence() const override;
+	[[nodiscard]] UiOutputStats outputStats() const;
+	[[nodiscard]] UiQueueStats queueStats() const;
+
+	// "drop-oldest", "disconnect" or "spill"; throws std::invalid_argument otherwise
+	static UiOverflow parseOverflow(std::string_view name);
+	static std::string_view overflowName(UiOverflow policy) noexcept;
 
 private:
+	static constexpr std::size_t maxBatchBytes = 64 * 1024;
+	static constexpr std::size_t minReadBytes = 512;
+	static constexpr std::size_t maxCommandBytes = 64 * 1024; // longer commands are dropped
+	static constexpr int maxReadsPerEvent = 16;				  // keeps one chatty peer from starving the rest
+	static constexpr std::size_t maxSendParts = 3;			  // pieces handed to one sendToPeer()
+
+	struct Peer
+	{
+		int fd = -1;
+		std::string pending; // unsent output, only while the peer is not keeping up
+		bool watchingWrite = false;
+		bool midLine = false;	  // the peer already has the start of pending's first line
+		bool overflowing = false; // over its bound since it last caught up
+		bool sequenced = false;	  // asked for /resume: gets lines tagged with eirc/seq and eirc/recv
+		bool events = false;	  // `/protocol events`: gets EventFrame frames instead of lines
+		int spillFd = -1;		  // Spill: output queued behind `pending`, oldest at spillRead
+		std::uint64_t spillRead = 0;
+		std::uint64_t spillWrite = 0;
+		LineFramer framer{minReadBytes * 2, maxCommandBytes}; // partial command carried between reads
+
+		std::uint64_t spilled() const noexcept { return spillWrite - spillRead; }
+	};
+
+	void pollEvents();
+	bool closed() const;
+	void acceptPeers();
+	void readPeer(Peer &peer);
+	void closePeer(int fd);
+	// Sends the peer's leftovers plus `data` with one sendmsg, queueing whatever the socket won't
+	// take. False when the peer has to be disconnected for falling too far behind.
+	bool sendToPeer(Peer &peer, std::span<const std::string_view> data);
+	bool enqueue(Peer &peer, std::string_view data);
+	void dropOldest(Peer &peer);
+	bool spill(Peer &peer, std::string_view data);
+	bool refill(Peer &peer);
+	void flushPending(Peer &peer);
+	void watchWrite(Peer &peer, bool enable);
+	void flushLocked();
+	// Sends what was missed while detached to a peer that just attached
+	void replayDetached(Peer &peer);
+	// Numbers `line`, keeps its tagged copy for /resume and batches it for sequenced peers
+	void sequence(std::string_view line);
+	// Commands the UI answers itself, for the peer that sent them
+	void answer(int fd, std::string_view command);
+	// /replay <buffer> [lines]: the newest scrollback lines of a buffer
+	void replay(Peer &peer, std::string_view args);
+	// /resume [seq]: sequenced output from now on, after the lines missed since `seq`
+	void resume(Peer &peer, std::string_view args);
+	// /protocol events|lines: acknowledged in the old form, everything after it in the new one
+	void protocol(Peer &peer, std::string_view args);
+	// Sends newline-terminated lines to one peer, framed if it asked for events
+	void reply(Peer &peer, std::span<const std::string_view> data);
+	void disconnectLagging(int fd);
+
 	std::string socketPath;
-	int serverFd = -1;
-	int clientFd = -1;
 	Logger &logger;
+	UiOptions options;
+
+	// Guards everything below against shutdown() from another thread; uncontended otherwise
+	mutable std::mutex mutex;
+	std::atomic<int> serverFd = -1;
+	std::atomic<int> epollFd = -1;
+	std::unordered_map<int, Peer> peers;
+	std::deque<std::string> ready;	 // complete commands read but not yet handed out
+	std::vector<std::pair<int, std::string>> peerCommands; // /replay, /resume and /protocol by peer, answered after each poll
+	std::deque<std::string> backlog; // output from before the first peer attached
+	bool everAttached = false;
+	std::optional<DetachBuffer> detached; // with UiOptions::detachLines, while no peer is attached
+	Scrollback scrollback;
+
+	std::uint64_t lastSeq = 0;			   // of the last line drawn
+	std::optional<LineRing> resumeWindow; // tagged lines, the newest numbered lastSeq
+	std::string sequencedBatch;			   // `batch` as sequenced peers get it
+	std::string stamp;					   // eirc/recv value, redone when the millisecond changes
+	std::int64_t stampMs = -1;
+	std::string eventBatch;	   // `batch` as framed events, built only while a peer wants them
+	std::size_t eventPeers = 0;
+
+	std::string batch; // newline-terminated lines drawn since the last flush
+	std::size_t batchLines = 0;
+
+	std::atomic<std::uint64_t> linesOut = 0;
+	std::atomic<std::uint64_t> syscallsOut = 0;
+	std::atomic<std::uint64_t> bytesOut = 0;
+
+	std::uint64_t peakQueued = 0;
+	std::uint64_t droppedLines = 0;
+	std::uint64_t overflowDisconnects = 0;
 };
@@ -1,17 +1,20 @@
 // File: User.hpp
 // Requires: C++23
-// Purpose: Defines the User struct representing an IRC user, including nickname, status prefix
-//          (e.g., operator or voiced), and optional WHOIS metadata via WhoisState.
+// Purpose: Defines the User struct representing an IRC user known to the session. Channel status
+//          (op, voice) is per channel; see Channel. The rest is filled in for a whole channel at a
+//          time by WHO/WHOX and lives as long as the user shares a channel with us. WHOIS results
+//          live in WhoisCache, not here, so they expire instead of staying with the user.
 
 #pragma once
 
-#include "WhoisState.hpp"
 #include <string>
-#include <optional>
 
 struct User
 {
 	std::string nick;
-	std::string status; // "", "@", "+"
-	std::optional<WhoisState> whoisState;
+	std::string username; // empty until a WHO reply covers the user
+	std::string host;
+	std::string account; // services account; empty if not logged in (or the server lacks WHOX)
+	std::string realname;
+	bool away = false;
 };
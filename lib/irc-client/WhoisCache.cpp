@@ -0,0 +1,196 @@
+// File: WhoisCache.cpp
+// Requires: C++23
+// Purpose: Implements the WHOIS cache: casefolded keys, request coalescing, TTL expiry on lookup
+//          and LRU eviction on insert, plus the JSON event and numeric replay of a result.
+
+#include "WhoisCache.hpp"
+
+#include <format>
+#include <utility>
+
+#include "Json.hpp"
+
+WhoisCache::WhoisCache(WhoisOptions options)
+	: options(options)
+{
+}
+
+void WhoisCache::setCaseMapping(CaseMapping newMapping)
+{
+	if (newMapping == mapping)
+		return;
+	mapping = newMapping;
+	lru.clear();
+	cached.clear();
+	pending.clear();
+}
+
+WhoisCache::Request WhoisCache::request(std::string_view nick, Clock::time_point now, const WhoisState *&result)
+{
+	std::string key = keyOf(nick);
+
+	if (auto it = cached.find(key); it != cached.end())
+	{
+		if (it->second->expires > now)
+		{
+			lru.splice(lru.begin(), lru, it->second);
+			result = &it->second->state;
+			++counters.hits;
+			return Request::Cached;
+		}
+		lru.erase(it->second);
+		cached.erase(it);
+	}
+
+	auto [it, inserted] = pending.try_emplace(std::move(key));
+	if (!inserted && it->second.requested != Clock::time_point{} && now - it->second.requested < requestTimeout)
+	{
+		++counters.coalesced;
+		return Request::Pending;
+	}
+
+	it->second.requested = now;
+	++counters.misses;
+	return Request::Send;
+}
+
+WhoisState &WhoisCache::collect(std::string_view nick)
+{
+	WhoisState &state = pending[keyOf(nick)].state;
+	if (state.nick.empty())
+		state.nick = nick;
+	return state;
+}
+
+WhoisState *WhoisCache::collecting(std::string_view nick)
+{
+	auto it = pending.find(keyOf(nick));
+	return it == pending.end() ? nullptr : &it->second.state;
+}
+
+const WhoisState *WhoisCache::complete(std::string_view nick, Clock::time_point now)
+{
+	auto it = pending.find(keyOf(nick));
+	if (it == pending.end())
+		return nullptr;
+
+	std::string key = it->first;
+	WhoisState state = std::move(it->second.state);
+	pending.erase(it);
+	if (state.nick.empty())
+		state.nick = nick; // 318 alone: nothing but the end marker came back
+
+	store(std::move(key), std::move(state), now);
+	return &lru.front().state;
+}
+
+void WhoisCache::invalidate(std::string_view nick)
+{
+	if (auto it = cached.find(keyOf(nick)); it != cached.end())
+	{
+		lru.erase(it->second);
+		cached.erase(it);
+	}
+}
+
+std::size_t WhoisCache::size() const noexcept
+{
+	return cached.size();
+}
+
+std::size_t WhoisCache::inFlight() const noexcept
+{
+	return pending.size();
+}
+
+const WhoisStats &WhoisCache::stats() const noexcept
+{
+	return counters;
+}
+
+std::string WhoisCache::toJson(const WhoisState &state, bool fromCache)
+{
+	std::string out = "{";
+	auto field = [&out](std::string_view key, std::string_view value)
+	{
+		appendJsonKey(out, key);
+		appendJsonString(out, value);
+		out += ',';
+	};
+
+	field("nick", state.nick);
+	out += std::format("\"exists\":{},", state.exists);
+	field("username", state.username);
+	field("host", state.host);
+	field("realname", state.realname);
+	field("server", state.server);
+	field("serverInfo", state.serverInfo);
+	field("account", state.account);
+	field("channels", state.channels);
+	field("away", state.awayMessage);
+	out += std::format("\"operator\":{},\"idle\":{},\"signon\":{},\"cached\":{}}}", state.isOperator,
+					   state.idleSeconds, state.signonTime, fromCache);
+	return out;
+}
+
+std::vector<std::string> WhoisCache::toNumerics(const WhoisState &state, std::string_view source,
+												std::string_view target)
+{
+	std::vector<std::string> lines;
+	auto reply = [&](int numeric, std::string_view params)
+	{ lines.push_back(std::format(":{} {:03} {} {} {}", source, numeric, target, state.nick, params)); };
+
+	if (!state.exists)
+	{
+		reply(401, ":No such nick/channel");
+	}
+	else
+	{
+		reply(311, std::format("{} {} * :{}", state.username, state.host, state.realname));
+		if (!state.account.empty())
+			reply(330, std::format("{} :is logged in as", state.account));
+		if (!state.server.empty())
+			reply(312, std::format("{} :{}", state.server, state.serverInfo));
+		if (state.isOperator)
+			reply(313, ":is an IRC operator");
+		if (state.signonTime || state.idleSeconds)
+			reply(317, std::format("{} {} :seconds idle, signon time", state.idleSeconds, state.signonTime));
+		if (!state.channels.empty())
+			reply(319, ":" + state.channels);
+		if (!state.awayMessage.empty())
+			reply(301, ":" + state.awayMessage);
+	}
+	reply(318, ":End of /WHOIS list.");
+	return lines;
+}
+
+std::string WhoisCache::keyOf(std::string_view nick) const
+{
+	return foldNick(nick, mapping);
+}
+
+void WhoisCache::store(std::string key, WhoisState state, Clock::time_point now)
+{
+	if (auto it = cached.find(key); it != cached.end())
+	{
+		lru.erase(it->second);
+		cached.erase(it);
+	}
+
+	lru.push_front(Entry{key, std::move(state), now + options.ttl});
+	if (options.ttl.count() <= 0 || options.capacity == 0)
+	{
+		// Nothing is served from the cache; the entry only lives until the caller has used it
+		while (lru.size() > 1)
+			lru.pop_back();
+		return;
+	}
+	cached.emplace(std::move(key), lru.begin());
+
+	while (cached.size() > options.capacity)
+	{
+		cached.erase(lru.back().key);
+		lru.pop_back();
+		++counters.evicted;
+	}
+}
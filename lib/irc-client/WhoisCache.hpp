@@ -0,0 +1,113 @@
+// File: WhoisCache.hpp
+// Requires: C++23
+// Purpose: Declares WhoisCache, which sits between WHOIS requests and the server. A request for a
+//          nick that was answered recently is served from the cache; a request for a nick that is
+//          already being asked about joins the one in flight instead of sending another WHOIS.
+//          Replies are collected per nick until RPL_ENDOFWHOIS, then kept for a TTL, with the
+//          least recently used results evicted past a size cap.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "NickTable.hpp"
+#include "WhoisState.hpp"
+
+struct WhoisOptions
+{
+	std::chrono::seconds ttl{300}; // 0: never answer from cache (requests are still coalesced)
+	std::size_t capacity = 256;	   // cached results kept at most
+};
+
+struct WhoisStats
+{
+	std::uint64_t hits = 0;		 // answered from cache
+	std::uint64_t misses = 0;	 // sent to the server
+	std::uint64_t coalesced = 0; // joined a request already in flight
+	std::uint64_t evicted = 0;	 // dropped by the size cap
+};
+
+class WhoisCache
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Request
+	{
+		Send,	 // not cached or stale: the caller sends WHOIS; the nick is now in flight
+		Pending, // already in flight: the reply reaches every peer when it arrives
+		Cached	 // fresh result available through `result`
+	};
+
+	// An unanswered request stops holding back new ones after this long
+	static constexpr std::chrono::seconds requestTimeout{30};
+
+	explicit WhoisCache(WhoisOptions options = {});
+
+	// Keys follow the server's CASEMAPPING; clears cached results
+	void setCaseMapping(CaseMapping mapping);
+
+	Request request(std::string_view nick, Clock::time_point now, const WhoisState *&result);
+
+	// The result being collected for `nick` (311, 312, 317, ...); replies nobody asked for
+	// through this cache are collected too
+	WhoisState &collect(std::string_view nick);
+	// The result being collected for `nick`, or nullptr if nothing is (for replies such as
+	// ERR_NOSUCHNICK that are only part of a WHOIS when one is in progress)
+	WhoisState *collecting(std::string_view nick);
+
+	/**
+	 * RPL_ENDOFWHOIS: the collected result for `nick` is complete. Caches it (unless the TTL is 0)
+	 * and returns it; nullptr if nothing was collected, e.g. a 318 with no preceding replies.
+	 * The pointer stays valid until the next call that modifies the cache.
+	 */
+	const WhoisState *complete(std::string_view nick, Clock::time_point now);
+
+	// NICK and QUIT make a cached result wrong; drop it
+	void invalidate(std::string_view nick);
+
+	[[nodiscard]] std::size_t size() const noexcept;
+	[[nodiscard]] std::size_t inFlight() const noexcept;
+	[[nodiscard]] const WhoisStats &stats() const noexcept;
+
+	// One line for the `:client whois` event: {"nick":...,"idle":123,...,"cached":true}
+	[[nodiscard]] static std::string toJson(const WhoisState &state, bool cached);
+	/**
+	 * The numerics a server would have sent for `state` (311/330/312/313/317/319/301 or 401, then
+	 * 318), from `source` to `target`, so peers that parse raw WHOIS replies get a cache hit in
+	 * the shape they already handle.
+	 */
+	[[nodiscard]] static std::vector<std::string> toNumerics(const WhoisState &state, std::string_view source,
+															 std::string_view target);
+
+private:
+	struct Entry
+	{
+		std::string key;
+		WhoisState state;
+		Clock::time_point expires;
+	};
+
+	struct Pending
+	{
+		WhoisState state;
+		Clock::time_point requested{}; // epoch if collected without a request
+	};
+
+	[[nodiscard]] std::string keyOf(std::string_view nick) const;
+	void store(std::string key, WhoisState state, Clock::time_point now);
+
+	WhoisOptions options;
+	CaseMapping mapping = CaseMapping::Rfc1459;
+	std::list<Entry> lru; // most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> cached;
+	std::unordered_map<std::string, Pending> pending;
+	WhoisStats counters;
+};
@@ -1,22 +1,26 @@
 // File: WhoisState.hpp
 // Requires: C++23
-// Purpose: Defines the WhoisState struct, which stores detailed metadata about an IRC user obtained
-//          from WHOIS responses, including real name, server info, channel list, idle time, and sign-on time.
+// Purpose: Defines the WhoisState struct, which stores the result of one WHOIS reply: real name,
+//          server info, channel list, account, away message, and idle and sign-on times as numbers.
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 struct WhoisState
 {
+	std::string nick; // as the server spelled it
+	std::string username;
+	std::string host;
 	std::string realname;
 	std::string server;
 	std::string serverInfo;
 	std::string channels;
-	std::string idleSeconds;
-	std::string signonTime;
-	std::string username;
-	std::string host;
-	std::string awayMessage;
-	bool isOperator;
+	std::string account;	 // 330, empty if not logged in
+	std::string awayMessage; // 301, empty if not away
+	std::uint64_t idleSeconds = 0;
+	std::int64_t signonTime = 0; // Unix time
+	bool isOperator = false;
+	bool exists = false; // false when the server answered ERR_NOSUCHNICK
 };
@@ -2,7 +2,8 @@
 // Requires: C++23
 // Purpose: Entry point for the IRC client. Parses arguments, sets up I/O abstraction,
 //          initializes the client, registers event handlers, and manages execution flow
-//          using modern memory and container features of C++23.
+//          using modern memory and container features of C++23. With --daemon, hosts many
+//          sessions in one process behind a control socket instead.
 
 #include "IRCClient.hpp"
 #include "IRCEventKeys.hpp"
@@ -14,40 +15,68 @@
 #include "Logger.hpp"
 #include "ArgParser.hpp"
 #include "IOAdapter.hpp"
+#include "SessionManager.hpp"
+#include "ControlServer.hpp"
 
+#include <algorithm>
+#include <csignal>
 #include <iostream>
 #include <asio.hpp>
 #include <memory>
+#include <pthread.h>
+#include <thread>
+#include <vector>
 
 // Event Handlers
-#include "EventHandlers/MotdEndHandler.hpp"
-#include "EventHandlers/NameReplyHandler.hpp"
-#include "EventHandlers/PingHandler.hpp"
-#include "EventHandlers/WhoisHandler.hpp"
-
-// Add new handlers here:
-// return {
-//     {IRCEventKey::PrivMsg, {
-//          channelMsgHandler(),
-//          userToUserMsgHandler(),
-//      }},
-//     {IRCEventKey::Notice, {
-//          noticeHandler(),
-//      }},
-//     {IRCEventKey::MotdEnd, {motdEndHandler()}},
-//     {IRCEventKey::RplNameReply, {nameReplyHandler()}},
-//     {IRCEventKey::Ping, {pingHandler()}},
-//     {IRCEventKey::Whois, {whoisHandler()}},
-// };
-
-std::map<std::string, std::vector<std::function<void(IRCClient &, const std::string &)>>> buildHandlers()
+#include "EventHandlers/DefaultHandlers.hpp"
+
+// Daemon mode: host many sessions on a small io_context pool, driven by a control socket.
+int runDaemon(const ParsedArgs &args)
 {
-    return {
-        {IRCEventKey::MotdEnd, {motdEndHandler()}},
-        {IRCEventKey::RplNameReply, {nameReplyHandler()}},
-        {IRCEventKey::Ping, {pingHandler()}},
-        {IRCEventKey::Whois, {whoisHandler()}},
-    };
+    Logger logger(args.logPath, args.logOptions);
+
+    // Block termination signals in every thread; the main thread collects them with sigwait()
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::size_t threadCount = args.threads > 0
+                                  ? static_cast<std::size_t>(args.threads)
+                                  : std::max(1u, std::thread::hardware_concurrency());
+
+    asio::io_context ioContext;
+    auto work = asio::make_work_guard(ioContext);
+
+    SessionManager sessions(ioContext, logger, args, threadCount);
+    ControlServer control(ioContext, args.listenSocket, sessions, logger);
+    control.start();
+
+    std::vector<std::thread> pool;
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        pool.emplace_back([&ioContext]
+                          { ioContext.run(); });
+    }
+    logger.log("Daemon started with " + std::to_string(threadCount) + " io threads");
+
+    int received = 0;
+    sigwait(&signals, &received);
+    logger.log("Daemon received signal " + std::to_string(received) + ", shutting down");
+
+    // Sessions sign off while the pool is still serving their completion handlers
+    control.stop();
+    sessions.shutdown();
+
+    work.reset();
+    ioContext.stop();
+    for (auto &thread : pool)
+        thread.join();
+
+    logger.flush();
+    return 0;
 }
 
 int main(int argc, char *argv[])
@@ -56,13 +85,18 @@ int main(int argc, char *argv[])
     {
         ArgParser parser(argc, argv);
         ParsedArgs args = parser.getArgs();
-        Logger logger(args.logPath);
+        if (args.daemon)
+        {
+            return runDaemon(args);
+        }
+
+        Logger logger(args.logPath, args.logOptions);
         std::string instance_id = args.instance;
 
         std::unique_ptr<IOAdapter> io;
         if (!args.listenSocket.empty())
         {
-            io = std::make_unique<UnixSocketUI>(args.listenSocket, logger);
+            io = std::make_unique<UnixSocketUI>(args.listenSocket, logger, args.uiOptions);
         }
         else
         {
@@ -73,19 +107,11 @@ int main(int argc, char *argv[])
         logger.log("Starting IRC client...");
 
         asio::io_context ioContext;
-        IRCClient client(ioContext, logger, *io, args.channels);
+        IRCClient client(ioContext, logger, *io, args.channels, args.outboundOptions, args.whoisOptions,
+                         args.historyOptions);
 
         // Register event handlers
-        for (const auto &[event, handlers] : buildHandlers())
-        {
-            for (const auto &handler : handlers)
-            {
-                client.addEventHandler(event, handler);
-            }
-        }
-
-        // Start client connection
-        client.connect(args.server, args.port);
+        registerDefaultHandlers(client);
 
         // Choose adapter and negotiate authentication
         std::unique_ptr<AuthStrategy> auth;
@@ -106,23 +132,34 @@ int main(int argc, char *argv[])
         catch (const std::exception &ex)
         {
             logger.log(std::string("ERROR during authentication negotiate: ") + ex.what());
-            logger.flush();
+            logger.hardFlush();
             return 1;
         }
 
-        // Proceed with the normal NICK/USER
+        // Proceed with the normal NICK/USER (queued until the connection is up)
         client.authenticate(args.nick, args.user, args.realname);
 
-        // Start background input thread (now joinable)
-        client.startInputLoop();
-
-        // Blocking read loop on main thread
-        client.readLoop(args.channels);
-
-        // Wait for the input thread to finish
-        client.joinInputLoop(); // <-- NEW: ensures exception in input thread is handled
+        // Connect and serve server reads, UI input and writes on this thread until the session ends
+        int exitCode = 0;
+        client.start(args.server, args.port, [&](std::exception_ptr ex)
+                     {
+            if (!ex)
+                return;
+            try
+            {
+                std::rethrow_exception(ex);
+            }
+            catch (const std::exception &e)
+            {
+                logger.log("Fatal error in session: " + std::string(e.what()));
+                logger.hardFlush();
+                exitCode = 1;
+            } });
+        ioContext.run();
 
         io->shutdown();
+        if (exitCode != 0)
+            return exitCode;
     }
     catch (const std::exception &e)
     {
@@ -33,4 +33,14 @@ function _M.use_sasl()
     return os.getenv("IRC_USE_SASL") == "true"
 end
 
+-- Whether sessions are hosted by one irc-client daemon instead of a process per user
+function _M.use_daemon()
+    return os.getenv("IRC_DAEMON") == "true"
+end
+
+-- Whether IRC sessions outlive the WebSocket, so a page reload reattaches instead of reconnecting
+function _M.use_detach()
+    return os.getenv("IRC_DETACH") == "true"
+end
+
 return _M
@@ -2,6 +2,7 @@ local _M = {}
 local ws_server = require "resty.websocket.server"
 local irc = require "jesse-greathouse.eIRC.websocket.server.irc_socket"
 local http = require "jesse-greathouse.eIRC.http"
+local env = require "jesse-greathouse.eIRC.env"
 
 --[[
     server.run(...)
@@ -18,7 +19,7 @@ local http = require "jesse-greathouse.eIRC.http"
         Retry-connect to IRC UNIX socket
         Start IRC receive thread → pipe into WebSocket
         Enter WebSocket receive loop → pipe into IRC
-        On disconnect: shutdown IRC and WebSocket
+        On disconnect: shutdown IRC (or leave it detached) and WebSocket
 --]]
 function _M.run(nick, realname, server_addr, port, channels, instance_id, sasl_secret)
     -- Validate instance ID
@@ -96,8 +97,10 @@ function _M.run(nick, realname, server_addr, port, channels, instance_id, sasl_s
 
     -- Cleanup on disconnect or fatal error
 
-    -- Gracefully tell IRC client to quit
-    irc.send(instance_id, "/quit")
+    -- Gracefully tell IRC client to quit, unless it is meant to wait for the next page load
+    if not env.use_detach() then
+        irc.send(instance_id, "/quit")
+    end
 
     -- Close IRC socket and kill state
     irc.close(instance_id)
@@ -8,11 +8,122 @@ local store = require "jesse-greathouse.eIRC.stores.irc_instance_store"
 
 local _M = {}
 
+-- Lines per channel a detached session keeps for the next WebSocket
+local DETACH_LINES = 500
+
+-- The session's answer to /protocol events; everything after it arrives as framed events
+local PROTOCOL_ACK = ":client protocol events"
+
 -- Computes the full Unix socket path for a given IRC instance
 local function get_socket_file(instance_id)
   return env.var_dir() .. "/socket/irc-client-" .. instance_id .. ".sock"
 end
 
+-- Computes the control socket path of the multi-session irc-client daemon
+local function get_daemon_socket_file()
+  return env.var_dir() .. "/socket/irc-client-daemon.sock"
+end
+
+-- Sends one request line to the daemon control socket and returns its reply line
+local function daemon_request(line)
+  local sock = socket.tcp()
+  local ok, err = sock:connect("unix:" .. get_daemon_socket_file())
+  if not ok then
+    return nil, err
+  end
+
+  sock:settimeouts(1000, 5000, 5000)
+  local _, send_err = sock:send(line .. "\n")
+  if send_err then
+    sock:close()
+    return nil, send_err
+  end
+
+  local reply, recv_err = sock:receive("*l")
+  sock:close()
+  return reply, recv_err
+end
+
+-- Starts the irc-client daemon if its control socket is not answering yet
+local function ensure_daemon()
+  if daemon_request("list") then
+    return true
+  end
+
+  local proc, err = pipe.spawn({
+      env.bin_dir() .. "/irc-client",
+      "--daemon",
+      "--listen=" .. env.var_dir() .. "/socket",
+      "--log=" .. env.log_dir() .. "/irc-client",
+  }, {
+    merge_stderr = true,
+    detached = true,
+  })
+
+  if not proc then
+    ngx.log(ngx.ERR, "Failed to spawn IRC client daemon: ", err)
+    return nil, err
+  end
+
+  for _ = 1, 20 do
+    ngx.sleep(0.05)
+    if daemon_request("list") then
+      return true
+    end
+  end
+
+  return nil, "IRC client daemon did not come up"
+end
+
+-- Asks the session for framed, pre-parsed events instead of raw IRC lines. Lines already on
+-- their way (backlog, detach replay) still arrive raw, up to the acknowledgement.
+local function request_events(sock)
+  return sock:send("/protocol events\n")
+end
+
+-- Reads one event frame, "<length> <type> <json>\n", routed by its type without decoding the JSON.
+-- Returns the type and the JSON, or nil, nil and the error. "timeout" only ever falls between frames.
+local function receive_event(sock, read_field)
+  local length, err, partial = read_field()
+  if not length then
+    if err == "timeout" and partial and partial ~= "" then
+      return nil, nil, "timeout inside a frame"
+    end
+    return nil, nil, err
+  end
+
+  local size = tonumber(length)
+  if not size then
+    return nil, nil, "malformed frame header"
+  end
+
+  -- Past the length, a timeout would leave the stream mid-frame: report it as an error
+  local event_type, type_err = read_field()
+  if not event_type then
+    return nil, nil, type_err == "timeout" and "timeout inside a frame" or type_err
+  end
+
+  local payload, payload_err = sock:receive(size + 1)
+  if not payload then
+    return nil, nil, payload_err == "timeout" and "timeout inside a frame" or payload_err
+  end
+  return event_type, payload:sub(1, -2)
+end
+
+-- Attaches to a detached session that is still listening on its socket, if there is one.
+-- Checked through the socket rather than the store, which is per nginx worker.
+local function attach_detached(instance_id)
+  local sock = socket.tcp()
+  if not sock:connect("unix:" .. get_socket_file(instance_id)) then
+    return false
+  end
+
+  ngx.log(ngx.INFO, "Reattached to detached IRC session for instance_id ", instance_id)
+  request_events(sock)
+  store.set_socket(instance_id, sock)
+  return true
+end
+
 -- Spawns a new IRC client process unless already running for this instance
 function _M.start_client(nick, realname, server, port, channels, instance_id, sasl_secret)
   if not (nick and server and port and channels and instance_id) then
@@ -24,6 +135,13 @@ function _M.start_client(nick, realname, server, port, channels, instance_id, sa
     return true
   end
 
+  if env.use_detach() and attach_detached(instance_id) then
+    store.set_running(instance_id, true)
+    store.set_secret(instance_id, sasl_secret)
+    store.set_realname(instance_id, realname)
+    return true
+  end
+
   local socket_dir = env.var_dir() .. "/socket"
   local log_dir = env.log_dir() .. "/irc-client"
   local channels_str = ""
@@ -56,6 +174,33 @@ function _M.start_client(nick, realname, server, port, channels, instance_id, sa
     table.insert(args, "--sasl")
   end
 
+  -- The session stays up when the WebSocket goes away and replays what it missed
+  if env.use_detach() then
+    table.insert(args, "--detach-lines=" .. DETACH_LINES)
+  end
+
+  -- Daemon mode: ask the shared process to host the session instead of forking one
+  if env.use_daemon() then
+    local ok, err = ensure_daemon()
+    if not ok then
+      return nil, err
+    end
+
+    table.remove(args, 1)
+    local reply, req_err = daemon_request("create " .. table.concat(args, " "))
+    if not reply or not reply:match("^ok") then
+      ngx.log(ngx.ERR, "IRC client daemon refused session: ", reply or req_err)
+      return nil, reply or req_err
+    end
+
+    store.set_running(instance_id, true)
+    store.set_secret(instance_id, sasl_secret)
+    store.set_realname(instance_id, realname)
+
+    ngx.log(ngx.INFO, "IRC session created in daemon for instance_id ", instance_id)
+    return true
+  end
+
   local proc, err = pipe.spawn(args, {
     merge_stderr = true,
     detached = true,
@@ -96,6 +241,7 @@ function _M.connect(instance_id)
   end
 
   ngx.log(ngx.INFO, "Connected to IRC socket for instance_id ", instance_id)
+  request_events(sock)
   store.set_socket(instance_id, sock)
 
   return sock
@@ -145,24 +291,49 @@ function _M.receive(instance_id, wb)
   local realname     = store.get_realname(instance_id) or instance_id
 
   store.set_reader(instance_id, ngx.thread.spawn(function()
+    -- Raw lines until the session acknowledges /protocol events, framed events after that
+    local framed = false
+    local read_field = sock:receiveuntil(" ")
+
     while store.running(instance_id) do
-      local line, err = sock:receive("*l")
+      local event_type, line, err
+      if framed then
+        event_type, line, err = receive_event(sock, read_field)
+      else
+        line, err = sock:receive("*l")
+      end
+
+      if line and not framed and line == PROTOCOL_ACK then
+        framed = true
 
-      if line then
+      elseif line then
         -- SASL handshake authentication if enabled
         if use_sasl then
-          if line:match("^AUTHENTICATE%s*[:]?%+") then
+          local challenge
+          if framed then
+            challenge = event_type == "AUTHENTICATE" and cjson.decode(line).text == "+"
+          else
+            challenge = line:match("^AUTHENTICATE%s*[:]?%+")
+          end
+          if challenge then
             -- Server is asking for our PLAIN blob
             local raw = realname .. "\0" .. realname .. "\0" .. secret
             sock:send("/input AUTHENTICATE " .. ngx.encode_base64(raw) .. "\n")
           end
         else
           -- NickServ fallback for non-SASL
-          if line:match("%s376%s") or line:match("%s422%s") then
+          local motd_end
+          if framed then
+            motd_end = event_type == "376" or event_type == "422"
+          else
+            motd_end = line:match("%s376%s") or line:match("%s422%s")
+          end
+          if motd_end then
             sock:send("/input PRIVMSG NickServ :IDENTIFY " .. secret .. "\n")
           end
         end
 
+        -- Events go on as their JSON, raw lines as they are; the browser takes either
         local ok, send_err = wb:send_text(line)
         if not ok then
           ngx.log(ngx.INFO,
@@ -204,5 +375,6 @@ function _M.close(instance_id)
 end
 
 _M.get_socket_file = get_socket_file
+_M.get_daemon_socket_file = get_daemon_socket_file
 
 return _M
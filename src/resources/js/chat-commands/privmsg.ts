@@ -10,6 +10,9 @@ export const privmsgCommand: ChatCommandHandler = async ({ client, args, nick, i
 
     await client.msg(target, message);
 
+    // With echo-message the server sends it back, timestamped, like anyone else's
+    if (client.hasCap('echo-message')) return;
+
     inject(tabId, new IrcLine({
         id: nanoid(),
         timestamp: Date.now(),
@@ -31,7 +31,7 @@ export function useIrcClient(chat_token: string) {
         9667,
         (msg) => console.log(`[IRC] ${msg}`),
         (line) => {
-            const target = getTabKey(line);
+            const target = getTabKey(line, client?.nick);
             addLinesTo(target, [line]);
         },
         {
@@ -4,6 +4,7 @@ import { Whois } from './models/Whois';
 import { Channel } from './models/Channel';
 import type { IrcEventHandler, IrcClientOptions } from './types';
 import { parseIrcLine } from '@/lib/parseIrcLine';
+import { eventToIrcLine } from '@/lib/eventToIrcLine';
 
 export class IrcClient {
     private eventHandlers = new Map<string, IrcEventHandler[]>();
@@ -14,6 +15,8 @@ export class IrcClient {
     public nick: string = '';
     public users: Map<string, User> = new Map();
     public channels: Map<string, Channel> = new Map();
+    // IRCv3 capabilities the session negotiated, from `:client caps`
+    public caps: Set<string> = new Set();
 
     constructor(
         private readonly token: string,
@@ -34,8 +37,9 @@ export class IrcClient {
         };
 
         this.socket.onmessage = (event) => {
-            const raw = event.data;
-            const parsed = parseIrcLine(raw);
+            const raw: string = event.data;
+            // Framed events arrive as JSON, parsed once by the session; raw IRC lines never start with '{'
+            const parsed = raw.startsWith('{') ? eventToIrcLine(JSON.parse(raw)) : parseIrcLine(raw);
             this.handleLine(parsed);
         };
 
@@ -229,6 +233,10 @@ export class IrcClient {
         }
     }
 
+    hasCap(name: string): boolean {
+        return this.caps.has(name);
+    }
+
     isReady(): boolean {
         return this.ready;
     }
@@ -20,6 +20,7 @@ import { rplEndOfNamesHandler } from './handlers/rplEndOfNamesHandler';
 import { motdHandler } from './handlers/motdHandler';
 
 import { whoisHandler } from './handlers/whoisHandler';
+import { capsHandler } from './handlers/capsHandler';
 
 export function buildHandlers(): Record<string, IrcEventHandler[]> {
     return {
@@ -33,6 +34,7 @@ export function buildHandlers(): Record<string, IrcEventHandler[]> {
         [IRC_EVENT_KEYS.PRIVMSG]: [privmsgHandler],
         [IRC_EVENT_KEYS.WELCOME]: [welcomeHandler],
         [IRC_EVENT_KEYS.MODE]: [modeHandler],
+        [IRC_EVENT_KEYS.CLIENT_CAPS]: [capsHandler],
 
         //MOTD
         [IRC_EVENT_KEYS.MOTD_START]: [motdHandler],
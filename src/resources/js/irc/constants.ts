@@ -11,6 +11,9 @@ export const IRC_EVENT_KEYS = {
     NOTICE: 'NOTICE',
     WELCOME: '001',
 
+    // Session events from the client process (`:client <event> ...`)
+    CLIENT_CAPS: 'caps',
+
     // RPL replies
     RPL_NAMEREPLY: '353',
     RPL_ENDOFNAMES: '366',
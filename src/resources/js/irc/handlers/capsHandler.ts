@@ -0,0 +1,10 @@
+import type { IrcEventHandler } from '../types';
+
+/**
+ * Handles `:client caps :<capabilities>`, sent whenever the session's IRCv3 capabilities change.
+ */
+export const capsHandler: IrcEventHandler = (client, line) => {
+    if (line.prefix !== 'client') return;
+    const list = line.params[0] ?? '';
+    client.caps = new Set(list.split(' ').filter(Boolean));
+};
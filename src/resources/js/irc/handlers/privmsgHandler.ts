@@ -18,6 +18,9 @@ export const privmsgHandler: IrcEventHandler = async (client, line) => {
         return;
     }
 
+    // Our own message echoed back (echo-message): it is already in the target's tab
+    if (senderNick === client.nick) return;
+
     // Refresh WHOIS for target.
     await client.whois(senderNick);
 
@@ -0,0 +1,40 @@
+import { nanoid } from 'nanoid';
+import { IrcLine } from '@/types/IrcLine';
+
+// A framed event from the session (`/protocol events`), already parsed on the server side
+export interface IrcEvent {
+  seq: number;
+  type: string;
+  nick: string;
+  channel: string;
+  text: string;
+  prefix: string;
+  params: string[];
+  tags: Record<string, string>;
+}
+
+// Rebuilds the line's text for display; tags are kept on the IrcLine instead
+function toRaw(event: IrcEvent): string {
+  if (event.type === 'raw') return event.text;
+
+  const params = event.params.map((param, i) =>
+    i === event.params.length - 1 && (param === '' || param.includes(' ') || param.startsWith(':')) ? `:${param}` : param
+  );
+  return [event.prefix ? `:${event.prefix}` : '', event.type, ...params].filter(Boolean).join(' ');
+}
+
+export function eventToIrcLine(event: IrcEvent): IrcLine {
+  // server-time: when the server says it happened, which differs from now for history and replays
+  const serverTime = event.tags['time'] ? Date.parse(event.tags['time']) : NaN;
+  const timestamp = Number.isNaN(serverTime) ? Date.now() : serverTime;
+
+  return new IrcLine({
+    id: nanoid(),
+    timestamp,
+    raw: toRaw(event),
+    prefix: event.prefix || null,
+    command: event.type,
+    params: event.params,
+    tags: event.tags,
+  });
+}
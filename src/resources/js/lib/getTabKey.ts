@@ -1,6 +1,6 @@
 import type { IrcLine } from '@/types/IrcLine';
 
-export function getTabKey(line: IrcLine): string {
+export function getTabKey(line: IrcLine, selfNick?: string): string {
     const target = line.params[0];
 
     if (line.command === 'PRIVMSG') {
@@ -9,7 +9,8 @@ export function getTabKey(line: IrcLine): string {
         } else {
             // If prefix exists, it's incoming; otherwise it's outgoing, use param[0]
             const user = line.prefix?.split('!')[0] ?? target ?? 'unknown';
-            return `pm-${user}`;
+            // Our own message echoed back (echo-message) belongs with the person we sent it to
+            return `pm-${user === selfNick ? target : user}`;
         }
     }
 
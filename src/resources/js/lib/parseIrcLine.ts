@@ -1,20 +1,58 @@
 import { nanoid } from 'nanoid';
 import { IrcLine } from '@/types/IrcLine';
 
+// IRCv3 tag values escape ';', ' ', '\', CR and LF
+function unescapeTagValue(value: string): string {
+  return value.replace(/\\(.?)/g, (_, c: string) => {
+    switch (c) {
+      case ':': return ';';
+      case 's': return ' ';
+      case 'r': return '\r';
+      case 'n': return '\n';
+      default: return c;
+    }
+  });
+}
+
+function parseTags(tags: string): Record<string, string> {
+  const parsed: Record<string, string> = {};
+  for (const item of tags.split(';')) {
+    if (!item) continue;
+    const eq = item.indexOf('=');
+    if (eq === -1) {
+      parsed[item] = '';
+    } else {
+      parsed[item.slice(0, eq)] = unescapeTagValue(item.slice(eq + 1));
+    }
+  }
+  return parsed;
+}
+
 export function parseIrcLine(raw: string): IrcLine {
   let prefix: string | null = null;
   let command = '';
   let params: string[] = [];
+  let tags: Record<string, string> = {};
 
-  const timestamp = Date.now();
   let rest = raw;
 
-  if (raw.startsWith(':')) {
-    const idx = raw.indexOf(' ');
-    prefix = raw.slice(1, idx);
-    rest = raw.slice(idx + 1);
+  // @tag=value;tag2 :prefix COMMAND params
+  if (rest.startsWith('@')) {
+    const idx = rest.indexOf(' ');
+    tags = parseTags(idx === -1 ? rest.slice(1) : rest.slice(1, idx));
+    rest = idx === -1 ? '' : rest.slice(idx + 1).trimStart();
+  }
+
+  if (rest.startsWith(':')) {
+    const idx = rest.indexOf(' ');
+    prefix = idx === -1 ? rest.slice(1) : rest.slice(1, idx);
+    rest = idx === -1 ? '' : rest.slice(idx + 1);
   }
 
+  // server-time: when the server says it happened, which differs from now for history and replays
+  const serverTime = tags['time'] ? Date.parse(tags['time']) : NaN;
+  const timestamp = Number.isNaN(serverTime) ? Date.now() : serverTime;
+
   const tokens = rest.split(' ');
   command = tokens.shift() || '';
 
@@ -33,5 +71,6 @@ export function parseIrcLine(raw: string): IrcLine {
     prefix,
     command,
     params,
+    tags,
   });
 }
@@ -0,0 +1,69 @@
+#include "BatchCollector.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+static BatchCollector::Result add(BatchCollector &collector, const std::string &line)
+{
+	IrcMessage message;
+	parseIrcMessage(line, message);
+	return collector.add(message);
+}
+
+int main()
+{
+	using Result = BatchCollector::Result;
+
+	// A netsplit is held until it closes, then handed over whole, BATCH lines included
+	{
+		BatchCollector collector;
+		assert(add(collector, ":srv PRIVMSG #a :before") == Result::Unbatched);
+		assert(add(collector, ":srv BATCH +ns netsplit irc.a irc.b") == Result::Held);
+		assert(add(collector, "@batch=ns :alice!a@h QUIT :irc.a irc.b") == Result::Held);
+		assert(add(collector, "@batch=ns :bob!b@h QUIT :irc.a irc.b") == Result::Held);
+		assert(add(collector, "@batch=other :carol!c@h QUIT :bye") == Result::Unbatched); // unknown batch
+		assert(collector.openCount() == 1);
+		assert(add(collector, ":srv BATCH -ns") == Result::Ready);
+
+		const Batch &batch = collector.ready();
+		assert(batch.reference == "ns" && batch.type == "netsplit" && batch.closed);
+		assert(batch.params.size() == 2 && batch.params[1] == "irc.b");
+		assert(batch.lines.size() == 4 && batch.lines.front().ends_with("+ns netsplit irc.a irc.b"));
+		assert(batch.lines.back() == ":srv BATCH -ns");
+		collector.release();
+		assert(collector.openCount() == 0);
+		assert(add(collector, "@batch=ns :dave!d@h QUIT :late") == Result::Unbatched);
+	}
+
+	// Nested batches travel with the outermost one
+	{
+		BatchCollector collector;
+		assert(add(collector, ":srv BATCH +outer chathistory #a") == Result::Held);
+		assert(add(collector, "@batch=outer :srv BATCH +inner netjoin") == Result::Held);
+		assert(add(collector, "@batch=inner :alice!a@h JOIN #a") == Result::Held);
+		assert(add(collector, "@batch=outer :srv BATCH -inner") == Result::Held);
+		assert(add(collector, "@batch=outer :bob!b@h PRIVMSG #a :hi") == Result::Held);
+		assert(add(collector, ":srv BATCH -outer") == Result::Ready);
+		assert(collector.ready().type == "chathistory" && collector.ready().lines.size() == 6);
+		collector.release();
+		assert(collector.openCount() == 0);
+	}
+
+	// A batch that reaches the line limit is delivered in pieces, in order
+	{
+		BatchCollector collector(3);
+		assert(add(collector, ":srv BATCH +big chathistory #a") == Result::Held);
+		assert(add(collector, "@batch=big :a!a@h PRIVMSG #a :1") == Result::Held);
+		assert(add(collector, "@batch=big :a!a@h PRIVMSG #a :2") == Result::Ready);
+		assert(collector.ready().lines.size() == 3 && !collector.ready().closed);
+		collector.release();
+		assert(add(collector, "@batch=big :a!a@h PRIVMSG #a :3") == Result::Held);
+		assert(add(collector, ":srv BATCH -big") == Result::Ready);
+		assert(collector.ready().lines.size() == 2 && collector.ready().closed);
+		collector.release();
+		assert(collector.openCount() == 0);
+	}
+
+	std::cout << "BatchCollector tests passed\n";
+	return 0;
+}
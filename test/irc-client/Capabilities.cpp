@@ -0,0 +1,49 @@
+#include "Capabilities.hpp"
+#include <cassert>
+#include <iostream>
+
+int main()
+{
+	// Only wanted capabilities the server offers are requested, across a multi-line LS
+	{
+		Capabilities caps;
+		assert(caps.settled());
+		assert(!caps.offered("multi-prefix sasl=PLAIN,EXTERNAL away-notify", true));
+		assert(caps.offered("server-time batch message-tags", false));
+		assert(caps.requestList() == "message-tags server-time batch multi-prefix");
+
+		caps.requested();
+		assert(!caps.settled());
+		caps.acknowledged("message-tags server-time batch multi-prefix");
+		assert(caps.settled() && caps.isEnabled("batch") && !caps.isEnabled("echo-message"));
+		assert(caps.enabledList() == "batch message-tags multi-prefix server-time");
+		assert(caps.requestList().empty()); // nothing left to ask for
+
+		// "-name" in an ACK and CAP DEL turn a capability off
+		caps.acknowledged("-multi-prefix");
+		caps.withdrawn("batch");
+		assert(!caps.isEnabled("multi-prefix") && !caps.isEnabled("batch"));
+	}
+
+	// Extra capabilities are asked for only once, and a NAK enables nothing
+	{
+		Capabilities caps;
+		caps.want("sasl");
+		caps.want("sasl");
+		caps.offered("sasl echo-message userhost-in-names", false);
+		assert(caps.requestList() == "userhost-in-names echo-message sasl");
+		caps.requested();
+		caps.rejected("userhost-in-names echo-message sasl");
+		assert(caps.settled() && caps.enabledList().empty());
+	}
+
+	// A server with nothing we want: nothing to request, negotiation can end right away
+	{
+		Capabilities caps;
+		caps.offered("away-notify account-tag", false);
+		assert(caps.requestList().empty());
+	}
+
+	std::cout << "Capabilities tests passed\n";
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include "ChatHistory.hpp"
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <string>
+
+int main()
+{
+	std::string path = (std::filesystem::temp_directory_path() / "chat_history_test.history").string();
+	std::remove(path.c_str());
+
+	// No cursor: ask for the latest messages, capped by the server's CHATHISTORY limit
+	{
+		ChatHistory history({250, path});
+		history.load();
+		assert(history.enabled() && history.cursor("#a").empty());
+		assert(history.request("#a") == "CHATHISTORY LATEST #a * 250\n");
+		history.setServerLimit(100);
+		assert(history.request("#a") == "CHATHISTORY LATEST #a * 100\n");
+
+		// Cursors only move forward
+		history.observe("#a", "2024-05-01T10:00:00.000Z");
+		history.observe("#a", "2024-05-01T09:00:00.000Z");
+		history.observe("#b", "2024-05-02T00:00:00.000Z");
+		assert(history.cursor("#a") == "2024-05-01T10:00:00.000Z");
+		assert(history.request("#a") == "CHATHISTORY AFTER #a timestamp=2024-05-01T10:00:00.000Z 100\n");
+		assert(history.save());
+	}
+
+	// A restarted session picks up where the last one stopped
+	{
+		ChatHistory history({100, path});
+		history.load();
+		assert(history.cursor("#a") == "2024-05-01T10:00:00.000Z");
+		assert(history.cursor("#b") == "2024-05-02T00:00:00.000Z");
+		assert(history.save()); // nothing moved: nothing written
+	}
+
+	// Channels match under the casemapping; the file keeps the first spelling seen
+	{
+		std::remove(path.c_str());
+		ChatHistory history({100, path});
+		history.observe("#Foo[1]", "2024-05-03T00:00:00.000Z");
+		history.observe("#foo{1}", "2024-05-03T01:00:00.000Z");
+		assert(history.request("#FOO[1]") == "CHATHISTORY AFTER #FOO[1] timestamp=2024-05-03T01:00:00.000Z 100\n");
+		assert(history.save());
+
+		ChatHistory restarted({100, path});
+		restarted.load();
+		assert(restarted.cursor("#foo[1]") == "2024-05-03T01:00:00.000Z");
+		restarted.setCaseMapping(CaseMapping::Ascii);
+		assert(restarted.cursor("#foo{1}").empty() && restarted.cursor("#FOO[1]") == "2024-05-03T01:00:00.000Z");
+		restarted.observe("#foo{1}", "2024-05-03T02:00:00.000Z");
+		restarted.setCaseMapping(CaseMapping::Rfc1459); // both spellings are one channel again
+		assert(restarted.cursor("#Foo[1]") == "2024-05-03T02:00:00.000Z");
+		assert(restarted.save());
+
+		std::ifstream in(path);
+		std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		assert(contents == "#Foo[1] 2024-05-03T02:00:00.000Z\n");
+	}
+
+	// 0 turns catch-up off; without a path cursors stay in memory
+	{
+		ChatHistory history({0, ""});
+		assert(!history.enabled());
+		history.observe("#a", "2024-05-01T10:00:00.000Z");
+		assert(history.save() && history.cursor("#a") == "2024-05-01T10:00:00.000Z");
+	}
+
+	std::remove(path.c_str());
+	std::cout << "ChatHistory tests passed\n";
+	return 0;
+}
@@ -0,0 +1,60 @@
+#include "DetachBuffer.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+int main()
+{
+	// Lines are filed under the channel they belong to, wherever the numeric puts it
+	assert(DetachBuffer::target(":a!u@h PRIVMSG #Chan :hello") == "#chan");
+	assert(DetachBuffer::target(":a!u@h JOIN #c") == "#c");
+	assert(DetachBuffer::target(":a!u@h JOIN :#c") == "#c");
+	assert(DetachBuffer::target(":srv 366 me #c :End of /NAMES list.") == "#c");
+	assert(DetachBuffer::target(":srv 353 me = #c :alice bob") == "#c");
+	assert(DetachBuffer::target("@time=2026-01-01T00:00:00.000Z :a!u@h KICK &local b :bye") == "&local");
+	assert(DetachBuffer::target(":client history #c :2026-01-01T00:00:00.000Z") == "#c");
+	// Free text that happens to start with '#' is not a channel
+	assert(DetachBuffer::target(":a!u@h PRIVMSG me :#c is great").empty());
+	assert(DetachBuffer::target(":srv 372 me :- #c is our support channel").empty());
+	assert(DetachBuffer::target(":srv NOTICE * :*** Looking up your hostname").empty());
+	assert(DetachBuffer::target("").empty());
+
+	// Each channel is capped on its own; a busy one cannot push out a quiet one
+	{
+		DetachBuffer buffer(2);
+		buffer.add(":a!u@h PRIVMSG #quiet :one");
+		for (int i = 0; i < 5; ++i)
+			buffer.add(":a!u@h PRIVMSG #busy :" + std::to_string(i));
+		buffer.add(":srv NOTICE me :server");
+		buffer.add(":a!u@h PRIVMSG me :private");
+		buffer.add(":srv NOTICE me :server again");
+		assert(buffer.size() == 5 && buffer.targetCount() == 3 && buffer.dropped() == 4);
+
+		// Replayed in arrival order across channels
+		std::string out = "already queued\n";
+		assert(buffer.drain(out) == 5);
+		assert(out == "already queued\n"
+					  ":a!u@h PRIVMSG #quiet :one\n"
+					  ":a!u@h PRIVMSG #busy :3\n"
+					  ":a!u@h PRIVMSG #busy :4\n"
+					  ":a!u@h PRIVMSG me :private\n"
+					  ":srv NOTICE me :server again\n");
+
+		// Draining starts over
+		assert(buffer.size() == 0 && buffer.targetCount() == 0 && buffer.dropped() == 0);
+		out.clear();
+		assert(buffer.drain(out) == 0 && out.empty());
+	}
+
+	// Channel names are case-insensitive
+	{
+		DetachBuffer buffer(1);
+		buffer.add(":a!u@h PRIVMSG #C :upper");
+		buffer.add(":a!u@h PRIVMSG #c :lower");
+		std::string out;
+		assert(buffer.drain(out) == 1 && out == ":a!u@h PRIVMSG #c :lower\n");
+	}
+
+	std::cout << "DetachBuffer tests passed\n";
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "EventDispatcher.hpp"
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Recorder
+{
+	std::vector<std::string> calls;
+};
+
+using Dispatcher = BasicEventDispatcher<Recorder>;
+
+static IrcMessage parsed(std::string_view line)
+{
+	IrcMessage message;
+	bool ok = parseIrcMessage(line, message);
+	assert(ok);
+	return message;
+}
+
+int main()
+{
+	// Numerics and verbs route to their events only
+	{
+		Dispatcher dispatcher;
+		Recorder recorder;
+		dispatcher.define("WHOIS", {"311", "318"});
+		dispatcher.define("PRIVMSG", {"PRIVMSG"});
+		dispatcher.subscribe("WHOIS", [](Recorder &r, const IrcMessage &m)
+							 { r.calls.push_back("whois " + std::string(m.command)); });
+		dispatcher.subscribe("PRIVMSG", [](Recorder &r, const IrcMessage &)
+							 { r.calls.push_back("privmsg"); });
+
+		dispatcher.dispatch(recorder, parsed(":srv 311 me bob u h * :Bob"));
+		dispatcher.dispatch(recorder, parsed(":bob!u@h PRIVMSG #c :the 318 numeric"));
+		dispatcher.dispatch(recorder, parsed(":srv 312 me bob srv :info"));
+		dispatcher.dispatch(recorder, parsed(":srv 318 me bob :End"));
+		assert((recorder.calls == std::vector<std::string>{"whois 311", "privmsg", "whois 318"}));
+	}
+
+	// Several subscribers and several events on one trigger all fire, then wildcards
+	{
+		Dispatcher dispatcher;
+		Recorder recorder;
+		dispatcher.define("A", {"376"});
+		dispatcher.define("B", {"376", "422"});
+		dispatcher.subscribe("A", [](Recorder &r, const IrcMessage &)
+							 { r.calls.push_back("a1"); });
+		dispatcher.subscribe("A", [](Recorder &r, const IrcMessage &)
+							 { r.calls.push_back("a2"); });
+		dispatcher.subscribe("B", [](Recorder &r, const IrcMessage &)
+							 { r.calls.push_back("b"); });
+		dispatcher.subscribe("*", [](Recorder &r, const IrcMessage &)
+							 { r.calls.push_back("any"); });
+
+		dispatcher.dispatch(recorder, parsed(":srv 376 me :End of MOTD"));
+		assert((recorder.calls == std::vector<std::string>{"a1", "a2", "b", "any"}));
+
+		recorder.calls.clear();
+		dispatcher.dispatch(recorder, parsed("PING :x"));
+		assert((recorder.calls == std::vector<std::string>{"any"}));
+	}
+
+	// Guards veto after routing
+	{
+		Dispatcher dispatcher;
+		Recorder recorder;
+		bool joined = false;
+		dispatcher.define("MOTD_END", {"376"}, [&](const IrcMessage &)
+						  { return !joined; });
+		dispatcher.subscribe("MOTD_END", [&](Recorder &r, const IrcMessage &)
+							 { r.calls.push_back("join"); joined = true; });
+
+		dispatcher.dispatch(recorder, parsed(":srv 376 me :End"));
+		dispatcher.dispatch(recorder, parsed(":srv 376 me :End"));
+		assert(recorder.calls.size() == 1);
+	}
+
+	// Raw command subscriptions define themselves; unknown keys are rejected
+	{
+		Dispatcher dispatcher;
+		Recorder recorder;
+		dispatcher.subscribeCommand("JOIN", [](Recorder &r, const IrcMessage &m)
+									{ r.calls.emplace_back(m.param(0)); });
+		dispatcher.dispatch(recorder, parsed(":bob!u@h JOIN #c"));
+		assert((recorder.calls == std::vector<std::string>{"#c"}));
+
+		bool threw = false;
+		try
+		{
+			dispatcher.subscribe("NOPE", [](Recorder &, const IrcMessage &) {});
+		}
+		catch (const std::runtime_error &)
+		{
+			threw = true;
+		}
+		assert(threw);
+	}
+
+	std::cout << "EventDispatcher tests passed\n";
+	return 0;
+}
@@ -0,0 +1,73 @@
+#include "EventFrame.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+// The JSON of a single frame, after checking its header
+static std::string payload(const std::string &frame, std::string_view type)
+{
+	std::size_t space = frame.find(' ');
+	std::size_t length = std::stoul(frame.substr(0, space));
+	std::string_view rest = std::string_view(frame).substr(space + 1);
+	assert(rest.starts_with(type) && rest[type.size()] == ' ');
+	rest.remove_prefix(type.size() + 1);
+	assert(rest.size() == length + 1 && rest.back() == '\n');
+	return std::string(rest.substr(0, length));
+}
+
+int main()
+{
+	// A channel message, parsed once: routing fields up front, the full message behind them
+	{
+		std::string out;
+		appendEventFrame(out, "@time=2026-01-01T00:00:00.000Z;msgid=a\\sb :alice!u@h PRIVMSG #c :hi there", 7);
+		assert(payload(out, "PRIVMSG") ==
+			   "{\"seq\":7,\"type\":\"PRIVMSG\",\"nick\":\"alice\",\"channel\":\"#c\",\"text\":\"hi there\","
+			   "\"prefix\":\"alice!u@h\",\"params\":[\"#c\",\"hi there\"],"
+			   "\"tags\":{\"time\":\"2026-01-01T00:00:00.000Z\",\"msgid\":\"a b\"}}");
+	}
+
+	// Numerics, our own :client lines, and lines that do not parse
+	{
+		std::string out;
+		appendEventFrame(out, ":srv 376 me :End of MOTD", 1);
+		assert(payload(out, "376").starts_with("{\"seq\":1,\"type\":\"376\",\"nick\":\"srv\",\"channel\":\"\",\"text\":\"End of MOTD\""));
+
+		out.clear();
+		appendEventFrame(out, ":client replay #c 3", 0);
+		assert(payload(out, "replay") ==
+			   "{\"seq\":0,\"type\":\"replay\",\"nick\":\"client\",\"channel\":\"#c\",\"text\":\"3\",\"prefix\":\"client\","
+			   "\"params\":[\"#c\",\"3\"],\"tags\":{}}");
+
+		out.clear();
+		appendEventFrame(out, "", 2);
+		assert(payload(out, "raw") ==
+			   "{\"seq\":2,\"type\":\"raw\",\"nick\":\"\",\"channel\":\"\",\"text\":\"\",\"prefix\":\"\",\"params\":[],\"tags\":{}}");
+	}
+
+	// Nothing the JSON carries can end a frame early
+	{
+		std::string out;
+		appendEventFrame(out, "@+draft/x=a\\nb :a!u@h PRIVMSG #c :quote \" and \\ and \x01" "ACTION\x01", 3);
+		assert(out.find('\n') == out.size() - 1);
+		std::string json = payload(out, "PRIVMSG");
+		assert(json.find("\"+draft/x\":\"a\\nb\"") != std::string::npos);
+		assert(json.find("\"text\":\"quote \\\" and \\\\ and \\u0001ACTION\\u0001\"") != std::string::npos);
+	}
+
+	// Several lines at once; eirc/seq numbers them, anything else is 0
+	{
+		std::string out;
+		std::size_t count = appendEventFrames(out, ":client resume 5 6\n@eirc/seq=5;eirc/recv=x :a!u@h PRIVMSG #c :five\n"
+												   "@eirc/seq=6;eirc/recv=x :a!u@h JOIN #c\n");
+		assert(count == 3);
+		std::size_t first = out.find('\n') + 1, second = out.find('\n', first) + 1;
+		assert(payload(out.substr(0, first), "resume").starts_with("{\"seq\":0,"));
+		assert(payload(out.substr(first, second - first), "PRIVMSG").starts_with("{\"seq\":5,"));
+		assert(payload(out.substr(second), "JOIN").starts_with("{\"seq\":6,\"type\":\"JOIN\",\"nick\":\"a\",\"channel\":\"#c\""));
+		assert(appendEventFrames(out, "") == 0);
+	}
+
+	std::cout << "EventFrame tests passed\n";
+	return 0;
+}
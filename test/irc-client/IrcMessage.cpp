@@ -0,0 +1,101 @@
+#include "IrcMessage.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+int main()
+{
+	// Prefix split, numeric, middle and trailing parameters
+	{
+		IrcMessage m;
+		assert(parseIrcMessage(":irc.example.net 353 me = #chan :@op +voice plain", m));
+		assert(m.prefix == "irc.example.net");
+		assert(m.nick == "irc.example.net");
+		assert(m.command == "353");
+		assert(m.is(353));
+		assert(m.paramCount == 4);
+		assert(m.param(0) == "me");
+		assert(m.param(2) == "#chan");
+		assert(m.trailing() == "@op +voice plain");
+	}
+
+	// Full nick!user@host prefix and a verb command
+	{
+		IrcMessage m;
+		assert(parseIrcMessage(":alice!al@host.example PRIVMSG #chan :hello  there", m));
+		assert(m.nick == "alice");
+		assert(m.user == "al");
+		assert(m.host == "host.example");
+		assert(m.is("PRIVMSG"));
+		assert(m.numeric == 0);
+		assert(m.param(0) == "#chan");
+		assert(m.trailing() == "hello  there");
+	}
+
+	// Message text mentioning a numeric is not that numeric (the old " 353 " scan matched it)
+	{
+		IrcMessage m;
+		assert(parseIrcMessage(":bob!b@h PRIVMSG #chan :see 353 and 376 here", m));
+		assert(!m.is(353));
+		assert(!m.is(376));
+		assert(m.is("PRIVMSG"));
+	}
+
+	// No prefix, trailing only
+	{
+		IrcMessage m;
+		assert(parseIrcMessage("PING :irc.example.net", m));
+		assert(m.prefix.empty());
+		assert(m.is("PING"));
+		assert(m.trailing() == "irc.example.net");
+	}
+
+	// IRCv3 tags, including a valueless tag and escapes
+	{
+		IrcMessage m;
+		assert(parseIrcMessage("@time=2024-01-01T00:00:00.000Z;+draft/x;msg=a\\sb\\:c :n!u@h PRIVMSG #c :hi", m));
+		assert(m.tag("time") == "2024-01-01T00:00:00.000Z");
+		assert(m.tag("+draft/x").has_value() && m.tag("+draft/x")->empty());
+		assert(!m.tag("missing").has_value());
+		assert(unescapeTagValue(*m.tag("msg")) == "a b;c");
+		assert(m.nick == "n");
+		assert(m.trailing() == "hi");
+	}
+
+	// Lines without a command are rejected
+	{
+		IrcMessage m;
+		assert(!parseIrcMessage("", m));
+		assert(!parseIrcMessage(":prefix.only", m));
+		assert(!parseIrcMessage("@a=b", m));
+	}
+
+	// Parameters beyond the limit fold into the last slot
+	{
+		std::string line = "CMD";
+		for (int i = 0; i < 20; ++i)
+			line += " p" + std::to_string(i);
+		IrcMessage m;
+		assert(parseIrcMessage(line, m));
+		assert(m.paramCount == IrcMessage::maxParams);
+		assert(m.param(0) == "p0");
+	}
+
+	// The channel a message is about, wherever the command puts it; never free text
+	{
+		auto channelOf = [](std::string_view line)
+		{
+			IrcMessage m;
+			parseIrcMessage(line, m);
+			return std::string(channelParam(m));
+		};
+		assert(channelOf(":a!u@h PRIVMSG #c :hi") == "#c");
+		assert(channelOf(":a!u@h JOIN :#c") == "#c");
+		assert(channelOf(":srv 353 me = &c :alice bob") == "&c");
+		assert(channelOf(":a!u@h PRIVMSG me :#c is great").empty());
+		assert(channelOf(":srv 001 me :Welcome").empty());
+	}
+
+	std::cout << "IrcMessage tests passed\n";
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include "LineFramer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Feeds `input` through the framer in reads of at most `chunk` bytes and collects every line
+static std::vector<std::string> frame(LineFramer &framer, const std::string &input, std::size_t chunk)
+{
+	std::vector<std::string> lines;
+	std::size_t pos = 0;
+	while (pos < input.size())
+	{
+		auto space = framer.prepare();
+		std::size_t n = std::min({chunk, space.size(), input.size() - pos});
+		std::memcpy(space.data(), input.data() + pos, n);
+		framer.commit(n);
+		pos += n;
+
+		std::string_view line;
+		while (framer.next(line))
+			lines.emplace_back(line);
+	}
+	return lines;
+}
+
+int main()
+{
+	// CRLF and bare LF terminators, partial trailing line held back
+	{
+		LineFramer framer;
+		auto lines = frame(framer, "PING :a\r\n:srv 001 nick :hi\nPARTIAL", 7);
+		assert(lines.size() == 2);
+		assert(lines[0] == "PING :a");
+		assert(lines[1] == ":srv 001 nick :hi");
+		assert(framer.buffered() == 7);
+	}
+
+	// Lines wrapping around the end of a small ring come out intact
+	{
+		LineFramer framer(1024, 1024);
+		std::string input;
+		for (int i = 0; i < 500; ++i)
+			input += ":srv 353 me = #chan :nick" + std::to_string(i) + " @op +voice\r\n";
+		auto lines = frame(framer, input, 300);
+		assert(lines.size() == 500);
+		assert(lines[499] == ":srv 353 me = #chan :nick499 @op +voice");
+		assert(framer.capacity() == 1024);
+	}
+
+	// A line longer than the ring forces it to grow
+	{
+		LineFramer framer(1024, 1 << 16);
+		std::string big(5000, 'x');
+		auto lines = frame(framer, big + "\r\nnext\r\n", 1024);
+		assert(lines.size() == 2);
+		assert(lines[0] == big);
+		assert(lines[1] == "next");
+		assert(framer.capacity() >= 8192);
+	}
+
+	// A line longer than maxCapacity is dropped without losing the following lines
+	{
+		LineFramer framer(1024, 2048);
+		std::string huge(10000, 'y');
+		auto lines = frame(framer, "before\n" + huge + "\nafter\n", 512);
+		assert(lines.size() == 2);
+		assert(lines[0] == "before");
+		assert(lines[1] == "after");
+		assert(framer.droppedBytes() == huge.size() + 1);
+	}
+
+	// Read size adapts up under sustained full reads and back down when idle
+	{
+		LineFramer framer(1 << 16, 1 << 16);
+		std::size_t initial = framer.readSize();
+		for (int i = 0; i < 4; ++i)
+		{
+			auto space = framer.prepare();
+			std::memset(space.data(), '\n', space.size());
+			framer.commit(space.size());
+			std::string_view line;
+			while (framer.next(line))
+				;
+		}
+		assert(framer.readSize() > initial);
+		for (int i = 0; i < 8; ++i)
+		{
+			framer.prepare();
+			framer.commit(1);
+		}
+		assert(framer.readSize() == 512);
+	}
+
+	std::cout << "LineFramer_test passed." << std::endl;
+	return 0;
+}
@@ -0,0 +1,109 @@
+// Microbenchmark: lines/sec of the LineFramer against the string append/find/substr/erase loop
+// the server read path used before. Input is a synthetic NAMES flood delivered in socket-sized
+// reads. Run with: bazel run //test/irc-client:line_framer_bench
+#include "LineFramer.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static std::string makeFlood(std::size_t lines)
+{
+	std::string flood;
+	for (std::size_t i = 0; i < lines; ++i)
+	{
+		flood += ":irc.example.net 353 me = #big :";
+		for (int n = 0; n < 24; ++n)
+			flood += "@nick" + std::to_string(i * 24 + n) + " ";
+		flood += "\r\n";
+	}
+	return flood;
+}
+
+// Simulates a socket delivering `input` in reads of at most `size` bytes
+struct Source
+{
+	const std::string &input;
+	std::size_t pos = 0;
+	std::size_t read(char *dst, std::size_t size)
+	{
+		std::size_t n = std::min(size, input.size() - pos);
+		std::memcpy(dst, input.data() + pos, n);
+		pos += n;
+		return n;
+	}
+};
+
+static std::size_t legacyLoop(const std::string &input, std::size_t &checksum)
+{
+	Source source{input};
+	std::array<char, 1024> buf;
+	std::string buffer;
+	std::size_t lines = 0;
+
+	while (std::size_t len = source.read(buf.data(), buf.size()))
+	{
+		buffer.append(buf.data(), len);
+		std::size_t pos;
+		while ((pos = buffer.find('\n')) != std::string::npos)
+		{
+			std::string line = buffer.substr(0, pos);
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			buffer.erase(0, pos + 1);
+			checksum += line.size();
+			++lines;
+		}
+	}
+	return lines;
+}
+
+static std::size_t framerLoop(const std::string &input, std::size_t &checksum)
+{
+	Source source{input};
+	LineFramer framer;
+	std::size_t lines = 0;
+
+	while (true)
+	{
+		auto space = framer.prepare();
+		std::size_t len = source.read(space.data(), space.size());
+		if (len == 0)
+			break;
+		framer.commit(len);
+
+		std::string_view line;
+		while (framer.next(line))
+		{
+			checksum += line.size();
+			++lines;
+		}
+	}
+	return lines;
+}
+
+template <typename Fn>
+static void run(const char *name, const std::string &input, Fn fn)
+{
+	constexpr int rounds = 20;
+	std::size_t lines = 0, checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; ++i)
+		lines += fn(input, checksum);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << ": " << static_cast<std::size_t>(lines / elapsed.count()) << " lines/sec ("
+			  << lines << " lines, checksum " << checksum << ")" << std::endl;
+}
+
+int main()
+{
+	std::string flood = makeFlood(50000);
+	std::cout << "NAMES flood: " << flood.size() / 1024 << " KiB" << std::endl;
+
+	run("legacy string loop", flood, legacyLoop);
+	run("LineFramer        ", flood, framerLoop);
+	return 0;
+}
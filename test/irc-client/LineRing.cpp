@@ -0,0 +1,58 @@
+#include "LineRing.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+static std::string newest(const LineRing &ring, std::size_t count)
+{
+	std::array<std::string_view, 2> pieces;
+	ring.newest(count, pieces);
+	return std::string(pieces[0]) + std::string(pieces[1]);
+}
+
+int main()
+{
+	// The line limit pushes out the oldest
+	{
+		LineRing ring(2, 1024);
+		assert(ring.push("one") && ring.push("two") && ring.push("three"));
+		assert(ring.size() == 2);
+		assert(newest(ring, 0) == "two\nthree\n");
+		assert(newest(ring, 1) == "three\n");
+		assert(newest(ring, 5) == "two\nthree\n");
+	}
+
+	// So does the byte limit; lines wrap at the end of the arena and come back as two pieces
+	{
+		LineRing ring(100, 16);
+		assert(ring.push("aaaaa") && ring.push("bbbbb")); // 12 of 16 bytes
+		assert(ring.push("ccccc"));						  // pushes out "aaaaa", wraps
+		assert(ring.size() == 2);
+		std::array<std::string_view, 2> pieces;
+		assert(ring.newest(0, pieces) == 2);
+		assert(pieces[0] == "bbbbb\ncccc" && pieces[1] == "c\n");
+		assert(newest(ring, 1) == "ccccc\n");
+
+		// A line longer than the arena is refused and changes nothing
+		assert(!ring.push(std::string(16, 'x')));
+		assert(newest(ring, 0) == "bbbbb\nccccc\n");
+		assert(ring.memoryBytes() >= 16);
+	}
+
+	// Expiry and clearing
+	{
+		LineRing ring(10, 1024);
+		auto start = LineRing::Clock::now();
+		ring.push("old", start);
+		ring.push("new", start + std::chrono::seconds(10));
+		ring.expire(start + std::chrono::seconds(5));
+		assert(newest(ring, 0) == "new\n");
+		ring.clear();
+		assert(ring.size() == 0 && newest(ring, 0).empty());
+		ring.popOldest(); // harmless when empty
+		assert(ring.push("again") && newest(ring, 0) == "again\n");
+	}
+
+	std::cout << "LineRing tests passed\n";
+	return 0;
+}
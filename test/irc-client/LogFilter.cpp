@@ -0,0 +1,78 @@
+#include "LogFilter.hpp"
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+int main()
+{
+	// Defaults: everything at info, no sampling
+	{
+		LogFilter filter;
+		assert(filter.admit(LogCategory::RawIn, LogLevel::Info));
+		assert(!filter.admit(LogCategory::RawIn, LogLevel::Debug));
+		assert(filter.describe() == "general=info raw-in=info raw-out=info protocol=info auth=info ui=info");
+	}
+
+	// Specs apply left to right; a bare level sets every category
+	{
+		LogFilter filter;
+		filter.applyLevels("warn,auth=debug,raw-in=off");
+		assert(!filter.enabled(LogCategory::Protocol, LogLevel::Info));
+		assert(filter.enabled(LogCategory::Protocol, LogLevel::Warn));
+		assert(filter.enabled(LogCategory::Auth, LogLevel::Debug));
+		assert(!filter.enabled(LogCategory::RawIn, LogLevel::Error));
+	}
+
+	// A bad spec throws and leaves the settings untouched
+	{
+		LogFilter filter;
+		for (const char *spec : {"raw-in=loud", "nonsense=info", "info,raw-out=verbose"})
+		{
+			bool threw = false;
+			try
+			{
+				filter.applyLevels(spec);
+			}
+			catch (const std::invalid_argument &)
+			{
+				threw = true;
+			}
+			assert(threw);
+		}
+		assert(filter.describe() == "general=info raw-in=info raw-out=info protocol=info auth=info ui=info");
+
+		bool threw = false;
+		try
+		{
+			filter.applySampling("raw-in=lots");
+		}
+		catch (const std::invalid_argument &)
+		{
+			threw = true;
+		}
+		assert(threw);
+	}
+
+	// Sampling caps a category per second but never drops warnings
+	{
+		LogFilter filter;
+		filter.applySampling("raw-in=10");
+		int admitted = 0;
+		for (int i = 0; i < 1000; ++i)
+			admitted += filter.admit(LogCategory::RawIn, LogLevel::Info);
+		// A second boundary inside the loop can at most double the allowance
+		assert(admitted >= 10 && admitted <= 20);
+		assert(filter.takeSuppressed(LogCategory::RawIn) == static_cast<std::uint64_t>(1000 - admitted));
+		assert(filter.takeSuppressed(LogCategory::RawIn) == 0);
+
+		assert(filter.admit(LogCategory::RawIn, LogLevel::Warn));
+		assert(filter.admit(LogCategory::RawOut, LogLevel::Info));
+		assert(filter.describe().find("raw-in=info/10") != std::string::npos);
+
+		filter.applySampling("raw-in=0");
+		assert(filter.admit(LogCategory::RawIn, LogLevel::Info));
+	}
+
+	std::cout << "LogFilter tests passed\n";
+	return 0;
+}
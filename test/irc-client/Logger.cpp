@@ -0,0 +1,117 @@
+#include "Logger.hpp"
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string readFile(const std::string &path)
+{
+	std::ifstream in(path);
+	std::stringstream ss;
+	ss << in.rdbuf();
+	return ss.str();
+}
+
+int main()
+{
+	std::string path = (std::filesystem::temp_directory_path() / "logger_test.log").string();
+
+	// Messages from several producers all land, trimmed, once flushed
+	{
+		std::remove(path.c_str());
+		LoggerOptions options;
+		options.echoStdout = false;
+		Logger logger(path, options);
+
+		std::vector<std::thread> producers;
+		for (int t = 0; t < 4; ++t)
+			producers.emplace_back([&logger, t]
+								   {
+				for (int i = 0; i < 1000; ++i)
+					logger.log("t" + std::to_string(t) + " line " + std::to_string(i) + "\r\n"); });
+		for (auto &producer : producers)
+			producer.join();
+		logger.flush();
+
+		std::string contents = readFile(path);
+		std::size_t lines = 0;
+		for (char c : contents)
+			lines += c == '\n';
+		assert(lines == 4000);
+		assert(contents.find('\r') == std::string::npos);
+		assert(contents.find("t3 line 999\n") != std::string::npos);
+		// Group commit: far fewer batches than messages
+		assert(logger.batchesWritten() < 4000);
+	}
+
+	// Drop and count policies discard instead of blocking when the queue is full
+	{
+		std::remove(path.c_str());
+		LoggerOptions options;
+		options.echoStdout = false;
+		options.queueBytes = 64;
+		options.flushInterval = std::chrono::milliseconds(10000);
+		options.overflow = LogOverflow::Count;
+		Logger logger(path, options);
+
+		for (int i = 0; i < 10000; ++i)
+			logger.log("0123456789");
+		logger.flush();
+		assert(logger.droppedMessages() > 0);
+		logger.log("after");
+		logger.hardFlush();
+
+		std::string contents = readFile(path);
+		assert(contents.find(" messages dropped\n") != std::string::npos);
+		assert(contents.ends_with("after\n"));
+	}
+
+	// Destruction drains what is still pending
+	{
+		std::remove(path.c_str());
+		LoggerOptions options;
+		options.echoStdout = false;
+		options.flushInterval = std::chrono::milliseconds(10000);
+		{
+			Logger logger(path, options);
+			logger.log("last words");
+		}
+		assert(readFile(path) == "last words\n");
+	}
+
+	// Loggers share one writer thread, and each is still written on its own interval
+	{
+		std::remove(path.c_str());
+		std::string other = path + ".2";
+		std::remove(other.c_str());
+		LoggerOptions slow;
+		slow.echoStdout = false;
+		slow.flushInterval = std::chrono::milliseconds(10000);
+		LoggerOptions fast = slow;
+		fast.flushInterval = std::chrono::milliseconds(5);
+		{
+			Logger a(path, slow);
+			Logger b(other, fast);
+			assert(LogWriter::shared()->loggerCount() == 2);
+
+			a.log("slow");
+			b.log("fast");
+			for (int i = 0; i < 200 && readFile(other).empty(); ++i)
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			assert(readFile(other) == "fast\n" && readFile(path).empty());
+			a.flush();
+			assert(readFile(path) == "slow\n");
+		}
+		assert(LogWriter::shared()->loggerCount() == 0);
+		std::remove(other.c_str());
+	}
+
+	std::remove(path.c_str());
+	std::cout << "Logger tests passed\n";
+	return 0;
+}
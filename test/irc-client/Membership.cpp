@@ -0,0 +1,159 @@
+#include "Membership.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static MemberModes modesOf(const Membership &membership, std::string_view channel, std::string_view nick)
+{
+	const Channel *found = membership.find(channel);
+	assert(found);
+	auto it = found->members.find(membership.nicks().find(nick));
+	assert(it != found->members.end());
+	return it->second;
+}
+
+static void mode(Membership &membership, std::string_view channel, std::string_view modes,
+				 std::vector<std::string_view> args)
+{
+	membership.mode(channel, modes, args);
+}
+
+int main()
+{
+	// PREFIX parsing, rank and symbol order
+	{
+		PrefixModes prefixes;
+		assert(prefixes.fromPrefix('@') == 1 && prefixes.fromPrefix('+') == 2 && prefixes.fromPrefix('%') == 0);
+		assert(prefixes.parse("(qaohv)~&@%+"));
+		assert(prefixes.fromMode('h') == 8 && prefixes.fromPrefix('~') == 1);
+		assert(prefixes.symbols(prefixes.fromPrefix('+') | prefixes.fromPrefix('@')) == "@+");
+		assert(prefixes.rank(prefixes.fromPrefix('@') | prefixes.fromPrefix('+')) == 2);
+		assert(prefixes.rank(0) == PrefixModes::maxModes);
+		assert(!prefixes.parse("(ov)@") && !prefixes.parse("ov@+"));
+		assert(prefixes.fromMode('q') == 1); // unchanged by a malformed value
+	}
+
+	Membership membership;
+	membership.setSelf("me");
+
+	// Someone else's JOIN never starts tracking a channel
+	membership.join("#a", "alice");
+	assert(!membership.find("#a"));
+
+	// NAMES pages accumulate until 366; the previous list stays visible meanwhile
+	membership.join("#a", "me");
+	assert(membership.isMember("#a", "me"));
+	membership.namesReply("#a", "@me +alice");
+	membership.namesReply("#a", "bob @+carol dave!d@host");
+	assert(membership.find("#a")->members.size() == 1);
+	membership.namesEnd("#a");
+	assert(membership.find("#a")->members.size() == 5);
+	assert(modesOf(membership, "#a", "carol") == 3 && modesOf(membership, "#a", "alice") == 2);
+	assert(membership.isMember("#a", "dave") && membership.channelCount("bob") == 1);
+	// userhost-in-names fills in the user table
+	const User &dave = membership.nicks().user(membership.nicks().find("dave"));
+	assert(dave.username == "d" && dave.host == "host");
+
+	// A refresh replaces the list: members missing from it are dropped and unlinked
+	membership.namesReply("#a", "@me alice bob carol");
+	membership.join("#a", "erin"); // joined while the pages were arriving
+	membership.namesEnd("#a");
+	assert(!membership.isMember("#a", "dave") && membership.channelCount("dave") == 0);
+	assert(membership.isMember("#a", "erin") && modesOf(membership, "#a", "alice") == 0);
+
+	membership.join("#b", "me");
+	membership.namesReply("#b", "@me bob carol");
+	membership.namesEnd("#b");
+	assert(membership.channelCount("bob") == 2);
+
+	// MODE: prefix modes change the member; other modes consume their parameters
+	membership.setChannelModes("beI,k,l,imnpst");
+	mode(membership, "#a", "+bov-l", {"*!*@spam", "alice", "bob"});
+	assert(modesOf(membership, "#a", "alice") == 1 && modesOf(membership, "#a", "bob") == 2);
+	mode(membership, "#a", "+lk-o", {"10", "key", "alice"});
+	assert(modesOf(membership, "#a", "alice") == 0);
+	mode(membership, "#a", "+o", {}); // missing parameter: ignored
+	assert(modesOf(membership, "#b", "bob") == 0);
+
+	// Topics are kept for tracked channels only
+	assert(membership.setTopic("#a", "welcome") && membership.find("#a")->topic == "welcome");
+	assert(membership.setTopic("#a", "") && membership.find("#a")->topic.empty());
+	assert(!membership.setTopic("#elsewhere", "x") && !membership.find("#elsewhere"));
+
+	// NICK follows every shared channel, keeping modes; QUIT leaves all of them
+	std::vector<std::string> touched;
+	membership.rename("bob", "robert", touched);
+	assert(touched.size() == 2);
+	assert(!membership.isMember("#a", "bob") && modesOf(membership, "#a", "robert") == 2);
+	assert(membership.channelCount("bob") == 0 && membership.channelCount("robert") == 2);
+	membership.rename("me", "me2", touched);
+	assert(membership.self() == "me2" && modesOf(membership, "#b", "me2") == 1);
+
+	touched.clear();
+	membership.quit("carol", touched);
+	assert(touched.size() == 2 && !membership.isMember("#a", "carol") && !membership.isMember("#b", "carol"));
+	assert(membership.channelCount("carol") == 0);
+
+	// PART and KICK
+	membership.part("#a", "robert");
+	assert(!membership.isMember("#a", "robert") && membership.channelCount("robert") == 1);
+	membership.part("#b", "robert"); // a KICK is the same change
+	assert(membership.channelCount("robert") == 0);
+
+	// Our own PART forgets the channel and everything it linked
+	membership.part("#a", "me2");
+	assert(!membership.find("#a") && membership.channelCount("erin") == 0 && membership.channels().size() == 1);
+
+	// Users nobody references any more are reclaimed; only #b's members are left
+	const NickTable &nicks = membership.nicks();
+	assert(nicks.size() == 1 && nicks.find("me2") != noNick && nicks.find("erin") == noNick);
+	assert(nicks.references(nicks.find("me2")) == 1);
+
+	// Nicks compare under the casemapping: rfc1459 by default
+	membership.join("#b", "Dan[1]");
+	assert(membership.isMember("#b", "dan{1}") && membership.channelCount("DAN[1]") == 1);
+	membership.rename("dan{1}", "DAN[1]", touched); // case-only change keeps the same user
+	assert(nicks.nick(nicks.find("dan[1]")) == "DAN[1]" && modesOf(membership, "#b", "Dan{1}") == 0);
+	membership.setCaseMapping("ascii");
+	assert(membership.isMember("#b", "dan[1]") && !membership.isMember("#b", "dan{1}"));
+	membership.part("#b", "DAN[1]");
+	assert(nicks.size() == 1);
+
+	// A NICK onto a nick we still track: the stale holder's memberships go, and the renamed user
+	// keeps its own modes and details rather than inheriting the stale ones
+	membership.join("#c", "me2");
+	membership.namesReply("#c", "@me2 @y!stale@old");
+	membership.namesEnd("#c");
+	membership.join("#b", "x");
+	membership.join("#b", "y");
+	mode(membership, "#b", "+v", {"x"});
+	NickId renamedId = nicks.find("x");
+	touched.clear();
+	membership.rename("x", "y", touched);
+	assert(touched.size() == 3); // the stale holder's #b and #c, then x's #b
+	assert(!membership.isMember("#c", "y") && membership.isMember("#b", "y") && !membership.isMember("#b", "x"));
+	assert(nicks.find("y") == renamedId && nicks.size() == 2 && membership.channelCount("y") == 1);
+	assert(modesOf(membership, "#b", "y") == 2 && nicks.user(renamedId).username.empty());
+	membership.part("#c", "me2");
+	assert(nicks.size() == 2);
+
+	// Channel names compare under the casemapping too; the first spelling seen is kept for display
+	membership.join("#Foo[1]", "me2");
+	membership.namesReply("#foo[1]", "@me2 zed");
+	membership.namesEnd("#FOO[1]");
+	assert(membership.isMember("#foo[1]", "zed") && membership.find("#FOO[1]")->name == "#Foo[1]");
+	mode(membership, "#fOO[1]", "+v", {"zed"});
+	assert(modesOf(membership, "#Foo[1]", "zed") == 2 && membership.setTopic("#FoO[1]", "hi"));
+	assert(!membership.find("#foo{1}")); // ascii: brackets are distinct
+	membership.setCaseMapping("rfc1459");
+	assert(membership.find("#foo{1}") && membership.find("#foo{1}")->topic == "hi");
+	membership.part("#FOO{1}", "zed");
+	assert(!membership.isMember("#foo[1]", "zed") && membership.channelCount("zed") == 0);
+	membership.part("#foo{1}", "me2");
+	assert(!membership.find("#Foo[1]") && membership.channels().size() == 1);
+
+	std::cout << "Membership tests passed\n";
+	return 0;
+}
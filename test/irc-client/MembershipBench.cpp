@@ -0,0 +1,122 @@
+// Microbenchmark: cost of membership changes on a 50k-member channel. The channel is filled from
+// RPL_NAMREPLY pages the way a server sends them, then JOIN/PART/NICK/MODE/QUIT churn is timed per
+// operation; with hashed members none of them should grow with the channel. The same changes are
+// then timed with a snapshot published after each, as a session does after every burst.
+// Run with: bazel run //test/irc-client:membership_bench
+#include "Membership.hpp"
+#include "SessionState.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::size_t members = 50000;
+static constexpr std::size_t perPage = 24;
+static constexpr std::size_t ops = 200000;
+
+template <typename Fn>
+static void run(const char *name, std::size_t count, Fn fn)
+{
+	auto start = Clock::now();
+	for (std::size_t i = 0; i < count; ++i)
+		fn(i);
+	std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+	std::cout << name << ": " << static_cast<std::size_t>(elapsed.count() / count) << " ns/op (" << count
+			  << " ops)" << std::endl;
+}
+
+int main()
+{
+	Membership membership;
+	membership.setSelf("me");
+	membership.join("#big", "me");
+	membership.join("#small", "me");
+
+	std::vector<std::string> pages;
+	for (std::size_t i = 0; i < members; i += perPage)
+	{
+		std::string page;
+		for (std::size_t n = i; n < std::min(i + perPage, members); ++n)
+			page += (n % 10 == 0 ? "@nick" : "nick") + std::to_string(n) + " ";
+		pages.push_back(std::move(page));
+	}
+
+	auto start = Clock::now();
+	for (const std::string &page : pages)
+		membership.namesReply("#big", page);
+	membership.namesEnd("#big");
+	std::chrono::duration<double, std::milli> filled = Clock::now() - start;
+	std::cout << "NAMES: " << membership.find("#big")->members.size() << " members from " << pages.size()
+			  << " pages in " << filled.count() << " ms" << std::endl;
+
+	std::vector<std::string> nicks;
+	for (std::size_t i = 0; i < ops; ++i)
+		nicks.push_back("guest" + std::to_string(i));
+
+	run("JOIN ", ops, [&](std::size_t i)
+		{ membership.join("#big", nicks[i]); });
+	run("MODE ", ops, [&](std::size_t i)
+		{
+			std::string_view args[] = {nicks[i]};
+			membership.mode("#big", "+o", args); });
+
+	std::vector<std::string> touched;
+	run("NICK ", ops, [&](std::size_t i)
+		{
+			touched.clear();
+			membership.rename(nicks[i], nicks[i] + "_", touched);
+			nicks[i] += '_'; });
+	run("PART ", ops / 2, [&](std::size_t i)
+		{ membership.part("#big", nicks[i]); });
+	run("QUIT ", ops / 2, [&](std::size_t i)
+		{
+			touched.clear();
+			membership.quit(nicks[ops / 2 + i], touched); });
+
+	std::cout << "#big: " << membership.find("#big")->members.size() << " members" << std::endl;
+
+	// Publishing: the first snapshot builds every member; after that a change costs its own nodes
+	SessionState state;
+	start = Clock::now();
+	state.markChannel("#big");
+	state.publish(membership);
+	std::chrono::duration<double, std::milli> built = Clock::now() - start;
+	std::cout << "first publish: " << state.snapshot()->channels.at("#big")->members.size() << " members in "
+			  << built.count() << " ms" << std::endl;
+
+	const NickTable &table = membership.nicks();
+	std::vector<std::string> guests;
+	for (std::size_t i = 0; i < ops / 10; ++i)
+		guests.push_back("visitor" + std::to_string(i));
+
+	run("JOIN  + publish", guests.size(), [&](std::size_t i)
+		{
+			membership.join("#big", guests[i]);
+			state.markMember("#big", table.find(guests[i]));
+			state.publish(membership); });
+	run("MODE  + publish", guests.size(), [&](std::size_t i)
+		{
+			std::string_view args[] = {guests[i]};
+			membership.mode("#big", "+v", args);
+			state.markMember("#big", table.find(guests[i]));
+			state.publish(membership); });
+	run("TOPIC + publish", guests.size(), [&](std::size_t i)
+		{
+			membership.setTopic("#big", guests[i]);
+			state.markTopic("#big");
+			state.publish(membership); });
+	run("PART  + publish", guests.size(), [&](std::size_t i)
+		{
+			NickId id = table.find(guests[i]);
+			membership.part("#big", guests[i]);
+			state.markMember("#big", id);
+			state.publish(membership); });
+	run("full recheck", 20, [&](std::size_t)
+		{
+			state.markChannel("#big");
+			state.publish(membership); });
+	return 0;
+}
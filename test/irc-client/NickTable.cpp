@@ -0,0 +1,89 @@
+#include "NickTable.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+int main()
+{
+	// CASEMAPPING values and folding
+	{
+		CaseMapping mapping;
+		assert(NickTable::parseCaseMapping("strict-rfc1459", mapping) && mapping == CaseMapping::StrictRfc1459);
+		assert(!NickTable::parseCaseMapping("rfc7613", mapping) && mapping == CaseMapping::StrictRfc1459);
+
+		NickTable rfc;
+		assert(rfc.equal("Foo[]\\~", "foo{}|^") && !rfc.equal("foo", "fo"));
+		NickTable strict(CaseMapping::StrictRfc1459);
+		assert(strict.equal("A[", "a{") && !strict.equal("~", "^"));
+		NickTable ascii(CaseMapping::Ascii);
+		assert(ascii.equal("ABC", "abc") && !ascii.equal("[", "{"));
+	}
+
+	// One entry per user in any case; ids are stable and reused once reclaimed
+	{
+		NickTable nicks;
+		NickId foo = nicks.acquire("Foo");
+		assert(nicks.acquire("fOO") == foo && nicks.references(foo) == 2 && nicks.size() == 1);
+		assert(nicks.find("FOO") == foo && nicks.nick(foo) == "Foo" && nicks.user(foo).nick == "Foo");
+		assert(!nicks.release(foo) && nicks.find("foo") == foo);
+		assert(nicks.release(foo) && nicks.find("foo") == noNick && nicks.size() == 0);
+		NickId bar = nicks.acquire("bar");
+		assert(bar == foo && nicks.nick(bar) == "bar" && nicks.user(bar).nick == "bar");
+	}
+
+	// Rename keeps the id; taking a nick someone else holds makes that one unfindable
+	{
+		NickTable nicks;
+		NickId alice = nicks.acquire("alice");
+		NickId bob = nicks.acquire("bob");
+		nicks.rename(alice, "Alice");
+		assert(nicks.find("alice") == alice && nicks.nick(alice) == "Alice");
+		nicks.rename(alice, "carol");
+		assert(nicks.find("alice") == noNick && nicks.find("CAROL") == alice);
+		nicks.rename(alice, "bob");
+		assert(nicks.find("bob") == alice && nicks.nick(bob) == "bob" && nicks.size() == 2);
+		assert(nicks.release(bob) && nicks.find("bob") == alice && nicks.size() == 1);
+	}
+
+	// A casemapping change reindexes; entries that now collide stay separate
+	{
+		NickTable nicks(CaseMapping::Ascii);
+		NickId square = nicks.acquire("a[");
+		NickId curly = nicks.acquire("a{");
+		nicks.setCaseMapping(CaseMapping::Rfc1459);
+		assert(nicks.find("A{") == std::min(square, curly) && nicks.size() == 2);
+		assert(nicks.release(std::min(square, curly)) && nicks.find("a[") == noNick);
+		assert(nicks.release(std::max(square, curly)) && nicks.size() == 0);
+	}
+
+	// Churn against a reference map: backward-shift deletion must keep every probe run intact
+	{
+		NickTable nicks;
+		std::unordered_map<std::string, NickId> reference;
+		std::mt19937 rng(42);
+		for (int i = 0; i < 200000; ++i)
+		{
+			std::string nick = "n" + std::to_string(rng() % 5000);
+			auto it = reference.find(nick);
+			if (it == reference.end())
+			{
+				assert(nicks.find(nick) == noNick);
+				reference.emplace(nick, nicks.acquire(nick));
+			}
+			else
+			{
+				assert(nicks.find(nick) == it->second);
+				assert(nicks.release(it->second));
+				reference.erase(it);
+			}
+		}
+		assert(nicks.size() == reference.size());
+		for (const auto &[nick, id] : reference)
+			assert(nicks.find(nick) == id && nicks.nick(id) == nick);
+	}
+
+	std::cout << "NickTable tests passed\n";
+	return 0;
+}
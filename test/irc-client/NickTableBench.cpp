@@ -0,0 +1,122 @@
+// Benchmark: memory held by the user table over a simulated 24-hour replay of a busy channel,
+// the interned NickTable (through Membership, as a session uses it) against the std::map keyed
+// by raw nick that the session used before, which never forgot a nick and kept one entry per
+// spelling. Also times nick lookups in both at the end of the day.
+// Run with: bazel run //test/irc-client:nick_table_bench
+#include "Membership.hpp"
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr int seconds = 24 * 60 * 60;
+static constexpr int eventsPerSecond = 20;
+static constexpr std::size_t resident = 2000; // regulars who stay all day
+
+// Approximate footprint of one std::map<std::string, User> node: tree links and color, the key,
+// the value, and out-of-line storage for both strings
+static std::size_t legacyBytes(const std::map<std::string, User> &users)
+{
+	std::size_t bytes = 0;
+	for (const auto &[key, user] : users)
+	{
+		bytes += 4 * sizeof(void *) + sizeof(key) + sizeof(user);
+		for (const std::string *text : {&key, &user.nick})
+		{
+			if (text->capacity() > std::string().capacity())
+				bytes += text->capacity() + 1;
+		}
+	}
+	return bytes;
+}
+
+template <typename Fn>
+static double nsPerLookup(const std::vector<std::string> &probe, Fn fn)
+{
+	std::size_t found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < 20; ++round)
+	{
+		for (const std::string &nick : probe)
+			found += fn(nick);
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return found ? elapsed.count() / double(probe.size() * 20) : 0.0;
+}
+
+int main()
+{
+	std::mt19937 rng(2024);
+	Membership membership;
+	std::map<std::string, User> legacy;
+	std::vector<std::string> present; // nicks currently in the channel
+	std::vector<std::string> touched;
+	std::uint64_t nextGuest = 0;
+
+	auto seen = [&](const std::string &nick)
+	{ legacy.try_emplace(nick).first->second.nick = nick; };
+
+	membership.setSelf("me");
+	membership.join("#lobby", "me");
+	for (std::size_t i = 0; i < resident; ++i)
+	{
+		present.push_back("regular" + std::to_string(i));
+		membership.join("#lobby", present.back());
+		seen(present.back());
+	}
+
+	for (int second = 0; second < seconds; ++second)
+	{
+		for (int e = 0; e < eventsPerSecond; ++e)
+		{
+			std::uint32_t roll = rng() % 100;
+			if (roll < 40 || present.size() <= resident)
+			{
+				// Web chat guests get a fresh nick every visit
+				present.push_back("Guest" + std::to_string(nextGuest++));
+				membership.join("#lobby", present.back());
+				seen(present.back());
+				continue;
+			}
+
+			std::size_t index = resident + rng() % (present.size() - resident);
+			std::string &nick = present[index];
+			if (roll < 80)
+			{
+				if (roll < 60)
+					membership.part("#lobby", nick);
+				else
+					membership.quit(nick, touched);
+				nick = std::move(present.back());
+				present.pop_back();
+			}
+			else
+			{
+				// Some nick changes only differ in case, which the raw map stores twice
+				std::string to = roll < 90 ? nick + "_" : nick;
+				to[0] = static_cast<char>(to[0] ^ 0x20);
+				membership.rename(nick, to, touched);
+				seen(to);
+				nick = std::move(to);
+			}
+			touched.clear();
+		}
+	}
+
+	const NickTable &nicks = membership.nicks();
+	std::cout << "replayed " << seconds << " s at " << eventsPerSecond << " events/s, " << present.size()
+			  << " in channel at the end" << std::endl;
+	std::cout << "std::map: " << legacy.size() << " entries, ~" << legacyBytes(legacy) / 1024 << " KiB" << std::endl;
+	std::cout << "NickTable: " << nicks.size() << " entries, ~" << nicks.memoryBytes() / 1024 << " KiB" << std::endl;
+
+	std::vector<std::string> probe(present.begin(), present.begin() + std::min<std::size_t>(present.size(), 10000));
+	std::cout << "lookup std::map: " << nsPerLookup(probe, [&](const std::string &nick)
+												 { return legacy.contains(nick); })
+			  << " ns, NickTable: " << nsPerLookup(probe, [&](const std::string &nick)
+												 { return nicks.find(nick) != noNick; })
+			  << " ns" << std::endl;
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include "OutboundQueue.hpp"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std::chrono_literals;
+
+int main()
+{
+	using Clock = OutboundQueue::Clock;
+	const Clock::time_point t0 = Clock::now();
+
+	// Classification is by command, case-insensitive
+	assert(OutboundQueue::classify("PONG :irc.example") == OutboundClass::Keepalive);
+	assert(OutboundQueue::classify("cap req :sasl") == OutboundClass::Registration);
+	assert(OutboundQueue::classify("AUTHENTICATE +") == OutboundClass::Registration);
+	assert(OutboundQueue::classify("PRIVMSG #c :hi") == OutboundClass::Chat);
+	assert(OutboundQueue::classify("JOIN #c") == OutboundClass::Other);
+
+	// A paste: the burst goes out at once, in a single take, and the rest waits for tokens
+	{
+		OutboundQueue queue({5, 2000ms});
+		for (int i = 0; i < 8; ++i)
+			queue.push("PRIVMSG #c :line " + std::to_string(i), t0);
+		std::string out;
+		assert(queue.take(out, t0) == 5);
+		assert(out.starts_with("PRIVMSG #c :line 0\nPRIVMSG #c :line 1\n") && out.ends_with("line 4\n"));
+		assert(queue.size() == 3);
+		assert(queue.nextReady(t0) == t0 + 2000ms);
+
+		// Priority traffic is never held back by the bucket and goes ahead of what is waiting
+		queue.push("PONG :srv", t0 + 1s);
+		out.clear();
+		assert(queue.take(out, t0 + 1s) == 1);
+		assert(out == "PONG :srv\n");
+
+		out.clear();
+		assert(queue.take(out, t0 + 2s) == 1);
+		assert(out == "PRIVMSG #c :line 5\n");
+		assert(queue.latency(OutboundClass::Chat).messages == 6);
+		assert(queue.latency(OutboundClass::Chat).max == 2s);
+		assert(queue.latency(OutboundClass::Keepalive).max == 0s);
+
+		// Closing flushes everything regardless of the bucket
+		out.clear();
+		assert(queue.take(out, t0 + 2s, true) == 2);
+		assert(queue.empty() && queue.nextReady(t0 + 2s) == Clock::time_point::max());
+	}
+
+	// Multi-line text is split into lines; the bucket refills up to the burst and no further
+	{
+		OutboundQueue queue({2, 1000ms});
+		queue.push("NICK a\nUSER a 0 * :a\nJOIN #x\nJOIN #y\nJOIN #z", t0);
+		std::string out;
+		assert(queue.take(out, t0) == 4); // NICK and USER are priority, two JOINs from the bucket
+		assert(out == "NICK a\nUSER a 0 * :a\nJOIN #x\nJOIN #y\n");
+		out.clear();
+		assert(queue.take(out, t0 + 10s) == 1);
+		for (int i = 0; i < 3; ++i)
+			queue.push("JOIN #more", t0 + 10s);
+		out.clear();
+		assert(queue.take(out, t0 + 10s) == 1); // one token left of the refilled two
+	}
+
+	// Pacing off: everything goes at once
+	{
+		OutboundQueue queue({0, 0ms});
+		for (int i = 0; i < 100; ++i)
+			queue.push("PRIVMSG #c :x\n", t0);
+		std::string out;
+		assert(queue.take(out, t0) == 100);
+		assert(queue.describe().find("chat n=100 avg_ms=0 max_ms=0") != std::string::npos);
+	}
+
+	std::cout << "OutboundQueue tests passed\n";
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "Scrollback.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+// Everything last() hands back, joined
+static std::string replay(Scrollback &scrollback, std::string_view buffer, std::size_t count,
+						  Scrollback::Clock::time_point now = Scrollback::Clock::now())
+{
+	std::array<std::string_view, 2> pieces;
+	scrollback.last(buffer, count, pieces, now);
+	return std::string(pieces[0]) + std::string(pieces[1]);
+}
+
+int main()
+{
+	// Lines are filed under their channel, the other side of a query, or the server buffer
+	{
+		Scrollback scrollback;
+		scrollback.add(":srv 001 Me :Welcome");
+		assert(scrollback.bufferOf(":a!u@h PRIVMSG #Chan :hi") == "#chan");
+		assert(scrollback.bufferOf(":Alice!u@h PRIVMSG me :hi") == "alice");
+		assert(scrollback.bufferOf(":me!u@h PRIVMSG Bob :hi") == "bob"); // our own, echoed
+		assert(scrollback.bufferOf(":srv NOTICE me :*** hello") == "*");
+		assert(scrollback.bufferOf(":srv 372 me :- motd") == "*");
+
+		// Our nick is followed through NICK changes
+		scrollback.add(":me!u@h NICK :other");
+		assert(scrollback.bufferOf(":other!u@h PRIVMSG bob :hi") == "bob");
+		assert(scrollback.bufferOf(":me!u@h PRIVMSG bob :hi") == "me");
+	}
+
+	// The newest N lines, oldest first; 0 means all of them
+	{
+		Scrollback scrollback;
+		for (int i = 0; i < 5; ++i)
+			scrollback.add(":a!u@h PRIVMSG #c :" + std::to_string(i));
+		scrollback.add(":a!u@h PRIVMSG #other :x");
+		assert(replay(scrollback, "#C", 2) == ":a!u@h PRIVMSG #c :3\n:a!u@h PRIVMSG #c :4\n");
+		assert(replay(scrollback, "#c", 0).starts_with(":a!u@h PRIVMSG #c :0\n"));
+		assert(replay(scrollback, "#c", 100) == replay(scrollback, "#c", 0));
+		assert(replay(scrollback, "#nowhere", 5).empty());
+	}
+
+	// The line limit pushes out the oldest
+	{
+		ScrollbackOptions options;
+		options.lines = 3;
+		Scrollback scrollback(options);
+		for (int i = 0; i < 10; ++i)
+			scrollback.add(":a!u@h PRIVMSG #c :" + std::to_string(i));
+		assert(replay(scrollback, "#c", 0) == ":a!u@h PRIVMSG #c :7\n:a!u@h PRIVMSG #c :8\n:a!u@h PRIVMSG #c :9\n");
+	}
+
+	// The byte limit too; lines wrap around the end of the arena and come back in two pieces
+	{
+		ScrollbackOptions options;
+		options.bytes = 64;
+		Scrollback scrollback(options);
+		std::string expected;
+		bool wrapped = false;
+		for (int i = 0; i < 50; ++i)
+		{
+			std::string line = ":a!u@h PRIVMSG #c :" + std::to_string(i);
+			scrollback.add(line);
+			expected = expected + line + "\n";
+			while (expected.size() > 64)
+				expected.erase(0, expected.find('\n') + 1);
+			assert(replay(scrollback, "#c", 0) == expected);
+
+			std::array<std::string_view, 2> pieces;
+			scrollback.last("#c", 0, pieces);
+			wrapped = wrapped || !pieces[1].empty();
+		}
+		assert(wrapped);
+
+		// A line that could never fit is not kept
+		scrollback.add(":a!u@h PRIVMSG #c :" + std::string(100, 'x'));
+		assert(replay(scrollback, "#c", 0) == expected);
+	}
+
+	// Lines older than the age limit are gone
+	{
+		ScrollbackOptions options;
+		options.maxAge = std::chrono::seconds(60);
+		Scrollback scrollback(options);
+		auto start = Scrollback::Clock::now();
+		scrollback.add(":a!u@h PRIVMSG #c :old", start);
+		scrollback.add(":a!u@h PRIVMSG #c :new", start + std::chrono::seconds(50));
+		assert(replay(scrollback, "#c", 0, start + std::chrono::seconds(70)) == ":a!u@h PRIVMSG #c :new\n");
+		assert(replay(scrollback, "#c", 0, start + std::chrono::seconds(120)).empty());
+	}
+
+	// The number of buffers is bounded: the one written least recently makes room
+	{
+		ScrollbackOptions options;
+		options.buffers = 2;
+		options.lines = 4;
+		options.bytes = 256;
+		Scrollback scrollback(options);
+		scrollback.add(":a!u@h PRIVMSG #a :1");
+		scrollback.add(":a!u@h PRIVMSG #b :1");
+		scrollback.add(":a!u@h PRIVMSG #a :2");
+		scrollback.add(":a!u@h PRIVMSG #c :1");
+		assert(scrollback.bufferCount() == 2);
+		assert(replay(scrollback, "#b", 0).empty());
+		assert(!replay(scrollback, "#a", 0).empty() && !replay(scrollback, "#c", 0).empty());
+		std::size_t bound = scrollback.memoryBytes();
+		for (int i = 0; i < 1000; ++i)
+			scrollback.add(":a!u@h PRIVMSG #n" + std::to_string(i) + " :spam");
+		assert(scrollback.bufferCount() == 2 && scrollback.memoryBytes() == bound);
+	}
+
+	// Off
+	{
+		ScrollbackOptions options;
+		options.lines = 0;
+		Scrollback scrollback(options);
+		scrollback.add(":a!u@h PRIVMSG #c :hi");
+		assert(!scrollback.enabled() && scrollback.bufferCount() == 0);
+	}
+
+	std::cout << "Scrollback tests passed\n";
+	return 0;
+}
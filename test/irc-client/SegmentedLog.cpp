@@ -0,0 +1,132 @@
+#include "SegmentedLog.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <zstd.h>
+
+namespace fs = std::filesystem;
+
+static std::string readFile(const fs::path &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+static std::vector<fs::path> rotatedSegments(const fs::path &dir, const std::string &activeName)
+{
+	std::vector<fs::path> out;
+	for (const auto &entry : fs::directory_iterator(dir))
+	{
+		std::string name = entry.path().filename().string();
+		if (name != activeName && !name.ends_with(".idx"))
+			out.push_back(entry.path());
+	}
+	std::sort(out.begin(), out.end());
+	return out;
+}
+
+int main()
+{
+	fs::path dir = fs::temp_directory_path() / "segmented_log_test";
+
+	// Size rotation keeps only the newest segments, each with an index
+	{
+		fs::remove_all(dir);
+		fs::create_directories(dir);
+		LogSegmentOptions options;
+		options.maxBytes = 100;
+		options.keep = 2;
+		{
+			SegmentedLog log((dir / "s.log").string(), options);
+			for (int i = 0; i < 20; ++i)
+				log.append("0123456789012345678901234567890123456789\n");
+		}
+
+		auto segments = rotatedSegments(dir, "s.log");
+		assert(segments.size() == 2);
+		for (const auto &segment : segments)
+		{
+			assert(fs::file_size(segment) >= 100);
+			assert(fs::exists(segment.string() + ".idx"));
+		}
+		assert(fs::exists(dir / "s.log"));
+		assert(fs::exists(dir / "s.log.idx"));
+	}
+
+	// Compressed segments are concatenated zstd frames that decode back to the batches
+	{
+		fs::remove_all(dir);
+		fs::create_directories(dir);
+		LogSegmentOptions options;
+		options.compression = LogCompression::Zstd;
+		std::string expected;
+		{
+			SegmentedLog log((dir / "z.log").string(), options);
+			assert(log.activePath() == (dir / "z.log.zst").string());
+			for (int i = 0; i < 3; ++i)
+			{
+				std::string batch;
+				for (int j = 0; j < 200; ++j)
+					batch += ":srv PRIVMSG #chan :batch " + std::to_string(i) + " line " + std::to_string(j) + "\n";
+				log.append(batch);
+				expected += batch;
+			}
+		}
+
+		std::string compressed = readFile(dir / "z.log.zst");
+		assert(compressed.size() < expected.size() / 4);
+
+		std::string decoded;
+		std::string_view rest = compressed;
+		while (!rest.empty())
+		{
+			std::size_t frame = ZSTD_findFrameCompressedSize(rest.data(), rest.size());
+			assert(!ZSTD_isError(frame));
+			std::string out(ZSTD_getFrameContentSize(rest.data(), frame), '\0');
+			std::size_t n = ZSTD_decompress(out.data(), out.size(), rest.data(), frame);
+			assert(!ZSTD_isError(n));
+			decoded += out;
+			rest.remove_prefix(frame);
+		}
+		assert(decoded == expected);
+
+		// The first batch is always indexed at offset 0
+		assert(SegmentedLog::locate((dir / "z.log.zst.idx").string(), INT64_MAX) == 0);
+	}
+
+	// locate() binary-searches the index for the last batch at or before a time
+	{
+		fs::remove_all(dir);
+		fs::create_directories(dir);
+		struct Record
+		{
+			std::int64_t unixMs;
+			std::uint64_t offset;
+		};
+		std::vector<Record> records;
+		for (int i = 0; i < 1000; ++i)
+			records.push_back({1'000'000 + i * 1000, static_cast<std::uint64_t>(i) * 4096});
+		{
+			std::ofstream idx(dir / "t.log.idx", std::ios::binary);
+			idx.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(Record));
+		}
+
+		std::string idx = (dir / "t.log.idx").string();
+		assert(SegmentedLog::locate(idx, 0) == 0);
+		assert(SegmentedLog::locate(idx, 1'000'000) == 0);
+		assert(SegmentedLog::locate(idx, 1'500'500) == 500 * 4096);
+		assert(SegmentedLog::locate(idx, 1'500'999) == 500 * 4096);
+		assert(SegmentedLog::locate(idx, 9'000'000) == 999 * 4096);
+		assert(SegmentedLog::locate((dir / "missing.idx").string(), 1) == 0);
+	}
+
+	fs::remove_all(dir);
+	std::cout << "SegmentedLog tests passed\n";
+	return 0;
+}
@@ -0,0 +1,219 @@
+#include "SessionState.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+int main()
+{
+	SessionState state;
+	assert(state.snapshot() && state.snapshot()->version == 0);
+
+	Membership membership;
+	membership.setSelf("me");
+	membership.join("#a", "me");
+	membership.join("#b", "me");
+	membership.namesReply("#a", "@alice me");
+	membership.namesEnd("#a");
+
+	// Nothing marked, nothing published
+	state.publish(membership);
+	assert(state.snapshot()->version == 0);
+
+	state.markChannel("#a");
+	state.markChannel("#b");
+	state.publish(membership);
+	auto first = state.snapshot();
+	assert(first->version == 1 && first->channels.size() == 2);
+	assert(first->nickCount == 2 && first->nickBytes > 0);
+	assert(first->channels.at("#a")->members.size() == 2);
+	for (const MemberSnapshot &member : first->channels.at("#a")->members)
+	{
+		if (member.nick == "alice")
+			assert(member.status == "@" && member.rank == 0);
+		else
+			assert(member.status.empty() && member.rank == PrefixModes::maxModes);
+	}
+
+	// Only what was marked is rebuilt; everything else is shared with the previous snapshot
+	membership.join("#b", "carol");
+	state.markChannel("#b");
+	state.publish(membership);
+	auto second = state.snapshot();
+	assert(second->version == 2);
+	assert(second->channels.at("#a") == first->channels.at("#a"));
+	assert(second->channels.at("#b") != first->channels.at("#b"));
+	assert(second->channels.at("#b")->members.size() == 2);
+
+	// A held snapshot is immutable: later changes never show up in it
+	assert(first->channels.at("#b")->members.size() == 1);
+
+	// Gone from the live state, gone from the next snapshot; a NICK shows under the new nick
+	std::vector<std::string> touched;
+	membership.rename("carol", "Caroline", touched);
+	membership.part("#a", "me");
+	state.markChannel("#a");
+	state.markChannel("#b");
+	state.publish(membership);
+	assert(!state.snapshot()->channels.contains("#a"));
+	assert(state.snapshot()->nickCount == 2); // alice went with #a
+	bool renamed = false;
+	for (const MemberSnapshot &member : state.snapshot()->channels.at("#b")->members)
+		renamed |= member.nick == "Caroline";
+	assert(renamed);
+
+	// WHO data kept in the user table shows up once the channel is republished
+	User &caroline = membership.nicks().user(membership.nicks().find("caroline"));
+	caroline.username = "~carol";
+	caroline.host = "example.org";
+	caroline.account = "carol";
+	caroline.away = true;
+	state.markChannel("#b");
+	state.publish(membership);
+	bool filled = false;
+	for (const MemberSnapshot &member : state.snapshot()->channels.at("#b")->members)
+		filled |= member.nick == "Caroline" && member.host == "example.org" && member.account == "carol" && member.away;
+	assert(filled);
+
+	// Topics travel with the channel; unread counts are published on their own
+	membership.setTopic("#b", "the \"b\" channel");
+	state.countUnread("#b");
+	state.countUnread("#b");
+	state.publish(membership);
+	assert(state.snapshot()->unread.at("#b") == 2);
+	assert(state.snapshot()->channels.at("#b")->topic.empty()); // not marked yet
+	state.markChannel("#b");
+	state.publish(membership);
+	assert(state.snapshot()->channels.at("#b")->topic == "the \"b\" channel");
+	auto beforeRead = state.snapshot();
+	state.markRead("#b");
+	state.publish(membership);
+	assert(state.snapshot()->unread.empty() && beforeRead->unread.at("#b") == 2);
+	assert(state.snapshot()->channels.at("#b") == beforeRead->channels.at("#b"));
+	std::uint64_t version = state.snapshot()->version;
+	state.markRead();
+	state.publish(membership);
+	assert(state.snapshot()->version == version); // nothing to clear, nothing published
+
+	// The whole session as one JSON object; a user in several channels is described once
+	membership.join("#c", "me");
+	membership.join("#c", "Caroline");
+	state.markChannel("#c");
+	state.countUnread("#c");
+	state.publish(membership);
+	std::string json = SessionState::toJson(*state.snapshot(), "me", 42);
+	assert(json.starts_with("{\"version\":" + std::to_string(state.snapshot()->version) + ",\"seq\":42,\"self\":\"me\","));
+	assert(json.find("{\"name\":\"#b\",\"topic\":\"the \\\"b\\\" channel\",\"unread\":0,\"members\":{") !=
+		   std::string::npos);
+	assert(json.find("{\"name\":\"#c\",\"topic\":\"\",\"unread\":1,\"members\":{") != std::string::npos);
+	assert(json.find("\"Caroline\":{\"username\":\"~carol\",\"host\":\"example.org\",\"account\":\"carol\","
+					 "\"realname\":\"\",\"away\":true}") != std::string::npos);
+	assert(json.find("\"Caroline\":{") == json.rfind("\"Caroline\":{"));
+	assert(json.ends_with("}}"));
+	assert(SessionState::toJson(SessionSnapshot{}, "", 0) ==
+		   "{\"version\":0,\"seq\":0,\"self\":\"\",\"channels\":[],\"users\":{}}");
+	membership.part("#c", "me");
+	state.markChannel("#c");
+	state.publish(membership);
+	assert(!state.snapshot()->unread.contains("#c"));
+
+	// A member change gets one new node; every other member is shared with the previous snapshot
+	{
+		SessionState crowd;
+		Membership live;
+		live.setSelf("me");
+		live.join("#big", "me");
+		std::string names = "me ";
+		for (int i = 0; i < 300; ++i)
+			names += "u" + std::to_string(i) + " ";
+		live.namesReply("#big", names);
+		live.namesEnd("#big");
+		crowd.markChannel("#big");
+		crowd.publish(live);
+
+		auto changedNicks = [&](const ChannelSnapshot &before)
+		{
+			std::unordered_set<const MemberSnapshot *> nodes;
+			for (const MemberSnapshot &member : before.members)
+				nodes.insert(&member);
+			std::vector<std::string> changed;
+			for (const MemberSnapshot &member : crowd.snapshot()->channels.at("#big")->members)
+			{
+				if (!nodes.contains(&member))
+					changed.push_back(member.nick);
+			}
+			return changed;
+		};
+
+		auto before = crowd.snapshot()->channels.at("#big");
+		assert(before->members.size() == 301);
+		live.join("#big", "late");
+		crowd.markMember("#big", live.nicks().find("late"));
+		crowd.publish(live);
+		assert(changedNicks(*before) == std::vector<std::string>{"late"});
+		assert(crowd.snapshot()->channels.at("#big")->members.size() == 302 && before->members.size() == 301);
+
+		before = crowd.snapshot()->channels.at("#big");
+		std::string_view op[] = {"u7"};
+		live.mode("#big", "+o", op);
+		crowd.markMember("#big", live.nicks().find("u7"));
+		live.rename("u8", "U8", touched);
+		crowd.markUser(live.nicks().find("U8"));
+		crowd.publish(live);
+		std::vector<std::string> changed = changedNicks(*before);
+		std::ranges::sort(changed);
+		assert((changed == std::vector<std::string>{"U8", "u7"}));
+
+		// A PART moves the last member into the hole; a full recheck with nothing changed is free
+		before = crowd.snapshot()->channels.at("#big");
+		NickId parted = live.nicks().find("u9");
+		live.part("#big", "u9");
+		crowd.markMember("#big", parted);
+		crowd.publish(live);
+		assert(crowd.snapshot()->channels.at("#big")->members.size() == 301);
+		assert(changedNicks(*before).size() <= 1);
+		before = crowd.snapshot()->channels.at("#big");
+		crowd.markChannel("#big");
+		crowd.publish(live);
+		assert(changedNicks(*before).empty());
+		std::size_t ops = 0;
+		for (const MemberSnapshot &member : crowd.snapshot()->channels.at("#big")->members)
+		{
+			assert(member.nick != "u9");
+			ops += member.status == "@";
+		}
+		assert(ops == 1);
+	}
+
+	// Readers on other threads always see a complete snapshot while the writer publishes
+	std::atomic<bool> done = false;
+	std::thread reader([&]
+					   {
+		std::uint64_t lastVersion = 0;
+		while (!done.load())
+		{
+			auto snapshot = state.snapshot();
+			assert(snapshot->version >= lastVersion);
+			lastVersion = snapshot->version;
+			auto it = snapshot->channels.find("#b");
+			assert(it != snapshot->channels.end());
+			assert(it->second->members.size() >= 2);
+		} });
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::string nick = "n" + std::to_string(i % 100);
+		membership.join("#b", nick);
+		state.markChannel("#b");
+		state.publish(membership);
+	}
+	done = true;
+	reader.join();
+	assert(state.snapshot()->channels.at("#b")->members.size() == 102);
+
+	std::cout << "SessionState tests passed\n";
+	return 0;
+}
@@ -0,0 +1,351 @@
+#include "UnixSocketUI.hpp"
+#include "Logger.hpp"
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int connectTo(const std::string &path)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un addr{};
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	int rc = connect(fd, (sockaddr *)&addr, sizeof(addr));
+	assert(rc == 0);
+	return fd;
+}
+
+static std::string readSome(int fd)
+{
+	char buf[4096];
+	ssize_t n = recv(fd, buf, sizeof(buf), 0);
+	return n > 0 ? std::string(buf, n) : "";
+}
+
+// Polls getInput() until it yields something other than nullopt
+static std::string nextInput(UnixSocketUI &ui)
+{
+	for (int i = 0; i < 1000; ++i)
+	{
+		if (auto input = ui.getInput())
+			return *input;
+		usleep(1000);
+	}
+	assert(false && "no input");
+	return {};
+}
+
+// Draws `count` numbered lines to a peer that reads nothing until they have all been drawn,
+// then returns everything it receives
+static std::string overflowPeer(Logger &logger, const std::string &path, UiOverflow policy, int count, UiQueueStats &stats)
+{
+	UiOptions options;
+	options.queueBytes = 16 * 1024;
+	options.overflow = policy;
+	UnixSocketUI ui(path, logger, options);
+	ui.init();
+	int peer = connectTo(path);
+	assert(!ui.getInput().has_value());
+
+	for (int i = 0; i < count; ++i)
+	{
+		ui.drawOutput("line " + std::to_string(i) + " " + std::string(100, 'x'));
+		ui.flushOutput();
+	}
+	stats = ui.queueStats();
+
+	std::string received;
+	timeval timeout{0, 100 * 1000};
+	setsockopt(peer, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	while (true)
+	{
+		(void)ui.getInput(); // drains queues as the peer makes room
+		std::string chunk = readSome(peer);
+		if (chunk.empty())
+			break;
+		received += chunk;
+	}
+	close(peer);
+	ui.shutdown();
+	return received;
+}
+
+// Every line intact and numbers strictly increasing; returns how many arrived
+static int checkLines(const std::string &received)
+{
+	int lines = 0;
+	int last = -1;
+	for (std::size_t start = 0; start < received.size();)
+	{
+		std::size_t end = received.find('\n', start);
+		assert(end != std::string::npos);
+		std::string line = received.substr(start, end - start);
+		assert(line.rfind("line ", 0) == 0 && line.size() > 100 && line.back() == 'x');
+		int number = std::stoi(line.substr(5));
+		assert(number > last);
+		last = number;
+		++lines;
+		start = end + 1;
+	}
+	return lines;
+}
+
+int main()
+{
+	auto dir = std::filesystem::temp_directory_path();
+	std::string path = (dir / "unix_socket_ui_test.sock").string();
+	LoggerOptions options;
+	options.echoStdout = false;
+	Logger logger((dir / "unix_socket_ui_test.log").string(), options);
+
+	UiOptions uiOptions;
+	uiOptions.backlogLines = 2;
+	UnixSocketUI ui(path, logger, uiOptions);
+	ui.init(); // must not block without a peer
+	assert(ui.inputFd() >= 0);
+	assert(!ui.getInput().has_value());
+
+	// Output before anyone attaches is kept (up to the backlog limit) for the first peer
+	ui.drawOutput("one");
+	ui.drawOutput("two");
+	ui.drawOutput("three");
+
+	int a = connectTo(path);
+	assert(!ui.getInput().has_value()); // accepts A and replays the backlog
+	assert(readSome(a) == "two\nthree\n");
+
+	int b = connectTo(path);
+	assert(!ui.getInput().has_value());
+	assert(ui.peerCount() == 2);
+
+	// Fan-out: every peer gets every line, one write per peer for the whole burst
+	UiOutputStats before = ui.outputStats();
+	ui.drawOutput(":srv PRIVMSG #c :hello");
+	ui.drawOutput(":srv PRIVMSG #c :world");
+	ui.drawOutput(":srv PRIVMSG #c :again");
+	ui.flushOutput();
+	std::string burst = ":srv PRIVMSG #c :hello\n:srv PRIVMSG #c :world\n:srv PRIVMSG #c :again\n";
+	assert(readSome(a) == burst);
+	assert(readSome(b) == burst);
+	UiOutputStats after = ui.outputStats();
+	assert(after.lines - before.lines == 3);
+	assert(after.syscalls - before.syscalls == 2);
+	assert(after.bytes - before.bytes == 2 * burst.size());
+
+	// /replay is answered from the scrollback, to the asking peer only, and never reaches the session
+	std::string replays = "/replay #C 2\n/replay\n";
+	send(a, replays.data(), replays.size(), 0);
+	assert(!ui.getInput().has_value());
+	std::string replayed = readSome(a);
+	if (replayed.find("usage") == std::string::npos)
+		replayed += readSome(a);
+	assert(replayed == ":client replay #c 2\n:srv PRIVMSG #c :world\n:srv PRIVMSG #c :again\n"
+					   ":client error :usage: /replay <#channel|nick|*> [lines]\n");
+	assert(ui.scrollbackBytes() > 0);
+
+	// Commands from all peers come out of one stream
+	send(a, "/users #c\n", 10, 0);
+	assert(nextInput(ui) == "/users #c");
+	send(b, "/channels\r\n", 11, 0);
+	assert(nextInput(ui) == "/channels");
+
+	// Pipelined commands are framed on newlines and come out as one batch; a partial
+	// command waits for the rest of its line
+	std::string pipelined = "/input PRIVMSG #c :one\n\n/input PRIVMSG #c :two\n/input PRIV";
+	send(a, pipelined.data(), pipelined.size(), 0);
+	std::vector<std::string> batch;
+	for (int i = 0; i < 1000 && batch.size() < 2; ++i, usleep(1000))
+		assert(ui.getInputBatch(batch));
+	assert((batch == std::vector<std::string>{"/input PRIVMSG #c :one", "/input PRIVMSG #c :two"}));
+	send(a, "MSG #c :three\n", 14, 0);
+	assert(nextInput(ui) == "/input PRIVMSG #c :three");
+
+	// Commands longer than one read are reassembled, not split
+	std::string longCommand = "/input PRIVMSG #c :" + std::string(3000, 'x');
+	std::string framed = longCommand + "\n";
+	send(b, framed.data(), framed.size(), 0);
+	assert(nextInput(ui) == longCommand);
+
+	// The session only hears "closed" once the last peer has gone
+	close(a);
+	for (int i = 0; i < 50 && ui.peerCount() != 1; ++i)
+	{
+		assert(!ui.getInput().has_value());
+		usleep(1000);
+	}
+	assert(ui.peerCount() == 1);
+	close(b);
+	assert(nextInput(ui).empty());
+
+	ui.shutdown();
+	assert(!std::filesystem::exists(path));
+
+	// Detached mode: the last peer leaving does not close the UI; the next one gets what it missed
+	{
+		UiOptions detachOptions;
+		detachOptions.detachLines = 2;
+		UnixSocketUI detachUi(path, logger, detachOptions);
+		detachUi.init();
+		int first = connectTo(path);
+		assert(!detachUi.getInput().has_value());
+		close(first);
+		for (int i = 0; i < 50 && detachUi.peerCount() != 0; ++i, usleep(1000))
+			assert(!detachUi.getInput().has_value()); // never "closed"
+		assert(detachUi.peerCount() == 0);
+		std::vector<std::string> none;
+		assert(detachUi.getInputBatch(none) && none.empty());
+
+		detachUi.drawOutput(":a!u@h PRIVMSG #c :one");
+		detachUi.drawOutput(":a!u@h PRIVMSG #c :two");
+		detachUi.drawOutput(":srv NOTICE me :hi");
+		detachUi.drawOutput(":a!u@h PRIVMSG #c :three");
+		detachUi.flushOutput();
+		assert(detachUi.detachedLines() == 3);
+
+		int second = connectTo(path);
+		assert(!detachUi.getInput().has_value());
+		assert(readSome(second) == ":a!u@h PRIVMSG #c :two\n:srv NOTICE me :hi\n:a!u@h PRIVMSG #c :three\n"
+								   ":client reattached 3 1\n");
+		assert(detachUi.detachedLines() == 0);
+
+		// Attached again: output goes straight out
+		detachUi.drawOutput(":a!u@h PRIVMSG #c :live");
+		detachUi.flushOutput();
+		assert(readSome(second) == ":a!u@h PRIVMSG #c :live\n");
+		close(second);
+		detachUi.shutdown();
+	}
+
+	// Sequence numbers are opt-in per peer; /resume sends only what a peer missed, from a window
+	{
+		UiOptions resumeOptions;
+		resumeOptions.resumeLines = 3;
+		UnixSocketUI resumeUi(path, logger, resumeOptions);
+		resumeUi.init();
+		int raw = connectTo(path);
+		int sequenced = connectTo(path);
+		assert(!resumeUi.getInput().has_value());
+		resumeUi.drawOutput(":a!u@h PRIVMSG #c :one");
+		resumeUi.flushOutput();
+		assert(readSome(raw) == ":a!u@h PRIVMSG #c :one\n");
+		assert(readSome(sequenced) == ":a!u@h PRIVMSG #c :one\n");
+
+		send(sequenced, "/resume\n", 8, 0);
+		assert(!resumeUi.getInput().has_value());
+		assert(readSome(sequenced) == ":client resume 2 1\n");
+
+		// Tagged for the peer that asked, merged with the line's own tags; untouched for the other
+		std::string two = "@time=2026-01-01T00:00:00.000Z :a!u@h PRIVMSG #c :two";
+		resumeUi.drawOutput(two);
+		resumeUi.flushOutput();
+		assert(readSome(raw) == two + "\n");
+		std::string tagged = readSome(sequenced);
+		assert(tagged.starts_with("@eirc/seq=2;eirc/recv=20") && tagged.ends_with("Z;" + two.substr(1) + "\n"));
+
+		resumeUi.drawOutput(":a!u@h PRIVMSG #c :three");
+		resumeUi.drawOutput(":a!u@h PRIVMSG #c :four");
+		resumeUi.flushOutput();
+		assert(resumeUi.lastSequence() == 4);
+
+		// A peer coming back after line 2 gets 3 and 4 only, in one write
+		int back = connectTo(path);
+		assert(!resumeUi.getInput().has_value());
+		send(back, "/resume 2\n", 10, 0);
+		assert(!resumeUi.getInput().has_value());
+		std::string delta = readSome(back);
+		assert(delta.starts_with(":client resume 3 4\n@eirc/seq=3;"));
+		assert(delta.find("\n@eirc/seq=4;") != std::string::npos && delta.ends_with(":a!u@h PRIVMSG #c :four\n"));
+		assert(delta.find("seq=2;") == std::string::npos);
+
+		// The window holds lines 2-4: anything older, or from another session, is a gap
+		send(back, "/resume 0\n", 10, 0);
+		assert(!resumeUi.getInput().has_value());
+		assert(readSome(back) == ":client resume-gap 0 2\n");
+		send(back, "/resume 99\n", 11, 0);
+		assert(!resumeUi.getInput().has_value());
+		assert(readSome(back) == ":client resume-gap 99 2\n");
+		send(back, "/resume two\n", 12, 0);
+		assert(!resumeUi.getInput().has_value());
+		assert(readSome(back) == ":client error :usage: /resume [sequence]\n");
+
+		close(raw);
+		close(sequenced);
+		close(back);
+		resumeUi.shutdown();
+	}
+
+	// `/protocol events` switches one peer to framed events, acknowledged in the old form
+	{
+		UnixSocketUI eventUi(path, logger);
+		eventUi.init();
+		int raw = connectTo(path);
+		int framed = connectTo(path);
+		assert(!eventUi.getInput().has_value());
+
+		send(framed, "/protocol json\n", 15, 0);
+		assert(!eventUi.getInput().has_value());
+		assert(readSome(framed) == ":client error :usage: /protocol events|lines\n");
+		send(framed, "/protocol events\n", 17, 0);
+		assert(!eventUi.getInput().has_value());
+		assert(readSome(framed) == ":client protocol events\n");
+
+		eventUi.drawOutput(":a!u@h PRIVMSG #c :hi");
+		eventUi.flushOutput();
+		assert(readSome(raw) == ":a!u@h PRIVMSG #c :hi\n");
+		std::string frame = readSome(framed);
+		std::string expected;
+		appendEventFrame(expected, ":a!u@h PRIVMSG #c :hi", eventUi.lastSequence());
+		assert(frame == expected && frame.starts_with(std::to_string(frame.size() - frame.find('{') - 1) + " PRIVMSG {"));
+
+		// Replies to the peer are framed too; commands still go to the session as lines
+		send(framed, "/replay #c\n/input PRIVMSG #c :back\n", 35, 0);
+		std::optional<std::string> input = eventUi.getInput();
+		assert(input == "/input PRIVMSG #c :back");
+		std::string replayed = readSome(framed);
+		assert(replayed.find(" replay {\"seq\":0,\"type\":\"replay\",\"nick\":\"client\",\"channel\":\"#c\"") !=
+			   std::string::npos);
+		assert(replayed.ends_with("\"text\":\"hi\",\"prefix\":\"a!u@h\",\"params\":[\"#c\",\"hi\"],\"tags\":{}}\n"));
+
+		// And back to lines
+		send(framed, "/protocol lines\n", 16, 0);
+		assert(!eventUi.getInput().has_value());
+		assert(readSome(framed).ends_with(" protocol {\"seq\":0,\"type\":\"protocol\",\"nick\":\"client\",\"channel\":\"\","
+										  "\"text\":\"lines\",\"prefix\":\"client\",\"params\":[\"lines\"],\"tags\":{}}\n"));
+		eventUi.drawOutput(":a!u@h PRIVMSG #c :bye");
+		eventUi.flushOutput();
+		assert(readSome(framed) == ":a!u@h PRIVMSG #c :bye\n");
+		readSome(raw);
+
+		close(raw);
+		close(framed);
+		eventUi.shutdown();
+	}
+
+	// A peer that stops reading never holds more than its bound in memory
+	const int count = 20000; // ~2 MB, far beyond any socket buffer
+	UiQueueStats stats;
+	std::string received = overflowPeer(logger, path, UiOverflow::DropOldest, count, stats);
+	assert(stats.queuedBytes <= 16 * 1024 && stats.droppedLines > 0 && stats.disconnects == 0);
+	int lines = checkLines(received);
+	assert(lines > 0 && lines < count);
+	assert(received.find("line " + std::to_string(count - 1) + " ") != std::string::npos); // newest kept
+
+	received = overflowPeer(logger, path, UiOverflow::Disconnect, count, stats);
+	assert(stats.disconnects == 1 && stats.droppedLines == 0 && stats.queuedBytes == 0);
+	checkLines(received);
+
+	received = overflowPeer(logger, path, UiOverflow::Spill, count, stats);
+	assert(stats.queuedBytes <= 16 * 1024 && stats.spilledBytes > 0 && stats.droppedLines == 0);
+	assert(checkLines(received) == count);
+
+	std::filesystem::remove(dir / "unix_socket_ui_test.log");
+	std::filesystem::remove(dir / "unix_socket_ui_test.log.idx");
+	std::cout << "UnixSocketUI tests passed\n";
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include "WhoisCache.hpp"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std::chrono_literals;
+
+static const WhoisState *answer(WhoisCache &cache, const std::string &nick, WhoisCache::Clock::time_point now)
+{
+	WhoisState &whois = cache.collect(nick);
+	whois.exists = true;
+	whois.username = "u";
+	whois.host = "h";
+	whois.realname = "Real \"Name\"";
+	whois.idleSeconds = 42;
+	whois.signonTime = 1700000000;
+	return cache.complete(nick, now);
+}
+
+int main()
+{
+	using Clock = WhoisCache::Clock;
+	const Clock::time_point t0 = Clock::now();
+	const WhoisState *result = nullptr;
+
+	// First request goes out; concurrent ones for the same nick (in any case) join it
+	{
+		WhoisCache cache({60s, 8});
+		assert(cache.request("Alice", t0, result) == WhoisCache::Request::Send);
+		assert(cache.request("alice", t0 + 1s, result) == WhoisCache::Request::Pending);
+		assert(cache.request("ALICE", t0 + 2s, result) == WhoisCache::Request::Pending);
+		assert(cache.inFlight() == 1);
+
+		// 318 completes it: one result, cached, typed
+		const WhoisState *done = answer(cache, "Alice", t0 + 3s);
+		assert(done && done->nick == "Alice" && done->idleSeconds == 42 && done->signonTime == 1700000000);
+		assert(cache.inFlight() == 0 && cache.size() == 1);
+
+		// Fresh: answered locally; stale: sent again
+		assert(cache.request("alice", t0 + 30s, result) == WhoisCache::Request::Cached && result->username == "u");
+		assert(cache.request("alice", t0 + 64s, result) == WhoisCache::Request::Send);
+		assert(cache.size() == 0);
+
+		const WhoisStats &stats = cache.stats();
+		assert(stats.misses == 2 && stats.coalesced == 2 && stats.hits == 1);
+	}
+
+	// An unanswered request stops holding back new ones after the timeout
+	{
+		WhoisCache cache;
+		assert(cache.request("ghost", t0, result) == WhoisCache::Request::Send);
+		assert(cache.request("ghost", t0 + 5s, result) == WhoisCache::Request::Pending);
+		assert(cache.request("ghost", t0 + WhoisCache::requestTimeout + 1s, result) == WhoisCache::Request::Send);
+	}
+
+	// LRU cap: the least recently used result goes first
+	{
+		WhoisCache cache({60s, 2});
+		answer(cache, "a", t0);
+		answer(cache, "b", t0);
+		assert(cache.request("a", t0, result) == WhoisCache::Request::Cached);
+		answer(cache, "c", t0);
+		assert(cache.size() == 2 && cache.stats().evicted == 1);
+		assert(cache.request("a", t0, result) == WhoisCache::Request::Cached);
+		assert(cache.request("b", t0, result) == WhoisCache::Request::Send);
+	}
+
+	// NICK/QUIT invalidate; a TTL of 0 never answers from cache but still completes
+	{
+		WhoisCache cache;
+		answer(cache, "bob", t0);
+		cache.invalidate("BOB");
+		assert(cache.request("bob", t0, result) == WhoisCache::Request::Send);
+
+		WhoisCache uncached({0s, 8});
+		assert(answer(uncached, "bob", t0) && uncached.size() == 0);
+		assert(uncached.request("bob", t0, result) == WhoisCache::Request::Send);
+	}
+
+	// ERR_NOSUCHNICK only counts while a WHOIS is in progress
+	{
+		WhoisCache cache;
+		assert(!cache.collecting("nobody"));
+		assert(cache.request("nobody", t0, result) == WhoisCache::Request::Send);
+		assert(cache.collecting("nobody") && !cache.collecting("nobody")->exists);
+		const WhoisState *done = cache.complete("nobody", t0);
+		assert(done && !done->exists);
+		assert(!cache.complete("nobody", t0)); // a stray 318
+	}
+
+	// Event JSON and numeric replay
+	{
+		WhoisCache cache;
+		const WhoisState *done = answer(cache, "alice", t0);
+		std::string json = WhoisCache::toJson(*done, true);
+		assert(json.starts_with("{\"nick\":\"alice\",\"exists\":true,"));
+		assert(json.find("\"realname\":\"Real \\\"Name\\\"\"") != std::string::npos);
+		assert(json.ends_with("\"operator\":false,\"idle\":42,\"signon\":1700000000,\"cached\":true}"));
+
+		auto lines = WhoisCache::toNumerics(*done, "irc.example", "me");
+		assert(lines.size() == 3);
+		assert(lines[0] == ":irc.example 311 me alice u h * :Real \"Name\"");
+		assert(lines[1] == ":irc.example 317 me alice 42 1700000000 :seconds idle, signon time");
+		assert(lines[2] == ":irc.example 318 me alice :End of /WHOIS list.");
+	}
+
+	std::cout << "WhoisCache tests passed\n";
+	return 0;
+}